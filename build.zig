@@ -8,7 +8,7 @@ pub fn build(b: *Build) void {
     // Let the person running `zig build` choose the optimization mode.
     const optimize = b.standardOptimizeOption(.{});
 
-    const exe_cflags = [_][]const u8{
+    const base_cflags = [_][]const u8{
         "-std=c++17",
         "-Wall",
         "-Wextra",
@@ -17,30 +17,37 @@ pub fn build(b: *Build) void {
         "-Wno-sign-conversion",
     };
 
-    const mod = b.createModule(.{
-        .target = target,
-        .optimize = optimize,
-        .link_libc = true,
-        .link_libcpp = true,
-    });
+    // Count and time the hot paths of the rules engine (see src/instrument.h).
+    const instrument = b.option(bool, "instrument", "Count and time the hot paths of the rules engine") orelse false;
+    const instrumented_cflags = base_cflags ++ [_][]const u8{"-DCHESS_INSTRUMENT"};
+    // Count heap allocations by call site (see src/allocation_profile.h).
+    const allocation_profile = b.option(bool, "allocation-profile", "Count heap allocations by call site") orelse false;
+    const profiled_cflags = base_cflags ++ [_][]const u8{"-DCHESS_ALLOCATION_PROFILE"};
+    const both_cflags = instrumented_cflags ++ [_][]const u8{"-DCHESS_ALLOCATION_PROFILE"};
+    const exe_cflags: []const []const u8 = if (instrument and allocation_profile)
+        &both_cflags
+    else if (instrument)
+        &instrumented_cflags
+    else if (allocation_profile)
+        &profiled_cflags
+    else
+        &base_cflags;
 
+    const mod = createChessModule(b, target, optimize, exe_cflags);
     mod.addCSourceFiles(.{ .files = &.{
-        "src/Board.cpp",
-        "src/chess960.cpp",
+        "src/FrameRenderer.cpp",
         "src/Game.cpp",
+        "src/HeadlessUserInterface.cpp",
         "src/main.cpp",
         "src/Menu.cpp",
-        "src/Piece.cpp",
-        "src/safe_ctype.cpp",
         "src/TerminalUserInterface.cpp",
         "src/ui/AsciiUi.cpp",
         "src/ui/LetterUi.cpp",
         "src/ui/TwoLetterUi.cpp",
-    }, .flags = &exe_cflags });
+    }, .flags = exe_cflags });
 
     if (mod.resolved_target.?.result.os.tag == .windows) {
-        mod.addCSourceFiles(.{ .files = &.{"src/ui/WindowsConsoleUi.cpp"}, .flags = &exe_cflags });
-        mod.addCMacro("CHESS_ON_WINDOWS", "1");
+        mod.addCSourceFiles(.{ .files = &.{"src/ui/WindowsConsoleUi.cpp"}, .flags = exe_cflags });
     }
 
     const exe = b.addExecutable(.{
@@ -54,4 +61,142 @@ pub fn build(b: *Build) void {
 
     const run_step = b.step("run", "Play chess");
     run_step.dependOn(&run_cmd.step);
+
+    // The rules of chess behind a C interface, for embedding in other programs.
+    const linkage = b.option(std.builtin.LinkMode, "linkage", "Build chess-core as a static or dynamic library") orelse .static;
+    const core_mod = createChessModule(b, target, optimize, exe_cflags);
+    core_mod.addCSourceFiles(.{ .files = &.{"src/chess_core.cpp"}, .flags = exe_cflags });
+    core_mod.addCMacro("CHESS_CORE_BUILDING", "1");
+    if (linkage == .dynamic) {
+        core_mod.addCMacro("CHESS_CORE_SHARED", "1");
+    }
+    const core = b.addLibrary(.{
+        .name = if (optimize == .Debug) "chess-core-d" else "chess-core",
+        .linkage = linkage,
+        .root_module = core_mod,
+    });
+    core.installHeader(b.path("src/chess_core.h"), "chess_core.h");
+    b.installArtifact(core);
+
+    const bench_sources = [_][]const u8{
+        "src/FrameRenderer.cpp",
+        "src/Game.cpp",
+        "src/TerminalUserInterface.cpp",
+        "src/tools/bench.cpp",
+        "src/ui/AsciiUi.cpp",
+        "src/ui/LetterUi.cpp",
+        "src/ui/TwoLetterUi.cpp",
+    };
+    const bench = createTool(b, "chess-bench", &bench_sources, target, optimize, exe_cflags);
+    b.installArtifact(bench);
+
+    // Move generation, make/unmake, mate detection and the other paths that
+    // run millions of times per search must never allocate (like `ctest`).
+    const check_allocations = b.addRunArtifact(bench);
+    check_allocations.addArgs(&.{ "--min-time", "0", "--check-allocations" });
+    const test_step = b.step("test", "Check that the hot paths never allocate");
+    test_step.dependOn(&check_allocations.step);
+
+    addTool(b, "chess-book", &.{"src/tools/book.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-hash-bench", &.{"src/tools/hash_bench.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-mate", &.{"src/tools/mate.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-match", &.{"src/tools/match.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-oracle", &.{"src/tools/oracle.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-perft", &.{"src/tools/perft.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-pgn", &.{"src/tools/pgn.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-positions", &.{"src/tools/positions.cpp"}, target, optimize, exe_cflags);
+    const render_bench_sources = [_][]const u8{
+        "src/FrameRenderer.cpp",
+        "src/TerminalUserInterface.cpp",
+        "src/tools/render_bench.cpp",
+        "src/ui/AsciiUi.cpp",
+        "src/ui/LetterUi.cpp",
+        "src/ui/TwoLetterUi.cpp",
+    };
+    addTool(b, "chess-render-bench", &render_bench_sources, target, optimize, exe_cflags);
+    addTool(b, "chess-selfplay", &.{"src/tools/selfplay.cpp"}, target, optimize, exe_cflags);
+    addTool(b, "chess-tablebase", &.{"src/tools/tablebase.cpp"}, target, optimize, exe_cflags);
+
+    // The game server uses epoll, which only Linux has.
+    if (target.result.os.tag == .linux) {
+        const server_sources = [_][]const u8{ "src/Game.cpp", "src/server/GameServer.cpp", "src/tools/server.cpp" };
+        addTool(b, "chess-server", &server_sources, target, optimize, exe_cflags);
+        addTool(b, "chess-loadgen", &.{"src/tools/loadgen.cpp"}, target, optimize, exe_cflags);
+    }
+}
+
+// Sources shared by the game and the command line tools.
+const core_sources = [_][]const u8{
+    "src/allocation_profile.cpp",
+    "src/Arena.cpp",
+    "src/attacks.cpp",
+    "src/Board.cpp",
+    "src/chess960.cpp",
+    "src/fen.cpp",
+    "src/instrument.cpp",
+    "src/LegalMoveSet.cpp",
+    "src/MappedFile.cpp",
+    "src/MateSolver.cpp",
+    "src/move_oracle.cpp",
+    "src/MovePicker.cpp",
+    "src/pgn.cpp",
+    "src/Piece.cpp",
+    "src/Ponderer.cpp",
+    "src/polyglot.cpp",
+    "src/position_db.cpp",
+    "src/Referee.cpp",
+    "src/safe_ctype.cpp",
+    "src/san.cpp",
+    "src/Search.cpp",
+    "src/see.cpp",
+    "src/tablebase.cpp",
+    "src/TableMemory.cpp",
+    "src/TranspositionTable.cpp",
+    "src/zobrist.cpp",
+};
+
+fn createChessModule(
+    b: *Build,
+    target: Build.ResolvedTarget,
+    optimize: std.builtin.OptimizeMode,
+    cflags: []const []const u8,
+) *Build.Module {
+    const mod = b.createModule(.{
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+        .link_libcpp = true,
+    });
+    mod.addCSourceFiles(.{ .files = &core_sources, .flags = cflags });
+    if (mod.resolved_target.?.result.os.tag == .windows) {
+        mod.addCMacro("CHESS_ON_WINDOWS", "1");
+    }
+    return mod;
+}
+
+fn createTool(
+    b: *Build,
+    name: []const u8,
+    sources: []const []const u8,
+    target: Build.ResolvedTarget,
+    optimize: std.builtin.OptimizeMode,
+    cflags: []const []const u8,
+) *Build.Step.Compile {
+    const mod = createChessModule(b, target, optimize, cflags);
+    mod.addCSourceFiles(.{ .files = sources, .flags = cflags });
+    return b.addExecutable(.{
+        .name = if (optimize == .Debug) b.fmt("{s}-d", .{name}) else name,
+        .root_module = mod,
+    });
+}
+
+fn addTool(
+    b: *Build,
+    name: []const u8,
+    sources: []const []const u8,
+    target: Build.ResolvedTarget,
+    optimize: std.builtin.OptimizeMode,
+    cflags: []const []const u8,
+) void {
+    b.installArtifact(createTool(b, name, sources, target, optimize, cflags));
 }
@@ -0,0 +1,51 @@
+// Author: Daniel Kareh
+// Summary: A region of memory that hands out pieces of itself from front to
+//          back and frees them all at once.
+
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+
+void* Arena::allocate(std::size_t size, std::size_t alignment) {
+	// Look for room in the current chunk, then in any chunks left over from
+	// before the last reset.
+	for (; current < chunks.size(); current++, offset = 0) {
+		auto& chunk{ chunks[current] };
+		const auto base{ reinterpret_cast<std::uintptr_t>(chunk.memory.get()) };
+		const auto start{ (base + offset + alignment - 1) & ~(std::uintptr_t{ alignment } - 1) };
+		if (start + size <= base + chunk.size) {
+			offset = start + size - base;
+			return reinterpret_cast<void*>(start);
+		}
+	}
+
+	// Chunks are aligned for any fundamental type, so only over-aligned types
+	// need the padding.
+	const std::size_t size_with_padding{
+		size + (alignment > alignof(std::max_align_t) ? alignment : 0)
+	};
+	const std::size_t new_size{ std::max(chunk_size, size_with_padding) };
+	// Skip zeroing the chunk, since it might be large.
+	chunks.push_back({ std::unique_ptr<std::byte[]>{ new std::byte[new_size] }, new_size });
+	offset = 0;
+	return allocate(size, alignment);
+}
+
+std::size_t Arena::get_bytes_used() const {
+	std::size_t used{ 0 };
+	for (std::size_t i{ 0 }; i < current && i < chunks.size(); i++)
+		used += chunks[i].size;
+	return used + offset;
+}
+
+std::size_t Arena::get_bytes_reserved() const {
+	std::size_t reserved{ 0 };
+	for (const auto& chunk : chunks)
+		reserved += chunk.size;
+	return reserved;
+}
+
+Arena& get_thread_arena() {
+	thread_local Arena arena;
+	return arena;
+}
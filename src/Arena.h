@@ -0,0 +1,130 @@
+// Author: Daniel Kareh
+// Summary: A region of memory that hands out pieces of itself from front to
+//          back and frees them all at once. Analysis that keeps many
+//          positions, move lists, or records alive can put them in an arena
+//          instead of allocating each one separately.
+
+#ifndef CHESS_ARENA_H
+#define CHESS_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Memory comes from the heap in chunks, which are kept when the arena is
+// reset or rewound, so an arena that's reused stops allocating once it has
+// grown large enough. Nothing in an arena is ever destroyed, so only types
+// with trivial destructors can be created in one directly.
+class Arena {
+public:
+	// A position in the arena to rewind to later.
+	struct Marker {
+		std::size_t chunk{ 0 };
+		std::size_t offset{ 0 };
+	};
+
+	// Chunks are allocated when they're first needed, so an empty arena costs
+	// nothing. Larger requests get a chunk of their own.
+	explicit Arena(std::size_t chunk_size = 64 * 1024)
+		: chunk_size{ chunk_size } {}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Throws `std::bad_alloc` if a new chunk cannot be allocated.
+	void* allocate(std::size_t size, std::size_t alignment);
+
+	template <typename T, typename... Args>
+	T* create(Args&&... args) {
+		static_assert(std::is_trivially_destructible_v<T>, "Arenas never run destructors");
+		return new (allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+	}
+
+	// Free everything allocated after the marker was taken.
+	Marker mark() const { return { current, offset }; }
+	void rewind(Marker marker) {
+		current = marker.chunk;
+		offset = marker.offset;
+	}
+
+	// Free everything at once.
+	void reset() { rewind({}); }
+
+	std::size_t get_bytes_used() const;
+	std::size_t get_bytes_reserved() const;
+
+private:
+	struct Chunk {
+		std::unique_ptr<std::byte[]> memory;
+		std::size_t size;
+	};
+
+	std::vector<Chunk> chunks;
+	std::size_t chunk_size;
+	std::size_t current{ 0 };
+	std::size_t offset{ 0 };
+};
+
+// Rewind an arena to where it was when the scope began.
+class ArenaScope {
+public:
+	explicit ArenaScope(Arena& arena)
+		: arena{ arena }
+		, marker{ arena.mark() } {}
+	~ArenaScope() { arena.rewind(marker); }
+
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+	Arena& arena;
+	Arena::Marker marker;
+};
+
+// Lets standard containers live in an arena. Freeing does nothing; the memory
+// comes back when the arena is reset or rewound. The arena must outlive every
+// container that uses it.
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(Arena& arena)
+		: arena{ &arena } {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other)
+		: arena{ other.get_arena() } {}
+
+	T* allocate(std::size_t count) {
+		return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+	void deallocate(T*, std::size_t) {}
+
+	Arena* get_arena() const { return arena; }
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const {
+		return arena == other.get_arena();
+	}
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const {
+		return arena != other.get_arena();
+	}
+
+private:
+	Arena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Every thread has an arena of its own for scratch space, so threads never
+// contend for it. Use an `ArenaScope` to give back what you take.
+Arena& get_thread_arena();
+
+#endif
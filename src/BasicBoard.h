@@ -0,0 +1,110 @@
+// Author: Daniel Kareh
+// Summary: The pieces on a board of any size: where they stand, the bounds of
+//          the board, the order that its squares are visited in, and which
+//          squares are occupied. `Board` adds the rules of chess (which are
+//          only written for 8x8) on top of the 8x8 version.
+
+#ifndef CHESS_BASIC_BOARD_H
+#define CHESS_BASIC_BOARD_H
+
+#include <array>
+#include <cassert>
+#include <optional>
+#include "BoardGeometry.h"
+#include "Piece.h"
+
+template <typename BoardGeometry>
+class BasicBoard {
+public:
+	using Geometry = BoardGeometry;
+	using Rank = std::array<std::optional<Piece>, Geometry::files>;
+
+	BasicBoard() = default;
+
+	explicit BasicBoard(const std::array<Rank, Geometry::ranks>& ranks) {
+		for (int rank{ 0 }; rank < Geometry::ranks; rank++) {
+			for (int file{ 0 }; file < Geometry::files; file++)
+				at({ rank, file }) = ranks[rank][file];
+		}
+	}
+
+	Square get_dimensions() const { return { Geometry::ranks, Geometry::files }; }
+	bool is_in_bounds(Square square) const { return Geometry::is_in_bounds(square); }
+	bool is_out_of_bounds(Square square) const { return !is_in_bounds(square); }
+	// The square must be on the board.
+	std::optional<Piece> get_piece(Square square) const { return at(square); }
+	bool is_occupied(Square square) const { return get_piece(square).has_value(); }
+
+	// The squares with a piece on them (of either color, or of one color).
+	typename Geometry::Set get_occupied_squares() const {
+		typename Geometry::Set occupied;
+		for (const Square square : *this) {
+			if (at(square))
+				occupied.insert(square);
+		}
+		return occupied;
+	}
+
+	typename Geometry::Set get_occupied_squares(color color) const {
+		typename Geometry::Set occupied;
+		for (const Square square : *this) {
+			const auto& piece{ at(square) };
+			if (piece && piece->color == color)
+				occupied.insert(square);
+		}
+		return occupied;
+	}
+
+	// An iterator type that goes through each square of a board.
+	// Iteration starts at the top left square ('a8' on an 8x8 board) and ends
+	// at the bottom right one ('h1').
+	class Iterator {
+	public:
+		explicit Iterator(Square current)
+			: current{ current } {}
+
+		const Square& operator*() const { return current; }
+		const Square* operator->() const { return &current; }
+
+		Iterator& operator++() {
+			current = Geometry::get_next_square(current);
+			return *this;
+		}
+
+		// NOTE: The post-increment operator must have a dummy "int" parameter
+		// to differentiate it from the pre-increment operator.
+		Iterator operator++(int) {
+			Iterator copy{ *this };
+			++(*this);
+			return copy;
+		}
+
+		bool operator==(const Iterator& other) const { return current == other.current; }
+		bool operator!=(const Iterator& other) const { return current != other.current; }
+
+	private:
+		Square current;
+	};
+
+	// By defining `begin` and `end`, we can use C++ range-based for loops on
+	// boards!
+	Iterator begin() const { return Iterator{ Geometry::get_first_square() }; }
+	Iterator end() const { return Iterator{ Geometry::get_end_square() }; }
+
+protected:
+	std::optional<Piece>& at(Square square) { return squares[get_square_index(square)]; }
+	const std::optional<Piece>& at(Square square) const {
+		return squares[get_square_index(square)];
+	}
+
+private:
+	static std::size_t get_square_index(Square square) {
+		assert(Geometry::is_in_bounds(square));
+		return static_cast<std::size_t>(Geometry::get_index(square));
+	}
+
+	// One entry per square, numbered by `Geometry::get_index`.
+	std::array<std::optional<Piece>, Geometry::square_count> squares;
+};
+
+#endif
@@ -3,6 +3,9 @@
 //          who moves next (that is stored by the game object).
 
 #include "Board.h"
+#include "allocation_profile.h"
+#include "attacks.h"
+#include "instrument.h"
 #include "throw_if_empty.h"
 
 static Board::Rank get_home_rank(color color) {
@@ -27,20 +30,39 @@ static std::array<Board::Rank, 8> get_default_board() {
 	return ranks;
 }
 
+// Are all the castleable pieces where they start in classical chess?
+static bool has_classical_castling(const std::array<Board::Rank, 8>& ranks) {
+	for (int rank{ 0 }; rank < 8; rank++) {
+		for (int file{ 0 }; file < 8; file++) {
+			const auto& piece{ ranks[rank][file] };
+			if (!piece)
+				continue;
+
+			const bool on_home_rank{ rank == (piece->color == color::black ? 7 : 0) };
+			if (piece->type == piece_type::castleable_king && (!on_home_rank || file != 4))
+				return false;
+			const bool in_corner{ on_home_rank && (file == 0 || file == 7) };
+			if (piece->type == piece_type::castleable_rook && !in_corner)
+				return false;
+		}
+	}
+	return true;
+}
+
 Board::Board()
 	: Board{ get_default_board() } {}
 
-Board::Board(std::array<Rank, 8> ranks)
-	: ranks{ ranks } {}
-
-bool Board::is_in_bounds(Square square) const {
-	return 0 <= square.rank && square.rank < 8 && 0 <= square.file && square.file < 8;
+Board::Board(std::array<Rank, Geometry::ranks> ranks, Square en_passant_target, variant variant)
+	: BasicBoard{ ranks }
+	, en_passant_target{ en_passant_target }
+	, castling_variant{ variant::chess960 } {
+	if (variant == variant::classical && has_classical_castling(ranks))
+		castling_variant = variant::classical;
 }
 
-std::optional<Piece> Board::get_piece(Square square) const { return at(square); }
-
 std::optional<MoveDetails> Board::move(Move move, const ChooseMoveCallback& choose_move) {
-	auto details{ get_legal_moves(move) };
+	const auto legal_details{ get_legal_moves(move) };
+	const std::vector<MoveDetails> details(legal_details.begin(), legal_details.end());
 
 	// Which move should we actually apply?
 	const int choice{ choose_move(details) };
@@ -51,14 +73,12 @@ std::optional<MoveDetails> Board::move(Move move, const ChooseMoveCallback& choo
 	return details[choice];
 }
 
-std::vector<MoveDetails> Board::get_legal_moves(Move move) const {
+MoveDetailsList Board::get_legal_moves(Move move) const {
 	auto details{ generate_move_details(move, *this) };
 
 	// Ignore pseudo-legal moves that would put the king in check.
 	for (auto it{ details.begin() }; it != details.end();) {
-		Board copy{ *this };
-		copy.force_move(move, *it);
-		if (copy.piece_is_under_attack(copy.find_king(move.active_color)))
+		if (!is_legal({ move, *it }))
 			it = details.erase(it);
 		else
 			++it;
@@ -67,23 +87,141 @@ std::vector<MoveDetails> Board::get_legal_moves(Move move) const {
 	return details;
 }
 
+std::vector<LegalMove> Board::get_all_legal_moves(color color) const {
+	MoveList legal_moves;
+	generate_legal_moves(color, legal_moves);
+	return { legal_moves.begin(), legal_moves.end() };
+}
+
+void Board::generate_legal_moves(color color, MoveList& legal_moves) const {
+	CHESS_EXPECT_NO_ALLOCATIONS("Board::generate_legal_moves");
+	legal_moves.clear();
+	const auto own_pieces{ get_occupied_squares(color) };
+
+	// Each move is tried on one scratch copy of the board and taken back,
+	// instead of on a fresh copy (as `is_legal` does).
+	Board scratch{ *this };
+	for (const Square from : *this) {
+		const auto piece{ get_piece(from) };
+		if (!piece || piece->color != color)
+			continue;
+
+		// Only a castling king can land on a square with its own piece (the
+		// rook, in Chess960).
+		const bool is_king{ piece->is_king() };
+		for (const Square to : *this) {
+			if (!is_king && own_pieces.contains(to))
+				continue;
+
+			const Move move{ color, from, to };
+			for (const auto& details : generate_move_details(move, *this)) {
+				const auto undo{ scratch.make_move({ move, details }) };
+				if (!scratch.piece_is_under_attack(scratch.find_king(color)))
+					legal_moves.push_back({ move, details });
+				scratch.unmake_move(undo);
+			}
+		}
+	}
+}
+
+bool Board::is_legal(const LegalMove& legal_move) const {
+	CHESS_COUNT(legal_move_board_copies);
+	Board copy{ *this };
+	copy.play(legal_move);
+	return !copy.piece_is_under_attack(copy.find_king(legal_move.move.active_color));
+}
+
 bool Board::piece_is_under_attack(Square square) const {
-	const color color{ throw_if_empty(get_piece(square)).color };
-	// Loop over every square.
-	for (auto from : *this) {
-		const Move move{ get_opposing_color(color), from, square };
-		const auto details{ generate_move_details(move, *this) };
-
-		// Check if the piece was legally captured.
-		for (const auto& legal_move : details) {
-			if (legal_move.captured_square && legal_move.captured_square == square)
+	CHESS_COUNT(attack_checks);
+	const color attacker{ get_opposing_color(throw_if_empty(get_piece(square)).color) };
+	if (get_attacked_squares(attacker).contains(square))
+		return true;
+
+	// A pawn that just advanced two ranks can also be captured en passant.
+	const int direction{ attacker == color::white ? 1 : -1 };
+	if (en_passant_target != square.get_offset(direction, 0))
+		return false;
+
+	for (const int file : { square.get_file() - 1, square.get_file() + 1 }) {
+		const Square from{ square.get_rank(), file };
+		if (!is_in_bounds(from))
+			continue;
+
+		const auto piece{ get_piece(from) };
+		if (piece && piece->type == piece_type::pawn && piece->color == attacker)
+			return true;
+	}
+	return false;
+}
+
+bool Board::can_capture_en_passant(color active_color) const {
+	if (!is_in_bounds(en_passant_target))
+		return false;
+
+	// The capturing pawn stands beside the pawn that just moved, which is
+	// one rank past the target.
+	const int direction{ active_color == color::white ? -1 : 1 };
+	const Square passed{ en_passant_target.get_offset(direction, 0) };
+	for (const int file : { passed.get_file() - 1, passed.get_file() + 1 }) {
+		const Square from{ passed.get_rank(), file };
+		if (!is_in_bounds(from))
+			continue;
+
+		const auto piece{ get_piece(from) };
+		if (!piece || piece->type != piece_type::pawn || piece->color != active_color)
+			continue;
+
+		for (const auto& details : get_legal_moves({ active_color, from, en_passant_target })) {
+			if (details.captured_square && *details.captured_square != en_passant_target)
 				return true;
 		}
 	}
 	return false;
 }
 
+Board::Geometry::Set Board::get_attacked_squares(color attacker, Square removed) const {
+	std::array<AttackingPieces, 2> pieces{};
+	std::uint64_t occupied{ 0 };
+	for (int index{ 0 }; index < Geometry::square_count; index++) {
+		const Square square{ Geometry::get_square(index) };
+		const auto& piece{ at(square) };
+		if (!piece || square == removed)
+			continue;
+
+		const std::uint64_t bit{ std::uint64_t{ 1 } << index };
+		occupied |= bit;
+		auto& own{ pieces[static_cast<std::size_t>(piece->color)] };
+		switch (get_base_type(piece->type)) {
+		case piece_type::pawn:
+			own.pawns |= bit;
+			break;
+		case piece_type::knight:
+			own.knights |= bit;
+			break;
+		case piece_type::bishop:
+			own.diagonal_sliders |= bit;
+			break;
+		case piece_type::rook:
+			own.orthogonal_sliders |= bit;
+			break;
+		case piece_type::queen:
+			own.diagonal_sliders |= bit;
+			own.orthogonal_sliders |= bit;
+			break;
+		case piece_type::king:
+			own.kings |= bit;
+			break;
+		default:
+			break;
+		}
+	}
+
+	const auto attacks{ compute_attack_maps(pieces, occupied) };
+	return Geometry::Set{ { attacks[static_cast<std::size_t>(attacker)] } };
+}
+
 bool Board::piece_would_be_attacked(Square from, Square to) const {
+	CHESS_COUNT(would_be_attacked_board_copies);
 	Board copy{ *this };
 	copy.move_one_piece(from, to);
 	return copy.piece_is_under_attack(to);
@@ -131,6 +269,41 @@ void Board::force_move(Move move, MoveDetails details) {
 	}
 }
 
+MoveUndo Board::make_move(const LegalMove& legal_move) {
+	CHESS_EXPECT_NO_ALLOCATIONS("Board::make_move");
+	const auto& [move, details]{ legal_move };
+	MoveUndo undo;
+	undo.en_passant_target = en_passant_target;
+	const auto save{ [&](Square square) {
+		for (int i{ 0 }; i < undo.square_count; i++) {
+			if (undo.squares[i] == square)
+				return;
+		}
+		undo.squares[undo.square_count] = square;
+		undo.pieces[undo.square_count] = at(square);
+		undo.square_count++;
+	} };
+
+	save(move.from);
+	save(move.to);
+	if (details.captured_square)
+		save(*details.captured_square);
+	if (details.castling) {
+		save(details.castling->secondary_from);
+		save(details.castling->secondary_to);
+	}
+
+	force_move(move, details);
+	return undo;
+}
+
+void Board::unmake_move(const MoveUndo& undo) {
+	CHESS_EXPECT_NO_ALLOCATIONS("Board::unmake_move");
+	for (int i{ 0 }; i < undo.square_count; i++)
+		at(undo.squares[i]) = undo.pieces[i];
+	en_passant_target = undo.en_passant_target;
+}
+
 Piece& Board::move_one_piece(Square from, Square to) {
 	auto piece{ pick_up(from) };
 	return put_down(to, piece);
@@ -150,33 +323,3 @@ Piece& Board::put_down(Square square, Piece piece) {
 
 std::optional<Piece>& Board::operator[](Square square) { return at(square); }
 const std::optional<Piece>& Board::operator[](Square square) const { return at(square); }
-std::optional<Piece>& Board::at(Square square) { return ranks.at(square.rank).at(square.file); }
-
-const std::optional<Piece>& Board::at(Square square) const {
-	return ranks.at(square.rank).at(square.file);
-}
-
-Board::Iterator& Board::Iterator::operator++() {
-	current.file++;
-	if (current.file == 8) {
-		current.file = 0;
-		current.rank--;
-	}
-	return *this;
-}
-
-// NOTE: The post-increment operator must have a dummy "int" parameter to
-// differentiate it from the pre-increment operator.
-Board::Iterator Board::Iterator::operator++(int) {
-	Iterator copy{ *this };
-	++(*this);
-	return copy;
-}
-
-bool Board::Iterator::operator==(const Board::Iterator& other) const {
-	return current == other.current;
-}
-
-bool Board::Iterator::operator!=(const Board::Iterator& other) const {
-	return current != other.current;
-}
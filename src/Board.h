@@ -7,54 +7,97 @@
 
 #include <array>
 #include <functional>
+#include "BasicBoard.h"
 #include "Piece.h"
 
-class Board {
+// A move together with the details of how it is carried out. A single pair of
+// squares can correspond to several legal moves, e.g. one for each promotion.
+struct LegalMove {
+	Move move;
+	MoveDetails details;
+};
+
+// Two legal moves for the same position are the same move if they take the
+// same piece to the same square, promote to the same piece, and either both
+// castle or neither does. Everything else follows from the position.
+inline bool is_same_move(const LegalMove& a, const LegalMove& b) {
+	return a.move.from == b.move.from && a.move.to == b.move.to
+		&& a.details.promote_to == b.details.promote_to
+		&& a.details.castling.has_value() == b.details.castling.has_value();
+}
+
+// Chess960 has the same rules as classical chess, except that castling works
+// for any starting squares of the king and rooks.
+enum class variant : unsigned char {
+	classical,
+	chess960,
+};
+
+// No chess position has more than 218 legal moves.
+using MoveList = FixedVector<LegalMove, 256>;
+
+// The squares (and en passant target) that a move changed, so that the move
+// can be taken back. A move changes at most four squares (when castling).
+struct MoveUndo {
+	std::array<Square, 4> squares;
+	std::array<std::optional<Piece>, 4> pieces;
+	int square_count{ 0 };
+	Square en_passant_target;
+};
+
+class Board : public BasicBoard<StandardGeometry> {
 public:
-	using Rank = std::array<std::optional<Piece>, 8>;
 	using ChooseMoveCallback = std::function<int(const std::vector<MoveDetails>&)>;
 
 	Board();
-	explicit Board(std::array<Rank, 8>);
 
-	Square get_dimensions() const { return { 8, 8 }; }
-	bool is_in_bounds(Square) const;
-	std::optional<Piece> get_piece(Square) const;
+	// The move generator has a faster path for classical castling, where the
+	// king and rooks can only castle from their usual squares. A board only
+	// takes it if every castleable piece is on one of those squares, and
+	// otherwise uses the Chess960 rules (which work for any position).
+	explicit Board(std::array<Rank, Geometry::ranks>, Square en_passant_target = {},
+		variant = variant::classical);
+
 	std::optional<MoveDetails> move(Move, const ChooseMoveCallback&);
-	std::vector<MoveDetails> get_legal_moves(Move) const;
+	MoveDetailsList get_legal_moves(Move) const;
+	std::vector<LegalMove> get_all_legal_moves(color) const;
+
+	// Like `get_all_legal_moves`, but without allocating memory.
+	void generate_legal_moves(color, MoveList&) const;
+
+	// Return true if a pseudo-legal move (one from `generate_move_details`
+	// for this exact position) doesn't leave the mover's king in check.
+	bool is_legal(const LegalMove&) const;
+
+	// Apply a move that came from `get_legal_moves` or `get_all_legal_moves`
+	// for this exact position. Other moves may corrupt the board!
+	void play(const LegalMove& legal_move) { force_move(legal_move.move, legal_move.details); }
+
+	// Like `play`, but the move can be taken back by passing the result to
+	// `unmake_move`. Moves must be taken back in the reverse order.
+	MoveUndo make_move(const LegalMove&);
+	void unmake_move(const MoveUndo&);
+
+	// Return true if an opposing piece could capture the piece on the square.
 	bool piece_is_under_attack(Square) const;
 
+	// Every square attacked by the pieces of one color, computed for the
+	// whole board at once (see attacks.h). The piece on `removed`, if any, is
+	// left out as if it had already moved away. En passant isn't included.
+	Geometry::Set get_attacked_squares(color attacker, Square removed = {}) const;
+
 	// Return true if moving the piece from one square to another would
 	// place it under attack.
 	bool piece_would_be_attacked(Square from, Square to) const;
 
 	Square find_king(color) const;
+
 	Square get_en_passant_target() const { return en_passant_target; }
-	bool is_occupied(Square square) const { return get_piece(square).has_value(); }
-	bool is_out_of_bounds(Square square) const { return !is_in_bounds(square); }
-
-	// An iterator type that goes through each square of a board.
-	// Iteration starts at square 'a8' and ends at square 'h1'.
-	class Iterator {
-	public:
-		explicit Iterator(Square current)
-			: current{ current } {}
-
-		const Square& operator*() const { return current; }
-		const Square* operator->() const { return &current; }
-		Iterator& operator++();
-		Iterator operator++(int);
-		bool operator==(const Iterator&) const;
-		bool operator!=(const Iterator&) const;
-
-	private:
-		Square current;
-	};
-
-	// By defining `begin` and `end`, we can use C++ range-based for loops on
-	// instances of `Board`!
-	Iterator begin() const { return Iterator{ { get_dimensions().rank - 1, 0 } }; }
-	Iterator end() const { return Iterator{ { -1, 0 } }; }
+	// Return true if the player can legally capture en passant. Otherwise
+	// the target makes no difference, and positions that only differ in it
+	// are the same position (as the rules of repetition say).
+	bool can_capture_en_passant(color) const;
+	variant get_variant() const { return castling_variant; }
 
 private:
 	// Apply a move to the board, ignoring whether the move is legal or not.
@@ -67,11 +110,9 @@ private:
 	Piece& put_down(Square, Piece);
 	std::optional<Piece>& operator[](Square);
 	const std::optional<Piece>& operator[](Square) const;
-	std::optional<Piece>& at(Square);
-	const std::optional<Piece>& at(Square) const;
 
-	std::array<Rank, 8> ranks;
 	Square en_passant_target{};
+	variant castling_variant{ variant::classical };
 };
 
 #endif
@@ -0,0 +1,175 @@
+// Author: Daniel Kareh
+// Summary: The shape of a board as a compile-time parameter. Bounds checks,
+//          the order that squares are visited in, square names, and sets of
+//          squares all come from here, so each board size gets its own
+//          constant-folded code. The classical board is 8x8; larger variants
+//          use 10x8 (Capablanca chess) and 10x10 (Grand chess).
+
+#ifndef CHESS_BOARD_GEOMETRY_H
+#define CHESS_BOARD_GEOMETRY_H
+
+#include <array>
+#include <cstdint>
+#include "Square.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The index of the lowest set bit. `word` must not be zero.
+inline int find_lowest_bit(std::uint64_t word) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+inline int count_bits(std::uint64_t word) {
+#ifdef _MSC_VER
+	return static_cast<int>(__popcnt64(word));
+#else
+	return __builtin_popcountll(word);
+#endif
+}
+
+template <typename Geometry>
+class SquareSet;
+
+template <int Files, int Ranks>
+struct BoardGeometry {
+	// A knight's jump off the board has to stay within the four bits that a
+	// square has for its file and rank; see Square.h.
+	static_assert(1 <= Files && Files + 2 <= 16, "A jump off the side must not wrap");
+	static_assert(1 <= Ranks && Ranks + 2 <= 16, "A jump off the end must not wrap");
+
+	static constexpr int files{ Files };
+	static constexpr int ranks{ Ranks };
+	static constexpr int square_count{ Files * Ranks };
+
+	using Set = SquareSet<BoardGeometry>;
+
+	static constexpr bool is_in_bounds(Square square) {
+		return square.get_rank() < Ranks && square.get_file() < Files;
+	}
+
+	// Squares are numbered rank by rank, starting from 'a1'.
+	static constexpr int get_index(Square square) {
+		return square.get_rank() * Files + square.get_file();
+	}
+	static constexpr Square get_square(int index) { return { index / Files, index % Files }; }
+
+	// Squares are visited rank by rank from the top left ('a8' on an 8x8
+	// board) to the bottom right ('h1'), like they're printed. The square
+	// after 'h1' is the default square.
+	static constexpr Square get_first_square() { return { Ranks - 1, 0 }; }
+	static constexpr Square get_end_square() { return {}; }
+	static constexpr Square get_next_square(Square square) {
+		square = square.get_offset(0, 1);
+		if (square.get_file() == Files)
+			square = Square{ square.get_rank() - 1, 0 };
+		return square;
+	}
+
+	static std::optional<Square> parse_square(std::string_view string) {
+		return Square::parse(string, Files, Ranks);
+	}
+};
+
+using StandardGeometry = BoardGeometry<8, 8>;
+using CapablancaGeometry = BoardGeometry<10, 8>;
+using GrandGeometry = BoardGeometry<10, 10>;
+
+// A set of squares with one bit per square. Sets for boards with more than 64
+// squares span several 64-bit words.
+template <typename Geometry>
+class SquareSet {
+public:
+	static constexpr int word_count{ (Geometry::square_count + 63) / 64 };
+
+	constexpr SquareSet() = default;
+	explicit constexpr SquareSet(const std::array<std::uint64_t, word_count>& words)
+		: words{ words } {}
+
+	constexpr bool contains(Square square) const {
+		const int index{ Geometry::get_index(square) };
+		return (words[index / 64] >> (index % 64)) & 1;
+	}
+
+	constexpr void insert(Square square) {
+		const int index{ Geometry::get_index(square) };
+		words[index / 64] |= std::uint64_t{ 1 } << (index % 64);
+	}
+
+	constexpr void erase(Square square) {
+		const int index{ Geometry::get_index(square) };
+		words[index / 64] &= ~(std::uint64_t{ 1 } << (index % 64));
+	}
+
+	bool empty() const {
+		for (const auto word : words) {
+			if (word != 0)
+				return false;
+		}
+		return true;
+	}
+
+	int size() const {
+		int count{ 0 };
+		for (const auto word : words)
+			count += count_bits(word);
+		return count;
+	}
+
+	// The first square that `for_each` would visit, or a square out of bounds
+	// if the set is empty.
+	Square get_first() const {
+		for (int i{ 0 }; i < word_count; i++) {
+			if (words[i] != 0)
+				return Geometry::get_square(i * 64 + find_lowest_bit(words[i]));
+		}
+		return Geometry::get_end_square();
+	}
+
+	// Call `function` with each square in the set, starting from 'a1'.
+	template <typename Function>
+	void for_each(const Function& function) const {
+		for (int i{ 0 }; i < word_count; i++) {
+			for (auto word{ words[i] }; word != 0; word &= word - 1)
+				function(Geometry::get_square(i * 64 + find_lowest_bit(word)));
+		}
+	}
+
+	SquareSet& operator|=(const SquareSet& other) {
+		for (int i{ 0 }; i < word_count; i++)
+			words[i] |= other.words[i];
+		return *this;
+	}
+
+	SquareSet& operator&=(const SquareSet& other) {
+		for (int i{ 0 }; i < word_count; i++)
+			words[i] &= other.words[i];
+		return *this;
+	}
+
+	SquareSet operator|(const SquareSet& other) const { return SquareSet{ *this } |= other; }
+	SquareSet operator&(const SquareSet& other) const { return SquareSet{ *this } &= other; }
+
+	bool operator==(const SquareSet& other) const { return words == other.words; }
+	bool operator!=(const SquareSet& other) const { return words != other.words; }
+
+	// The raw bits, one word per 64 squares. Bits past the last square are
+	// always zero.
+	const std::array<std::uint64_t, word_count>& get_words() const { return words; }
+
+private:
+	std::array<std::uint64_t, word_count> words{};
+};
+
+static_assert(sizeof(StandardGeometry::Set) == 8, "An 8x8 set is one word");
+static_assert(sizeof(CapablancaGeometry::Set) == 16, "A 10x8 set is two words");
+static_assert(sizeof(GrandGeometry::Set) == 16, "A 10x10 set is two words");
+
+#endif
@@ -0,0 +1,84 @@
+// Author: Daniel Kareh
+// Summary: A vector with a fixed capacity that never allocates memory. It's
+//          used for lists of moves, which have a known maximum size and are
+//          created and thrown away constantly.
+
+#ifndef CHESS_FIXED_VECTOR_H
+#define CHESS_FIXED_VECTOR_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+
+// `T` must be default-constructible. Going over the capacity is a bug.
+template <typename T, std::size_t Capacity>
+class FixedVector {
+public:
+	using value_type = T;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	FixedVector() = default;
+
+	FixedVector(std::initializer_list<T> values) {
+		for (const auto& value : values)
+			push_back(value);
+	}
+
+	void push_back(const T& value) {
+		assert(count < Capacity);
+		elements[count++] = value;
+	}
+
+	template <std::size_t OtherCapacity>
+	void append(const FixedVector<T, OtherCapacity>& other) {
+		for (const auto& value : other)
+			push_back(value);
+	}
+
+	iterator erase(iterator position) {
+		for (iterator it{ position }; it + 1 != end(); ++it)
+			*it = *(it + 1);
+		count--;
+		return position;
+	}
+
+	void clear() { count = 0; }
+
+	// Drop every element past the first `new_count`.
+	void truncate(std::size_t new_count) {
+		assert(new_count <= count);
+		count = new_count;
+	}
+
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	static constexpr std::size_t capacity() { return Capacity; }
+
+	T& operator[](std::size_t index) {
+		assert(index < count);
+		return elements[index];
+	}
+
+	const T& operator[](std::size_t index) const {
+		assert(index < count);
+		return elements[index];
+	}
+
+	T& front() { return (*this)[0]; }
+	const T& front() const { return (*this)[0]; }
+	T& back() { return (*this)[count - 1]; }
+	const T& back() const { return (*this)[count - 1]; }
+
+	iterator begin() { return elements.data(); }
+	iterator end() { return elements.data() + count; }
+	const_iterator begin() const { return elements.data(); }
+	const_iterator end() const { return elements.data() + count; }
+
+private:
+	std::array<T, Capacity> elements{};
+	std::size_t count{ 0 };
+};
+
+#endif
@@ -0,0 +1,110 @@
+// Author: Daniel Kareh
+// Summary: Classes that draw text-based pictures in a terminal without
+//          flicker. A picture is first composed into a grid of cells (a
+//          frame). The renderer compares it with the previous frame and only
+//          redraws the cells that changed, using ANSI escape sequences.
+
+#include "FrameRenderer.h"
+#include <algorithm>
+#include <cassert>
+
+// Moving the cursor costs about this many bytes, so it's cheaper to rewrite a
+// few unchanged cells than to jump over them.
+static const int cursor_move_cost{ 8 };
+
+// Rows and columns are zero-based here but one-based in ANSI escape sequences.
+static void move_cursor(std::string& output, int row, int column) {
+	output += "\x1b[";
+	output += std::to_string(row + 1);
+	output += ';';
+	output += std::to_string(column + 1);
+	output += 'H';
+}
+
+// Leave the cursor below the frame, where prompts are printed, and erase any
+// prompts that were printed after the previous frame.
+static void finish_frame(std::string& output, int height) {
+	move_cursor(output, height, 0);
+	output += "\x1b[J";
+}
+
+Frame::Frame(int width, int height)
+	: width{ std::max(width, 0) }
+	, height{ std::max(height, 0) }
+	, cells(static_cast<std::size_t>(this->width) * static_cast<std::size_t>(this->height), ' ') {}
+
+void Frame::put(int row, int column, std::string_view text) {
+	if (row < 0 || row >= height)
+		return;
+
+	for (const char cell : text) {
+		if (0 <= column && column < width)
+			cells[static_cast<std::size_t>(row * width + column)] = cell;
+		column++;
+	}
+}
+
+void Frame::put(int row, int column, char cell) { put(row, column, std::string_view{ &cell, 1 }); }
+
+std::string_view Frame::get_row(int row) const {
+	assert(0 <= row && row < height);
+	return { cells.data() + row * width, static_cast<std::size_t>(width) };
+}
+
+std::string FrameRenderer::render(const Frame& frame) {
+	const bool same_size{ previous && previous->get_width() == frame.get_width()
+		&& previous->get_height() == frame.get_height() };
+	auto output{ same_size ? render_changes(frame) : render_everything(frame) };
+	previous = frame;
+	return output;
+}
+
+std::string FrameRenderer::render_everything(const Frame& frame) const {
+	// Move to the top left corner and clear the screen, without pushing
+	// anything into the scrollback.
+	std::string output{ "\x1b[H\x1b[2J" };
+	for (int row{ 0 }; row < frame.get_height(); row++) {
+		auto line{ frame.get_row(row) };
+		line = line.substr(0, line.find_last_not_of(' ') + 1);
+		output += line;
+		output += "\r\n";
+	}
+	finish_frame(output, frame.get_height());
+	return output;
+}
+
+std::string FrameRenderer::render_changes(const Frame& frame) const {
+	std::string output;
+	for (int row{ 0 }; row < frame.get_height(); row++) {
+		const auto old_line{ previous->get_row(row) };
+		const auto new_line{ frame.get_row(row) };
+		const int width{ frame.get_width() };
+
+		int column{ 0 };
+		while (column < width) {
+			if (old_line[column] == new_line[column]) {
+				column++;
+				continue;
+			}
+
+			// Extend the run of changed cells over short unchanged gaps.
+			int end{ column + 1 };
+			int gap{ 0 };
+			for (int next{ end }; next < width; next++) {
+				if (old_line[next] != new_line[next]) {
+					end = next + 1;
+					gap = 0;
+				} else if (++gap > cursor_move_cost) {
+					break;
+				}
+			}
+
+			move_cursor(output, row, column);
+			output += new_line.substr(static_cast<std::size_t>(column),
+				static_cast<std::size_t>(end - column));
+			column = end;
+		}
+	}
+	finish_frame(output, frame.get_height());
+	return output;
+}
@@ -0,0 +1,53 @@
+// Author: Daniel Kareh
+// Summary: Classes that draw text-based pictures in a terminal without
+//          flicker. A picture is first composed into a grid of cells (a
+//          frame). The renderer compares it with the previous frame and only
+//          redraws the cells that changed, using ANSI escape sequences.
+
+#ifndef CHESS_FRAME_RENDERER_H
+#define CHESS_FRAME_RENDERER_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Frame {
+public:
+	// Every cell starts out as a space.
+	Frame(int width, int height);
+
+	int get_width() const { return width; }
+	int get_height() const { return height; }
+
+	// Text that doesn't fit in the frame is cut off.
+	void put(int row, int column, std::string_view text);
+	void put(int row, int column, char cell);
+
+	std::string_view get_row(int row) const;
+
+private:
+	int width;
+	int height;
+	std::vector<char> cells;
+};
+
+class FrameRenderer {
+public:
+	// Return the bytes that turn the previous frame on the screen into this
+	// one. The first frame clears the screen. Afterward, the cursor is on the
+	// line below the frame, and everything below that line is erased.
+	std::string render(const Frame&);
+
+	// Redraw everything next time, for instance because other output may
+	// have scrolled the frame out of place.
+	void invalidate() { previous.reset(); }
+
+private:
+	std::string render_everything(const Frame&) const;
+	std::string render_changes(const Frame&) const;
+
+	std::optional<Frame> previous;
+};
+
+#endif
@@ -4,18 +4,33 @@
 //          where everything comes together.
 
 #include "Game.h"
+#include "MovePicker.h"
+#include "allocation_profile.h"
+#include "instrument.h"
+
+// Enough for a long game's records, which are a few dozen bytes each. Idle
+// games don't allocate a chunk at all.
+static const std::size_t history_chunk_size{ 8 * 1024 };
 
 Game::Game(Board board, std::unique_ptr<UserInterface> user_interface, color active_color)
 	: board{ board }
 	, user_interface{ std::move(user_interface) }
-	, active_color{ active_color } {}
+	, active_color{ active_color }
+	, history_arena{ std::make_unique<Arena>(history_chunk_size) }
+	, history{ ArenaAllocator<MoveRecord>{ *history_arena } } {}
+
+Game::Game(Board board, color active_color)
+	: Game{ board, nullptr, active_color } {}
 
 void Game::run() {
 	for (;;) {
+		// The legal moves are generated once per position. Mate, check, and
+		// every attempt to enter a move (including illegal ones) use them.
+		const LegalMoveSet legal_moves{ board, active_color };
 		user_interface->show(board);
 
 		const std::string active_name{ active_color == color::black ? "Black" : "White" };
-		const mate mated{ detect_mate(active_color) };
+		const mate mated{ legal_moves.get_status() };
 		if (mated != mate::no) {
 			if (mated == mate::checkmate) {
 				user_interface->notify("Checkmate: " + active_name + " loses.");
@@ -25,35 +40,81 @@ void Game::run() {
 			return;
 		}
 
-		if (king_is_in_check(active_color))
-			user_interface->notify(active_name + ": " + "Your king is in check.");
+		for (;;) {
+			if (legal_moves.is_in_check())
+				user_interface->notify(active_name + ": " + "Your king is in check.");
+
+			// Analyze the position until the player has typed a move. The
+			// table is kept for the next turn.
+			if (ponderer)
+				ponderer->start(board, active_color);
+			const auto maybe_move{ user_interface->read_move(active_color) };
+			if (ponderer)
+				ponderer->stop();
+			if (!maybe_move)
+				return;
+			const Move move{ *maybe_move };
 
-		auto choose_move{
-			[this](const std::vector<MoveDetails>& choices) {
-				return user_interface->choose_move(choices);
-			},
-		};
-		auto move{ user_interface->read_move(active_color) };
-		auto details{ board.move(move, choose_move) };
+			auto choose_move{
+				[this, move](const std::vector<MoveDetails>& choices) {
+					return user_interface->choose_move(board, move, choices);
+				},
+			};
+			if (play(move, choose_move, legal_moves))
+				break;
 
-		if (!details) {
 			user_interface->notify("Illegal move.", notify_pause::yes);
-			continue;
+			user_interface->show(board);
 		}
-
-		active_color = get_opposing_color(active_color);
 	}
 }
 
+void Game::enable_pondering(std::size_t table_megabytes) {
+	ponderer = std::make_unique<Ponderer>(table_megabytes);
+	if (user_interface)
+		user_interface->set_ponderer(ponderer.get());
+}
+
+std::optional<MoveDetails> Game::play(Move move, const Board::ChooseMoveCallback& choose_move) {
+	if (move.active_color != active_color)
+		return std::nullopt;
+
+	auto details{ board.move(move, choose_move) };
+	if (details)
+		record_move(move, *details);
+	return details;
+}
+
+std::optional<MoveDetails> Game::play(
+	Move move, const Board::ChooseMoveCallback& choose_move, const LegalMoveSet& legal_moves) {
+	const auto legal_details{ legal_moves.get_moves(move) };
+	if (legal_details.empty())
+		return std::nullopt;
+
+	// Which move should we actually apply?
+	const std::vector<MoveDetails> details(legal_details.begin(), legal_details.end());
+	const int choice{ choose_move(details) };
+	if (choice < 0 || details.size() <= static_cast<std::size_t>(choice))
+		return std::nullopt;
+
+	board.play({ move, details[choice] });
+	record_move(move, details[choice]);
+	return details[choice];
+}
+
+void Game::record_move(Move move, MoveDetails details) {
+	history.push_back({ move, details });
+	active_color = get_opposing_color(active_color);
+}
+
 mate Game::detect_mate(color color) const {
-	// Checkmate/stalemate occurs whenever a player has no legal moves.
-	for (const Square from : board) {
-		for (const Square to : board) {
-			const Move move{ color, from, to };
-			if (!board.get_legal_moves(move).empty())
-				return mate::no;
-		}
-	}
+	CHESS_TIME_SCOPE(detect_mate);
+	CHESS_EXPECT_NO_ALLOCATIONS("Game::detect_mate");
+
+	// Checkmate/stalemate occurs whenever a player has no legal moves. The
+	// picker stops generating moves as soon as it finds one.
+	if (MovePicker{ board, color }.next())
+		return mate::no;
 
 	// If the player has no legal moves and their king currently in check,
 	// that's checkmate. If they have no legal moves, but their king is not in
@@ -7,28 +7,64 @@
 #define CHESS_GAME_H
 
 #include <memory>
+#include "Arena.h"
 #include "Board.h"
+#include "LegalMoveSet.h"
+#include "Ponderer.h"
 #include "UserInterface.h"
 
-enum class mate : unsigned char {
-	no,
-	checkmate,
-	stalemate,
+// A move that was played, in the order it was played.
+struct MoveRecord {
+	Move move;
+	MoveDetails details;
 };
 
 class Game {
 public:
 	Game(Board, std::unique_ptr<UserInterface>, color = color::white);
 
+	// A game without a user interface can only be driven by `play`.
+	explicit Game(Board, color = color::white);
+
+	// Play until the game ends or the user interface runs out of moves.
 	void run();
 
+	// While `run` waits for a move, analyze the position on another thread,
+	// and show the analysis when the player has to choose between moves.
+	void enable_pondering(std::size_t table_megabytes = 64);
+
+	// Try to make a move for the active player. If the move is legal, the
+	// other player becomes active. Otherwise, nothing changes.
+	std::optional<MoveDetails> play(Move, const Board::ChooseMoveCallback&);
+
+	// Like the other `play`, but the move is looked up in the active
+	// player's legal moves, which must be for the current position.
+	std::optional<MoveDetails> play(
+		Move, const Board::ChooseMoveCallback&, const LegalMoveSet& legal_moves);
+
+	const Board& get_board() const { return board; }
+	color get_active_color() const { return active_color; }
+	mate get_status() const { return detect_mate(active_color); }
+	bool is_in_check() const { return king_is_in_check(active_color); }
+
+	// Every move played so far, stored one after the other in the game's own
+	// arena.
+	const ArenaVector<MoveRecord>& get_history() const { return history; }
+
 private:
 	mate detect_mate(color) const;
 	bool king_is_in_check(color) const;
+	void record_move(Move, MoveDetails);
 
 	Board board;
 	std::unique_ptr<UserInterface> user_interface;
+	std::unique_ptr<Ponderer> ponderer;
 	color active_color;
+
+	// The arena lives on the heap so that moving a game doesn't move it out
+	// from under the history.
+	std::unique_ptr<Arena> history_arena;
+	ArenaVector<MoveRecord> history;
 };
 
 #endif
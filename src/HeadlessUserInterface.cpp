@@ -0,0 +1,75 @@
+// Author: Daniel Kareh
+// Summary: A user interface that reads its moves from a script (a file or a
+//          pipe) and draws nothing, so that logged games can be replayed at
+//          full speed. It times how long the game takes to play each move.
+
+#include "HeadlessUserInterface.h"
+#include "san.h"
+
+static bool is_game_result(std::string_view token) {
+	return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// Remove a move number like '12.' or '12...' from the front of a token, which
+// may leave nothing (if the number was written apart from the move).
+static std::string_view remove_move_number(std::string_view token) {
+	std::size_t digits{ 0 };
+	while (digits < token.size() && '0' <= token[digits] && token[digits] <= '9')
+		digits++;
+	if (digits == 0 || digits == token.size() || token[digits] != '.')
+		return token;
+
+	const std::size_t end{ token.find_first_not_of('.', digits) };
+	return end == std::string_view::npos ? std::string_view{} : token.substr(end);
+}
+
+void HeadlessUserInterface::show(const Board& new_board) {
+	// The game asks to show the board once the move has been played and the
+	// next turn is ready, which is when the move is done.
+	if (move_start) {
+		move_times.push_back(std::chrono::steady_clock::now() - *move_start);
+		move_start.reset();
+	}
+	board = new_board;
+}
+
+std::optional<Move> HeadlessUserInterface::read_move(color active_color) {
+	const auto token{ read_token() };
+	if (!token)
+		return std::nullopt;
+
+	pending_move = parse_coordinate_move(*token, board, active_color);
+	if (!pending_move)
+		pending_move = parse_san(*token, board, active_color);
+	if (!pending_move) {
+		error = "Invalid or illegal move: " + *token;
+		return std::nullopt;
+	}
+
+	move_start = std::chrono::steady_clock::now();
+	return pending_move->move;
+}
+
+void HeadlessUserInterface::notify(std::string_view message, notify_pause) {
+	last_notification = message;
+}
+
+// The move was already chosen when it was parsed.
+int HeadlessUserInterface::choose_move(
+	const Board&, Move, const std::vector<MoveDetails>& choices) {
+	for (std::size_t i{ 0 }; i < choices.size(); i++) {
+		if (pending_move && is_same_move({ pending_move->move, choices[i] }, *pending_move))
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+std::optional<std::string> HeadlessUserInterface::read_token() {
+	std::string token;
+	while (script >> token) {
+		const std::string_view move{ remove_move_number(token) };
+		if (!move.empty() && !is_game_result(move))
+			return std::string{ move };
+	}
+	return std::nullopt;
+}
@@ -0,0 +1,53 @@
+// Author: Daniel Kareh
+// Summary: A user interface that reads its moves from a script (a file or a
+//          pipe) and draws nothing, so that logged games can be replayed at
+//          full speed. It times how long the game takes to play each move.
+
+#ifndef CHESS_HEADLESS_USER_INTERFACE_H
+#define CHESS_HEADLESS_USER_INTERFACE_H
+
+#include <chrono>
+#include <istream>
+#include <string>
+#include <vector>
+#include "UserInterface.h"
+
+class HeadlessUserInterface : public UserInterface {
+public:
+	// The script has moves in coordinate notation (like 'e2e4' or 'e7e8q') or
+	// in SAN (like 'Nf3' or 'O-O'), separated by whitespace. Move numbers
+	// (like '12.' or '12...') and game results (like '1-0') are skipped, so
+	// the movetext of a PGN game works too. The stream must outlive the
+	// interface.
+	explicit HeadlessUserInterface(std::istream& script)
+		: script{ script } {}
+
+	virtual void show(const Board&) override;
+	virtual std::optional<Move> read_move(color active_color) override;
+	virtual void notify(std::string_view message, notify_pause) override;
+	virtual int choose_move(const Board&, Move, const std::vector<MoveDetails>&) override;
+
+	// How long each move took, from reading it to being asked for the next
+	// one. This includes checking the move and looking for mate afterward.
+	const std::vector<std::chrono::nanoseconds>& get_move_times() const { return move_times; }
+
+	// Why the replay stopped early (an invalid or illegal move in the
+	// script), or empty if it didn't.
+	const std::string& get_error() const { return error; }
+
+	// The last thing the game announced, such as "Checkmate: White loses."
+	const std::string& get_last_notification() const { return last_notification; }
+
+private:
+	std::optional<std::string> read_token();
+
+	std::istream& script;
+	Board board;
+	std::optional<LegalMove> pending_move;
+	std::optional<std::chrono::steady_clock::time_point> move_start;
+	std::vector<std::chrono::nanoseconds> move_times;
+	std::string error;
+	std::string last_notification;
+};
+
+#endif
@@ -0,0 +1,43 @@
+// Author: Daniel Kareh
+// Summary: A class that generates every legal move of a position once and
+//          then answers the questions a turn asks about them (is it mate, is
+//          the king in check, is this move legal, and what can a pawn promote
+//          to) without generating them again.
+
+#include "LegalMoveSet.h"
+
+LegalMoveSet::LegalMoveSet(const Board& board, color active_color)
+	: active_color{ active_color }
+	, in_check{ board.piece_is_under_attack(board.find_king(active_color)) } {
+	board.generate_legal_moves(active_color, moves);
+
+	// The generator hands out every move from one square before moving on
+	// to the next square.
+	for (std::size_t i{ 0 }; i < moves.size();) {
+		const int from{ Board::Geometry::get_index(moves[i].move.from) };
+		moves_from[from].begin = static_cast<std::uint16_t>(i);
+		while (i < moves.size() && Board::Geometry::get_index(moves[i].move.from) == from)
+			i++;
+		moves_from[from].end = static_cast<std::uint16_t>(i);
+	}
+}
+
+mate LegalMoveSet::get_status() const {
+	if (!moves.empty())
+		return mate::no;
+	return in_check ? mate::checkmate : mate::stalemate;
+}
+
+MoveDetailsList LegalMoveSet::get_moves(Move move) const {
+	MoveDetailsList details;
+	if (move.active_color != active_color || !Board::Geometry::is_in_bounds(move.from)
+		|| !Board::Geometry::is_in_bounds(move.to))
+		return details;
+
+	const Range range{ moves_from[Board::Geometry::get_index(move.from)] };
+	for (std::size_t i{ range.begin }; i < range.end; i++) {
+		if (moves[i].move.to == move.to)
+			details.push_back(moves[i].details);
+	}
+	return details;
+}
@@ -0,0 +1,47 @@
+// Author: Daniel Kareh
+// Summary: A class that generates every legal move of a position once and
+//          then answers the questions a turn asks about them (is it mate, is
+//          the king in check, is this move legal, and what can a pawn promote
+//          to) without generating them again.
+
+#ifndef CHESS_LEGAL_MOVE_SET_H
+#define CHESS_LEGAL_MOVE_SET_H
+
+#include <array>
+#include <cstdint>
+#include "Board.h"
+
+enum class mate : unsigned char {
+	no,
+	checkmate,
+	stalemate,
+};
+
+class LegalMoveSet {
+public:
+	// The set is a snapshot: it doesn't change when the board does.
+	LegalMoveSet(const Board&, color active_color);
+
+	mate get_status() const;
+	bool is_in_check() const { return in_check; }
+
+	// The legal ways to make a move, e.g. one for each promotion. Empty if
+	// the move is illegal (or isn't on the board at all).
+	MoveDetailsList get_moves(Move) const;
+
+	const MoveList& get_all_moves() const { return moves; }
+
+private:
+	// The moves from each square are next to each other in `moves`.
+	struct Range {
+		std::uint16_t begin{ 0 };
+		std::uint16_t end{ 0 };
+	};
+
+	MoveList moves;
+	std::array<Range, Board::Geometry::square_count> moves_from;
+	color active_color;
+	bool in_check;
+};
+
+#endif
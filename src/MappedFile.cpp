@@ -0,0 +1,117 @@
+// Author: Daniel Kareh
+// Summary: A read-only view of an entire file that has been mapped into
+//          memory. The operating system pages the file in on demand, and
+//          processes that map the same file share the same physical pages.
+
+#ifdef CHESS_ON_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define STRICT
+#endif
+
+#include "MappedFile.h"
+#include <stdexcept>
+#include <utility> // For std::exchange.
+
+#ifdef CHESS_ON_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef CHESS_ON_WINDOWS
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file{ CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error{ "Cannot open " + path };
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file, &file_size) == 0) {
+		CloseHandle(file);
+		throw std::runtime_error{ "Cannot determine the size of " + path };
+	}
+
+	if (file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return;
+	}
+
+	// The mapping object keeps the file open, so both handles can be closed
+	// as soon as the view exists.
+	HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+	CloseHandle(file);
+	if (mapping == nullptr)
+		throw std::runtime_error{ "Cannot map " + path };
+
+	address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (address == nullptr)
+		throw std::runtime_error{ "Cannot map " + path };
+
+	length = static_cast<std::size_t>(file_size.QuadPart);
+}
+
+void MappedFile::advise_sequential() const {}
+
+void MappedFile::unmap() {
+	if (address != nullptr)
+		UnmapViewOfFile(address);
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+	const int descriptor{ open(path.c_str(), O_RDONLY) };
+	if (descriptor < 0)
+		throw std::runtime_error{ "Cannot open " + path };
+
+	struct stat status {};
+	if (fstat(descriptor, &status) != 0) {
+		close(descriptor);
+		throw std::runtime_error{ "Cannot determine the size of " + path };
+	}
+
+	if (status.st_size == 0) {
+		close(descriptor);
+		return;
+	}
+
+	// The mapping keeps its own reference to the file, so the descriptor can
+	// be closed right away.
+	const auto file_size{ static_cast<std::size_t>(status.st_size) };
+	void* mapped{ mmap(nullptr, file_size, PROT_READ, MAP_SHARED, descriptor, 0) };
+	close(descriptor);
+	if (mapped == MAP_FAILED)
+		throw std::runtime_error{ "Cannot map " + path };
+
+	address = mapped;
+	length = file_size;
+}
+
+void MappedFile::advise_sequential() const {
+	if (address != nullptr)
+		madvise(const_cast<void*>(address), length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::unmap() {
+	if (address != nullptr)
+		munmap(const_cast<void*>(address), length);
+}
+#endif
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: address{ std::exchange(other.address, nullptr) }
+	, length{ std::exchange(other.length, 0) } {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		unmap();
+		address = std::exchange(other.address, nullptr);
+		length = std::exchange(other.length, 0);
+	}
+	return *this;
+}
@@ -0,0 +1,40 @@
+// Author: Daniel Kareh
+// Summary: A read-only view of an entire file that has been mapped into
+//          memory. The operating system pages the file in on demand, and
+//          processes that map the same file share the same physical pages.
+
+#ifndef CHESS_MAPPED_FILE_H
+#define CHESS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+public:
+	// Throws `std::runtime_error` if the file cannot be opened or mapped.
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) noexcept;
+	MappedFile& operator=(MappedFile&&) noexcept;
+
+	const unsigned char* data() const { return static_cast<const unsigned char*>(address); }
+	std::size_t size() const { return length; }
+	std::string_view view() const { return { static_cast<const char*>(address), length }; }
+
+	// Tell the operating system that the file will be read from front to back.
+	void advise_sequential() const;
+
+private:
+	void unmap();
+
+	// NOTE: An empty file is represented by a null address and a zero length
+	// because zero-length mappings are not allowed.
+	const void* address{ nullptr };
+	std::size_t length{ 0 };
+};
+
+#endif
@@ -0,0 +1,259 @@
+// Author: Daniel Kareh
+// Summary: A solver that proves forced mates with depth-first proof-number
+//          search (df-pn). It looks only for mate, so it proves or refutes
+//          "mate in N" much faster than an alpha-beta search would.
+
+#include "MateSolver.h"
+#include <algorithm>
+#include <limits>
+#include "FixedVector.h"
+#include "zobrist.h"
+
+// A node is solved when one of its numbers reaches infinity. Sums of
+// unsolved children stop just below it.
+static const std::uint32_t infinity{ std::numeric_limits<std::uint32_t>::max() / 2 };
+
+// Each slot of the table holds this many entries.
+static const std::size_t bucket_size{ 2 };
+
+// Whether the attacker can mate depends on how many plies are left, so the
+// number of plies is part of a node's key.
+static std::uint64_t get_key(const Board& board, color active_color, int plies) {
+	const std::uint64_t key{ zobrist_hash(board, active_color)
+		^ static_cast<std::uint64_t>(plies) * 0x9E3779B97F4A7C15 };
+	return key == 0 ? 1 : key;
+}
+
+static bool is_in_check(const Board& board, color active_color) {
+	return board.piece_is_under_attack(board.find_king(active_color));
+}
+
+// The number of buckets is a power of two so that a bucket is found by
+// masking the key.
+static std::size_t get_entry_count(std::size_t megabytes, std::size_t entry_size) {
+	const std::size_t wanted{ std::max<std::size_t>(
+		megabytes * 1024 * 1024 / (entry_size * bucket_size), 1) };
+	std::size_t count{ 1 };
+	while (count * 2 <= wanted)
+		count *= 2;
+	return count * bucket_size;
+}
+
+MateSolver::MateSolver(std::size_t megabytes)
+	: entries(get_entry_count(megabytes, sizeof(Entry))) {}
+
+void MateSolver::clear() { std::fill(entries.begin(), entries.end(), Entry{}); }
+
+const MateSolver::Entry* MateSolver::probe(std::uint64_t key) const {
+	const std::size_t bucket{ key & (entries.size() / bucket_size - 1) };
+	for (std::size_t i{ 0 }; i < bucket_size; i++) {
+		const Entry& entry{ entries[bucket * bucket_size + i] };
+		if (entry.key == key)
+			return &entry;
+	}
+	return nullptr;
+}
+
+void MateSolver::store(std::uint64_t key, Numbers numbers, std::uint32_t work) {
+	const std::size_t bucket{ key & (entries.size() / bucket_size - 1) };
+	Entry* replaced{ &entries[bucket * bucket_size] };
+	for (std::size_t i{ 0 }; i < bucket_size; i++) {
+		Entry& entry{ entries[bucket * bucket_size + i] };
+		if (entry.key == key) {
+			replaced = &entry;
+			break;
+		}
+		if (entry.work < replaced->work)
+			replaced = &entry;
+	}
+	*replaced = { key, numbers, work };
+}
+
+MateSolution MateSolver::solve(
+	const Board& board, color attacker, int max_moves, std::uint64_t max_nodes) {
+	MateSolution solution;
+	nodes = 0;
+	this->max_nodes = max_nodes;
+
+	// Shorter mates are usually much cheaper to prove, and trying them first
+	// makes sure that the mate found is the shortest one.
+	Board scratch{ board };
+	for (int moves{ 1 }; moves <= max_moves; moves++) {
+		const Numbers root{ search(scratch, attacker, 2 * moves - 1, { infinity, infinity }) };
+		if (root.phi == 0) {
+			solution.proof = mate_proof::proven;
+			solution.moves = moves;
+			this->max_nodes = 0;
+			solution.line = get_line(board, attacker, 2 * moves - 1);
+			break;
+		}
+		if (root.delta != 0) {
+			solution.proof = mate_proof::unknown;
+			break;
+		}
+		solution.proof = mate_proof::disproven;
+	}
+
+	solution.nodes = nodes;
+	return solution;
+}
+
+// `plies` counts the moves of both players that are left, so the attacker
+// moves when it's odd and the defender when it's even.
+MateSolver::Numbers MateSolver::search(
+	Board& board, color active_color, int plies, Numbers thresholds) {
+	const std::uint64_t key{ get_key(board, active_color, plies) };
+	const Entry* entry{ probe(key) };
+	if (entry && (entry->numbers.phi == 0 || entry->numbers.delta == 0))
+		return entry->numbers;
+
+	const std::uint64_t first_node{ nodes++ };
+	const bool attacking{ plies % 2 == 1 };
+	MoveList moves;
+	board.generate_legal_moves(active_color, moves);
+
+	// Checkmate is a loss for whoever is to move, and so is stalemate for
+	// the attacker. Once the attacker is out of moves, any position that
+	// isn't mate is an escape for the defender.
+	Numbers numbers;
+	if (moves.empty()) {
+		const bool lost{ attacking || is_in_check(board, active_color) };
+		numbers = lost ? Numbers{ infinity, 0 } : Numbers{ 0, infinity };
+	} else if (plies == 0) {
+		numbers = { 0, infinity };
+	}
+	if (moves.empty() || plies == 0) {
+		store(key, numbers, 1);
+		return numbers;
+	}
+
+	struct Child {
+		LegalMove move;
+		std::uint64_t key;
+		Numbers numbers;
+	};
+
+	// Checks are tried first because they leave the defender the fewest
+	// replies. With one ply left, only a check can still mate.
+	const color opponent{ get_opposing_color(active_color) };
+	FixedVector<Child, MoveList::capacity()> children;
+	std::size_t check_count{ 0 };
+	for (const auto& move : moves) {
+		const auto undo{ board.make_move(move) };
+		Child child{ move, get_key(board, opponent, plies - 1), {} };
+		const bool gives_check{ attacking && is_in_check(board, opponent) };
+		board.unmake_move(undo);
+
+		if (const Entry* child_entry{ probe(child.key) })
+			child.numbers = child_entry->numbers;
+		else if (attacking && plies == 1 && !gives_check)
+			child.numbers = { 0, infinity };
+
+		children.push_back(child);
+		if (gives_check)
+			std::rotate(children.begin() + check_count++, children.end() - 1, children.end());
+	}
+
+	for (;;) {
+		// The player to move needs just one child that reaches their goal,
+		// but every child has to fail for them to fail.
+		std::size_t best{ 0 };
+		std::uint32_t second_delta{ infinity };
+		std::uint64_t delta{ 0 };
+		for (std::size_t i{ 0 }; i < children.size(); i++) {
+			const Numbers child{ children[i].numbers };
+			delta += child.phi;
+			if (child.delta < children[best].numbers.delta) {
+				second_delta = children[best].numbers.delta;
+				best = i;
+			} else if (i != best && child.delta < second_delta) {
+				second_delta = child.delta;
+			}
+		}
+
+		const bool any_infinite{ std::any_of(children.begin(), children.end(),
+			[](const Child& child) { return child.numbers.phi >= infinity; }) };
+		numbers.phi = children[best].numbers.delta;
+		numbers.delta = any_infinite ? infinity
+									 : static_cast<std::uint32_t>(
+										   std::min<std::uint64_t>(delta, infinity - 1));
+
+		const bool out_of_nodes{ max_nodes != 0 && nodes >= max_nodes };
+		if (numbers.phi >= thresholds.phi || numbers.delta >= thresholds.delta || out_of_nodes)
+			break;
+
+		// Search the most promising child until it stops being the most
+		// promising one (or this node's numbers reach their thresholds).
+		Child& child{ children[best] };
+		const std::uint64_t child_phi{ std::uint64_t{ thresholds.delta } + child.numbers.phi
+			- numbers.delta };
+		const Numbers child_thresholds{
+			static_cast<std::uint32_t>(std::min<std::uint64_t>(child_phi, infinity)),
+			std::min(thresholds.phi, second_delta + 1),
+		};
+
+		const auto undo{ board.make_move(child.move) };
+		child.numbers = search(board, opponent, plies - 1, child_thresholds);
+		board.unmake_move(undo);
+	}
+
+	const std::uint64_t work{ nodes - first_node };
+	store(key, numbers,
+		static_cast<std::uint32_t>(
+			std::min<std::uint64_t>(work, std::numeric_limits<std::uint32_t>::max())));
+	return numbers;
+}
+
+// The fewest plies (no more than `plies`, and of the same parity) in which
+// the attacker can force mate, or nothing if they can't. A mate that can be
+// forced in some number of plies can also be forced in two more.
+std::optional<int> MateSolver::get_mate_plies(
+	Board& board, color active_color, color attacker, int plies) {
+	std::optional<int> shortest;
+	for (; plies >= 0; plies -= 2) {
+		const Numbers numbers{ search(board, active_color, plies, { infinity, infinity }) };
+		if ((active_color == attacker ? numbers.phi : numbers.delta) != 0)
+			break;
+		shortest = plies;
+	}
+	return shortest;
+}
+
+// Walk down a proven node, choosing the quickest mate for the attacker and
+// the defense that delays it the longest. Nodes that were pushed out of the
+// table are simply proven again.
+std::vector<LegalMove> MateSolver::get_line(Board board, color attacker, int plies) {
+	std::vector<LegalMove> line;
+	color active_color{ attacker };
+	while (plies > 0) {
+		const bool attacking{ active_color == attacker };
+		const color opponent{ get_opposing_color(active_color) };
+		MoveList moves;
+		board.generate_legal_moves(active_color, moves);
+
+		std::optional<LegalMove> chosen;
+		int chosen_plies{ 0 };
+		for (const auto& move : moves) {
+			const auto undo{ board.make_move(move) };
+			const auto mate_plies{ get_mate_plies(board, opponent, attacker, plies - 1) };
+			board.unmake_move(undo);
+
+			if (!mate_plies)
+				continue;
+			if (!chosen || (attacking ? *mate_plies < chosen_plies : *mate_plies > chosen_plies)) {
+				chosen = move;
+				chosen_plies = *mate_plies;
+			}
+		}
+
+		// The defender is mated (which may happen before all plies are used).
+		if (!chosen)
+			break;
+
+		line.push_back(*chosen);
+		board.play(*chosen);
+		active_color = opponent;
+		plies = chosen_plies;
+	}
+	return line;
+}
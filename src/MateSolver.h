@@ -0,0 +1,78 @@
+// Author: Daniel Kareh
+// Summary: A solver that proves forced mates with depth-first proof-number
+//          search (df-pn). It looks only for mate, so it proves or refutes
+//          "mate in N" much faster than an alpha-beta search would.
+
+#ifndef CHESS_MATE_SOLVER_H
+#define CHESS_MATE_SOLVER_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Board.h"
+
+enum class mate_proof : unsigned char {
+	// The attacker can force mate.
+	proven,
+	// The defender can avoid mate for the given number of moves.
+	disproven,
+	// The node limit was reached first.
+	unknown,
+};
+
+struct MateSolution {
+	mate_proof proof{ mate_proof::unknown };
+	// The fewest moves (by the attacker) that force mate, if it was proven.
+	int moves{ 0 };
+	// A line that ends in mate, starting with the attacker's move. The
+	// attacker always takes the quickest mate, and the defender the reply
+	// that delays it the longest.
+	std::vector<LegalMove> line;
+	std::uint64_t nodes{ 0 };
+};
+
+class MateSolver {
+public:
+	// The node table never grows: a node replaces the one in its slot that
+	// took less work to search.
+	explicit MateSolver(std::size_t megabytes = 16);
+
+	// Look for a mate by `attacker` (the player to move) in at most
+	// `max_moves` of their moves, trying shorter mates first. Give up after
+	// (roughly) `max_nodes` nodes; zero means no limit. The fifty-move rule
+	// and repetitions are ignored, as usual for mate problems.
+	MateSolution solve(const Board&, color attacker, int max_moves, std::uint64_t max_nodes = 0);
+
+	void clear();
+
+private:
+	// The proof number (phi) and disproof number (delta) of a node, from the
+	// point of view of the player to move there: phi is zero once that
+	// player is known to reach their goal (mate for the attacker, escape for
+	// the defender), and delta is zero once they are known to fail.
+	struct Numbers {
+		std::uint32_t phi{ 1 };
+		std::uint32_t delta{ 1 };
+	};
+
+	struct Entry {
+		// Zero marks an empty entry.
+		std::uint64_t key{ 0 };
+		Numbers numbers;
+		// How many nodes the last search of this node visited.
+		std::uint32_t work{ 0 };
+	};
+
+	Numbers search(Board&, color active_color, int plies, Numbers thresholds);
+	std::optional<int> get_mate_plies(Board&, color active_color, color attacker, int plies);
+	std::vector<LegalMove> get_line(Board, color attacker, int plies);
+
+	const Entry* probe(std::uint64_t key) const;
+	void store(std::uint64_t key, Numbers, std::uint32_t work);
+
+	std::vector<Entry> entries;
+	std::uint64_t nodes{ 0 };
+	std::uint64_t max_nodes{ 0 };
+};
+
+#endif
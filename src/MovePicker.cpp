@@ -0,0 +1,205 @@
+// Author: Daniel Kareh
+// Summary: A class that hands out the legal moves of a position one at a time,
+//          best guesses first. Moves are generated in stages and only tested
+//          for legality when they're handed out, so a caller that stops early
+//          (after a cutoff, or after finding out that there is a legal move)
+//          skips the rest of the work.
+
+#include "MovePicker.h"
+#include <utility>
+#include "Search.h"
+#include "see.h"
+#include "throw_if_empty.h"
+
+// Losing captures are pushed below zero, under every winning capture.
+static const int losing_capture_penalty{ 20000 };
+
+MovePicker::MovePicker(const Board& board, color active_color, std::optional<LegalMove> hash_move)
+	: board{ &board }
+	, active_color{ active_color }
+	, hash_move{ hash_move }
+	, quiet_pieces{ board.get_occupied_squares(active_color) } {}
+
+std::optional<LegalMove> MovePicker::next() {
+	for (;;) {
+		switch (current_stage) {
+		case stage::hash_move: {
+			// Remember the hash move only if it's handed out, so that later
+			// stages skip it.
+			current_stage = stage::generate_captures;
+			hash_move = pick_hash_move();
+			if (hash_move)
+				return hash_move;
+			break;
+		}
+		case stage::generate_captures:
+			current_stage = stage::winning_captures;
+			generate_captures();
+			break;
+		case stage::winning_captures:
+			if (next_capture < capture_count && select_best_capture() >= 0) {
+				const auto& candidate{ moves[next_capture++] };
+				if (accept(candidate))
+					return candidate;
+				break;
+			}
+			current_stage = stage::promotions;
+			generate_promotions();
+			break;
+		case stage::promotions:
+		case stage::quiets:
+			if (next_batch_move < moves.size()) {
+				const auto& candidate{ moves[next_batch_move++] };
+				if (accept(candidate))
+					return candidate;
+				break;
+			}
+			current_stage = stage::quiets;
+			if (!generate_next_quiets())
+				current_stage = stage::losing_captures;
+			break;
+		case stage::losing_captures:
+			if (next_capture < capture_count) {
+				select_best_capture();
+				const auto& candidate{ moves[next_capture++] };
+				if (accept(candidate))
+					return candidate;
+				break;
+			}
+			current_stage = stage::done;
+			break;
+		case stage::done:
+			return std::nullopt;
+		}
+	}
+}
+
+std::optional<LegalMove> MovePicker::pick_hash_move() const {
+	if (!hash_move || hash_move->move.active_color != active_color)
+		return std::nullopt;
+
+	// The hash move may not even be pseudo-legal here, so generate it again
+	// instead of trusting its details.
+	for (const auto& details : generate_move_details(hash_move->move, *board)) {
+		const LegalMove candidate{ hash_move->move, details };
+		if (is_same_move(candidate, *hash_move) && board->is_legal(candidate))
+			return candidate;
+	}
+	return std::nullopt;
+}
+
+// Captures are scored by the most valuable victim and the least valuable
+// attacker (MVV-LVA). Taking a piece with a more valuable one might be a
+// losing capture, which the static exchange evaluation decides; losing
+// captures are ordered by how much they lose.
+void MovePicker::generate_captures() {
+	const auto targets{ board->get_occupied_squares(get_opposing_color(active_color)) };
+	const Square en_passant_target{ board->get_en_passant_target() };
+	board->get_occupied_squares(active_color).for_each([&](Square from) {
+		const Piece attacker{ throw_if_empty(board->get_piece(from)) };
+		const int attacker_value{ get_piece_value(attacker.type) };
+		const auto add_captures{ [&](Square to) {
+			for (const auto& details : generate_move_details({ active_color, from, to }, *board)) {
+				if (!details.captured_square)
+					continue;
+
+				const LegalMove capture{ { active_color, from, to }, details };
+				const Piece victim{ throw_if_empty(board->get_piece(*details.captured_square)) };
+				const int victim_value{ get_piece_value(victim.type) };
+				int score{ 10 * victim_value - attacker_value };
+				if (details.promote_to) {
+					score += get_piece_value(*details.promote_to);
+				} else if (victim_value < attacker_value) {
+					const int exchange{ evaluate_exchange(*board, capture) };
+					if (exchange < 0)
+						score = exchange - losing_capture_penalty;
+				}
+
+				capture_scores[moves.size()] = score;
+				moves.push_back(capture);
+			}
+		} };
+
+		targets.for_each(add_captures);
+		if (attacker.type == piece_type::pawn && board->is_in_bounds(en_passant_target))
+			add_captures(en_passant_target);
+	});
+	capture_count = moves.size();
+	next_batch_move = capture_count;
+}
+
+// Pawns that promote without capturing, best promotion first.
+void MovePicker::generate_promotions() {
+	moves.truncate(capture_count);
+	next_batch_move = capture_count;
+
+	const int direction{ active_color == color::black ? -1 : 1 };
+	const int promotion_rank{ active_color == color::black ? 0 : Board::Geometry::ranks - 1 };
+	quiet_pieces.for_each([&](Square from) {
+		if (from.get_rank() + direction != promotion_rank)
+			return;
+		if (throw_if_empty(board->get_piece(from)).type != piece_type::pawn)
+			return;
+
+		const Move move{ active_color, from, { promotion_rank, from.get_file() } };
+		const auto details{ generate_move_details(move, *board) };
+		for (auto it{ details.end() }; it != details.begin();) {
+			--it;
+			moves.push_back({ move, *it });
+		}
+	});
+}
+
+// Generate the quiet moves of the next piece that has any. Return false once
+// there are no pieces left.
+bool MovePicker::generate_next_quiets() {
+	moves.truncate(capture_count);
+	next_batch_move = capture_count;
+
+	const auto opponents{ board->get_occupied_squares(get_opposing_color(active_color)) };
+	const auto own_pieces{ board->get_occupied_squares(active_color) };
+	while (!quiet_pieces.empty()) {
+		const Square from{ quiet_pieces.get_first() };
+		quiet_pieces.erase(from);
+
+		// Only a castling king can land on a square with its own piece (the
+		// rook, in Chess960).
+		const bool is_king{ throw_if_empty(board->get_piece(from)).is_king() };
+		for (int index{ 0 }; index < Board::Geometry::square_count; index++) {
+			const Square to{ Board::Geometry::get_square(index) };
+			if (opponents.contains(to) || (!is_king && own_pieces.contains(to)))
+				continue;
+
+			const Move move{ active_color, from, to };
+			for (const auto& details : generate_move_details(move, *board)) {
+				// Captures (en passant) and promotions had their own stages.
+				if (!details.captured_square && !details.promote_to)
+					moves.push_back({ move, details });
+			}
+		}
+
+		if (moves.size() > capture_count)
+			return true;
+	}
+	return false;
+}
+
+// Move the best capture that hasn't been handed out yet to the front of the
+// rest, and return its score.
+int MovePicker::select_best_capture() {
+	std::size_t best{ next_capture };
+	for (std::size_t i{ next_capture + 1 }; i < capture_count; i++) {
+		if (capture_scores[i] > capture_scores[best])
+			best = i;
+	}
+	std::swap(moves[best], moves[next_capture]);
+	std::swap(capture_scores[best], capture_scores[next_capture]);
+	return capture_scores[next_capture];
+}
+
+// The hash move was already handed out, so it's skipped in later stages.
+bool MovePicker::accept(const LegalMove& candidate) const {
+	if (hash_move && is_same_move(candidate, *hash_move))
+		return false;
+	return board->is_legal(candidate);
+}
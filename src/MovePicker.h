@@ -0,0 +1,67 @@
+// Author: Daniel Kareh
+// Summary: A class that hands out the legal moves of a position one at a time,
+//          best guesses first. Moves are generated in stages and only tested
+//          for legality when they're handed out, so a caller that stops early
+//          (after a cutoff, or after finding out that there is a legal move)
+//          skips the rest of the work.
+
+#ifndef CHESS_MOVE_PICKER_H
+#define CHESS_MOVE_PICKER_H
+
+#include <array>
+#include "Board.h"
+
+class MovePicker {
+public:
+	// The hash move, if any, is tried first. It can be any move, e.g. one
+	// remembered from another position; it's skipped unless it's legal here.
+	MovePicker(const Board&, color active_color, std::optional<LegalMove> hash_move = std::nullopt);
+
+	// Return the next legal move, or nothing once every move has been handed
+	// out. The board must not change while moves are being picked.
+	std::optional<LegalMove> next();
+
+	// Return true once the picker has moved on to captures that lose
+	// material (see see.h), which are handed out last.
+	bool is_picking_losing_captures() const { return current_stage == stage::losing_captures; }
+
+private:
+	// The stages, in the order that their moves are handed out. Captures are
+	// generated all at once (after the hash move, which might be enough) so
+	// that the best ones can be picked first; quiet moves are generated one
+	// piece at a time.
+	enum class stage : unsigned char {
+		hash_move,
+		generate_captures,
+		winning_captures,
+		promotions,
+		quiets,
+		losing_captures,
+		done,
+	};
+
+	std::optional<LegalMove> pick_hash_move() const;
+	void generate_captures();
+	void generate_promotions();
+	bool generate_next_quiets();
+	int select_best_capture();
+	bool accept(const LegalMove&) const;
+
+	const Board* board;
+	color active_color;
+	std::optional<LegalMove> hash_move;
+	stage current_stage{ stage::hash_move };
+
+	// Captures come first in `moves`, followed by the current batch of
+	// promotions or quiet moves.
+	MoveList moves;
+	std::array<int, MoveList::capacity()> capture_scores{};
+	std::size_t capture_count{ 0 };
+	std::size_t next_capture{ 0 };
+	std::size_t next_batch_move{ 0 };
+
+	// The pieces whose quiet moves haven't been generated yet.
+	Board::Geometry::Set quiet_pieces;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <cmath> // For std::abs.
 #include <stdexcept> // For std::invalid_argument.
 #include "Board.h"
+#include "instrument.h"
 #include "safe_ctype.h"
 #include "throw_if_empty.h"
 
@@ -75,6 +76,14 @@ color get_opposing_color(color color) {
 	return color == color::white ? color::black : color::white;
 }
 
+piece_type get_base_type(piece_type type) {
+	if (type == piece_type::castleable_rook)
+		return piece_type::rook;
+	if (type == piece_type::castleable_king)
+		return piece_type::king;
+	return type;
+}
+
 void Piece::make_uncastleable() {
 	if (type == piece_type::castleable_rook)
 		type = piece_type::rook;
@@ -82,7 +91,7 @@ void Piece::make_uncastleable() {
 		type = piece_type::king;
 }
 
-static std::vector<MoveDetails> generate_hopping(Move move, const Board& board) {
+static MoveDetailsList generate_hopping(Move move, const Board& board) {
 	auto piece{ board.get_piece(move.to) };
 	// "Hopping" pieces cannot move onto another piece of the same color.
 	// Note that this includes the moving piece itself. If `move.from` equals
@@ -97,13 +106,12 @@ static std::vector<MoveDetails> generate_hopping(Move move, const Board& board)
 	return {};
 }
 
-static std::vector<MoveDetails> generate_sliding(Move move, const Board& board) {
-	const int rank_step{ std::clamp(move.to.rank - move.from.rank, -1, 1) };
-	const int file_step{ std::clamp(move.to.file - move.from.file, -1, 1) };
+static MoveDetailsList generate_sliding(Move move, const Board& board) {
+	const int rank_step{ std::clamp(move.to.get_rank() - move.from.get_rank(), -1, 1) };
+	const int file_step{ std::clamp(move.to.get_file() - move.from.get_file(), -1, 1) };
 	Square current{ move.from };
 	for (;;) {
-		current.rank += rank_step;
-		current.file += file_step;
+		current = current.get_offset(rank_step, file_step);
 		if (board.is_out_of_bounds(current))
 			return {};
 
@@ -125,9 +133,9 @@ static const std::array can_promote_to{
 
 // Take in a base move and return every possible combination of that
 // move and a legal promotion.
-static std::vector<MoveDetails> add_promotions(MoveDetails details, bool is_promotion) {
+static MoveDetailsList add_promotions(MoveDetails details, bool is_promotion) {
 	if (is_promotion) {
-		std::vector<MoveDetails> all_promotions;
+		MoveDetailsList all_promotions;
 		for (auto promote_to : can_promote_to) {
 			details.promote_to = promote_to;
 			all_promotions.push_back(details);
@@ -137,19 +145,19 @@ static std::vector<MoveDetails> add_promotions(MoveDetails details, bool is_prom
 	return { details };
 }
 
-static std::vector<MoveDetails> generate_pawn_move_details(Move move, const Board& board) {
+static MoveDetailsList generate_pawn_move_details(Move move, const Board& board) {
 	const int direction{ move.active_color == color::black ? -1 : 1 };
 	const int initial_rank{ move.active_color == color::black ? 6 : 1 };
-	const bool on_initial_rank{ move.from.rank == initial_rank };
+	const bool on_initial_rank{ move.from.get_rank() == initial_rank };
 	const int promotion_rank{ move.active_color == color::black ? 0 : 7 };
-	const bool is_promotion{ move.to.rank == promotion_rank };
+	const bool is_promotion{ move.to.get_rank() == promotion_rank };
 
-	const auto rank_change{ move.to.rank - move.from.rank };
-	const auto file_change{ move.to.file - move.from.file };
+	const auto rank_change{ move.to.get_rank() - move.from.get_rank() };
+	const auto file_change{ move.to.get_file() - move.from.get_file() };
 
 	// Handle two step advances.
 	if (on_initial_rank && rank_change == direction * 2 && file_change == 0) {
-		const Square passing_over{ move.from.rank + direction, move.from.file };
+		const Square passing_over{ move.from.get_offset(direction, 0) };
 		// Pawns cannot skip over another piece.
 		// They also can't capture pieces when not moving diagonally.
 		const bool is_legal{ !board.is_occupied(passing_over) && !board.is_occupied(move.to) };
@@ -182,43 +190,43 @@ static std::vector<MoveDetails> generate_pawn_move_details(Move move, const Boar
 
 	if (move.to == board.get_en_passant_target()) {
 		// En passant is a special capture.
-		Square captured_square{ move.from.rank, move.to.file };
+		Square captured_square{ move.from.get_rank(), move.to.get_file() };
 		return { MoveDetails{ captured_square } };
 	}
 
 	return {};
 }
 
-static std::vector<MoveDetails> generate_knight_move_details(Move move, const Board& board) {
-	const auto abs_rank_change{ std::abs(move.to.rank - move.from.rank) };
-	const auto abs_file_change{ std::abs(move.to.file - move.from.file) };
+static MoveDetailsList generate_knight_move_details(Move move, const Board& board) {
+	const auto abs_rank_change{ std::abs(move.to.get_rank() - move.from.get_rank()) };
+	const auto abs_file_change{ std::abs(move.to.get_file() - move.from.get_file()) };
 	const int distance{ abs_rank_change + abs_file_change };
 	if (distance == 3 && abs_rank_change != 0 && abs_file_change != 0)
 		return generate_hopping(move, board);
 	return {};
 }
 
-static std::vector<MoveDetails> generate_bishop_move_details(Move move, const Board& board) {
-	const auto rank_change{ move.to.rank - move.from.rank };
-	const auto file_change{ move.to.file - move.from.file };
+static MoveDetailsList generate_bishop_move_details(Move move, const Board& board) {
+	const auto rank_change{ move.to.get_rank() - move.from.get_rank() };
+	const auto file_change{ move.to.get_file() - move.from.get_file() };
 	// Bishops only move diagonally.
 	if (rank_change == file_change || rank_change == -file_change)
 		return generate_sliding(move, board);
 	return {};
 }
 
-static std::vector<MoveDetails> generate_rook_move_details(Move move, const Board& board) {
-	const auto rank_change{ move.to.rank - move.from.rank };
-	const auto file_change{ move.to.file - move.from.file };
+static MoveDetailsList generate_rook_move_details(Move move, const Board& board) {
+	const auto rank_change{ move.to.get_rank() - move.from.get_rank() };
+	const auto file_change{ move.to.get_file() - move.from.get_file() };
 	// Rooks only move horizontally or vertically.
 	if (rank_change == 0 || file_change == 0)
 		return generate_sliding(move, board);
 	return {};
 }
 
-static std::vector<MoveDetails> generate_queen_move_details(Move move, const Board& board) {
-	const auto rank_change{ move.to.rank - move.from.rank };
-	const auto file_change{ move.to.file - move.from.file };
+static MoveDetailsList generate_queen_move_details(Move move, const Board& board) {
+	const auto rank_change{ move.to.get_rank() - move.from.get_rank() };
+	const auto file_change{ move.to.get_file() - move.from.get_file() };
 	// Queens can move in all eight directions.
 	if (rank_change == file_change || rank_change == -file_change)
 		return generate_sliding(move, board);
@@ -227,11 +235,6 @@ static std::vector<MoveDetails> generate_queen_move_details(Move move, const Boa
 	return {};
 }
 
-template <typename T>
-static void append(std::vector<T>& dest, const std::vector<T>& source) {
-	dest.insert(dest.end(), source.begin(), source.end());
-}
-
 static Square get_castling_king_final(color color, side side) {
 	const char file{ side == side::a_side ? 'c' : 'g' };
 	const char rank{ color == color::black ? '8' : '1' };
@@ -245,7 +248,8 @@ static Square get_castling_rook_final(color color, side side) {
 }
 
 static std::optional<Square> find_castling_rook(Move move, int step, const Board& board) {
-	for (Square current{ move.from }; board.is_in_bounds(current); current.file += step) {
+	for (Square current{ move.from }; board.is_in_bounds(current);
+		current = current.get_offset(0, step)) {
 		const auto piece{ board.get_piece(current) };
 		if (!piece.has_value())
 			continue;
@@ -258,9 +262,9 @@ static std::optional<Square> find_castling_rook(Move move, int step, const Board
 
 // Is any square between `from` and `to` (not including `from` or `ignore`) occupied by a piece?
 static bool any_squares_are_occupied(Square from, Square to, Square ignore, const Board& board) {
-	const int file_direction{ to.file < from.file ? -1 : 1 };
-	for (int step{ 1 }; step <= std::abs(to.file - from.file); step++) {
-		const Square current{ from.rank, from.file + file_direction * step };
+	const int file_direction{ to.get_file() < from.get_file() ? -1 : 1 };
+	for (int step{ 1 }; step <= std::abs(to.get_file() - from.get_file()); step++) {
+		const Square current{ from.get_rank(), from.get_file() + file_direction * step };
 		if (current == ignore)
 			continue;
 
@@ -271,43 +275,83 @@ static bool any_squares_are_occupied(Square from, Square to, Square ignore, cons
 }
 
 // Is any square between `move.from` and `move.to` under attack by one of
-// the opponent's pieces?
+// the opponent's pieces? The king is left out of the attack map so that it
+// can't hide from a slider behind itself.
 static bool any_squares_are_under_attack(Move move, const Board& board) {
-	const int file_direction{ move.to.file < move.from.file ? -1 : 1 };
-	for (int step{ 0 }; step <= std::abs(move.to.file - move.from.file); step++) {
-		const Square current{ move.from.rank, move.from.file + file_direction * step };
-		if (board.piece_would_be_attacked(move.from, current))
+	const auto attacked{
+		board.get_attacked_squares(get_opposing_color(move.active_color), move.from)
+	};
+	const int file_direction{ move.to.get_file() < move.from.get_file() ? -1 : 1 };
+	for (int step{ 0 }; step <= std::abs(move.to.get_file() - move.from.get_file()); step++) {
+		const Square current{ move.from.get_rank(), move.from.get_file() + file_direction * step };
+		if (attacked.contains(current))
 			return true;
 	}
 	return false;
 }
 
-static std::vector<MoveDetails> generate_castling(Move move, side side, const Board& board) {
+// In classical chess, the rooks start in the corners and the king on the
+// e-file, so everything about castling is known in advance.
+struct ClassicalCastling {
+	static std::optional<Square> find_rook(Move move, side side, const Board& board) {
+		const Square rook{ move.from.get_rank(), side == side::a_side ? 0 : 7 };
+		const auto piece{ board.get_piece(rook) };
+		if (!piece || piece->type != piece_type::castleable_rook)
+			return std::nullopt;
+		if (piece->color != move.active_color)
+			return std::nullopt;
+		return rook;
+	}
+
+	// The king and rook cross the b-, c-, and d-files or the f- and g-files.
+	static bool path_is_clear(Move move, side side, Square, const Board& board) {
+		const int rank{ move.from.get_rank() };
+		if (side == side::a_side) {
+			return !board.is_occupied({ rank, 1 }) && !board.is_occupied({ rank, 2 })
+				&& !board.is_occupied({ rank, 3 });
+		}
+		return !board.is_occupied({ rank, 5 }) && !board.is_occupied({ rank, 6 });
+	}
+};
+
+// In Chess960, the king and rooks can start anywhere on the home rank (with
+// the king between the rooks), so both have to be searched for.
+struct Chess960Castling {
+	static std::optional<Square> find_rook(Move move, side side, const Board& board) {
+		return find_castling_rook(move, side == side::a_side ? -1 : 1, board);
+	}
+
+	static bool path_is_clear(Move move, side side, Square rook, const Board& board) {
+		const auto rook_final{ get_castling_rook_final(move.active_color, side) };
+		// All the squares that the king crosses over must be empty (ignoring the rook).
+		if (any_squares_are_occupied(move.from, move.to, rook, board))
+			return false;
+		// All the squares that the rook crosses over must be empty (ignoring the king).
+		return !any_squares_are_occupied(rook, rook_final, move.from, board);
+	}
+};
+
+template <typename Variant>
+static MoveDetailsList generate_castling(Move move, const Board& board) {
 	// The king doesn't move between ranks when castling.
 	const color color{ move.active_color };
-	if (move.from.rank != move.to.rank)
+	if (move.from.get_rank() != move.to.get_rank())
 		return {};
 
-	// When castling, the king always goes to the same square.
-	// This is true in classical chess and in variants such as Chess960.
+	// When castling, the king always goes to the same square, which tells us
+	// which side it's castling on. This is true in classical chess and in
+	// variants such as Chess960.
+	const side side{ move.to.get_file() < 4 ? side::a_side : side::h_side };
 	if (move.to != get_castling_king_final(color, side))
 		return {};
 
 	// Find the castling rook.
-	const int search_direction{ side == side::a_side ? -1 : 1 };
-	const auto maybe_rook{ find_castling_rook(move, search_direction, board) };
+	const auto maybe_rook{ Variant::find_rook(move, side, board) };
 	if (!maybe_rook.has_value())
 		return {};
 
 	const Square rook{ maybe_rook.value() };
-	const auto rook_final{ get_castling_rook_final(color, side) };
-
-	// All the squares that the king crosses over must be empty (ignoring the rook).
-	if (any_squares_are_occupied(move.from, move.to, rook, board))
-		return {};
-
-	// All the squares that the rook crosses over must be empty (ignoring the king).
-	if (any_squares_are_occupied(rook, rook_final, move.from, board))
+	if (!Variant::path_is_clear(move, side, rook, board))
 		return {};
 
 	// None of the squares that the king crosses over can be under attack.
@@ -315,30 +359,32 @@ static std::vector<MoveDetails> generate_castling(Move move, side side, const Bo
 		return {};
 
 	MoveDetails details;
-	details.castling = CastlingDetails{ rook, rook_final, side };
+	details.castling = CastlingDetails{ rook, get_castling_rook_final(color, side), side };
 	return { details };
 }
 
-static std::vector<MoveDetails> generate_king_move_details(Move move, const Board& board) {
-	std::vector<MoveDetails> details;
+static MoveDetailsList generate_king_move_details(Move move, const Board& board) {
+	MoveDetailsList details;
 
 	// The king can only move to one of the eight adjacent squares.
-	const auto abs_rank_change{ std::abs(move.to.rank - move.from.rank) };
-	const auto abs_file_change{ std::abs(move.to.file - move.from.file) };
+	const auto abs_rank_change{ std::abs(move.to.get_rank() - move.from.get_rank()) };
+	const auto abs_file_change{ std::abs(move.to.get_file() - move.from.get_file()) };
 	if (abs_rank_change <= 1 && abs_file_change <= 1)
-		append(details, generate_hopping(move, board));
+		details.append(generate_hopping(move, board));
 
 	const Piece king{ throw_if_empty(board.get_piece(move.from)) };
 	if (king.type == piece_type::castleable_king) {
-		// Make sure to account for both types of castling!
-		append(details, generate_castling(move, side::a_side, board));
-		append(details, generate_castling(move, side::h_side, board));
+		if (board.get_variant() == variant::classical)
+			details.append(generate_castling<ClassicalCastling>(move, board));
+		else
+			details.append(generate_castling<Chess960Castling>(move, board));
 	}
 
 	return details;
 }
 
-std::vector<MoveDetails> generate_move_details(Move move, const Board& board) {
+MoveDetailsList generate_move_details(Move move, const Board& board) {
+	CHESS_COUNT(generate_move_details);
 	if (board.is_out_of_bounds(move.from) || board.is_out_of_bounds(move.to))
 		return {};
 
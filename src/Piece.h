@@ -7,6 +7,7 @@
 
 #include <optional>
 #include <vector>
+#include "FixedVector.h"
 #include "Square.h"
 
 // NOTE: Directly insert a forward reference to `Board` instead of including
@@ -64,6 +65,9 @@ std::optional<piece_type> convert_letter_to_piece_type(char);
 std::string get_piece_name(piece_type);
 color get_opposing_color(color color);
 
+// Castleable pieces are just kings and rooks that haven't moved yet.
+piece_type get_base_type(piece_type);
+
 struct Piece {
 	bool is_black() const { return color == color::black; }
 	bool is_white() const { return color == color::white; }
@@ -77,6 +81,10 @@ struct Piece {
 	enum color color;
 };
 
-std::vector<MoveDetails> generate_move_details(Move, const Board&);
+// A single pair of squares has at most four pseudo-legal moves: one for each
+// promotion, or an ordinary king move and castling on either side.
+using MoveDetailsList = FixedVector<MoveDetails, 4>;
+
+MoveDetailsList generate_move_details(Move, const Board&);
 
 #endif
@@ -0,0 +1,56 @@
+// Author: Daniel Kareh
+// Summary: A class that analyzes a position on a thread of its own while the
+//          player thinks, so that the processor isn't idle. Its transposition
+//          table lasts from one turn to the next, so each analysis starts
+//          with what the earlier ones learned.
+
+#include "Ponderer.h"
+#include "zobrist.h"
+
+// Deep enough that the player always stops the analysis first.
+static const int ponder_depth{ 64 };
+
+Ponderer::Ponderer(std::size_t table_megabytes)
+	: table{ table_megabytes } {}
+
+Ponderer::~Ponderer() { stop(); }
+
+void Ponderer::start(const Board& board, color active_color) {
+	stop();
+
+	// The search is created here, not on the thread, so that `stop` always
+	// has a search to stop.
+	search = std::make_unique<Search>(SearchLimits{ ponder_depth }, &table);
+	thread = std::thread{ [this, board, active_color] {
+		result = search->run(board, active_color);
+	} };
+}
+
+void Ponderer::stop() {
+	if (!thread.joinable())
+		return;
+	search->stop();
+	thread.join();
+}
+
+std::optional<MoveScore> Ponderer::get_move_score(
+	const Board& board, const LegalMove& legal_move) const {
+	Board child{ board };
+	child.play(legal_move);
+	const color opponent{ get_opposing_color(legal_move.move.active_color) };
+	const auto* entry{ table.probe(zobrist_hash(child, opponent)) };
+	if (!entry)
+		return std::nullopt;
+
+	// The entry is from the opponent's point of view, so the bounds swap.
+	MoveScore move_score{ -entry->score, entry->depth + 1, entry->bound };
+	if (entry->bound == score_bound::lower)
+		move_score.bound = score_bound::upper;
+	else if (entry->bound == score_bound::upper)
+		move_score.bound = score_bound::lower;
+
+	// A mate score counts plies from the child, which is one ply further.
+	if (is_mate_score(move_score.score))
+		move_score.score += move_score.score > 0 ? -1 : 1;
+	return move_score;
+}
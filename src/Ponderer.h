@@ -0,0 +1,58 @@
+// Author: Daniel Kareh
+// Summary: A class that analyzes a position on a thread of its own while the
+//          player thinks, so that the processor isn't idle. Its transposition
+//          table lasts from one turn to the next, so each analysis starts
+//          with what the earlier ones learned.
+
+#ifndef CHESS_PONDERER_H
+#define CHESS_PONDERER_H
+
+#include <memory>
+#include <thread>
+#include "Search.h"
+
+// What the analysis thinks of a move, from the mover's point of view.
+struct MoveScore {
+	int score{ 0 };
+	int depth{ 0 };
+	// Most moves are only shown to be worse than the best one, so their
+	// scores are upper bounds.
+	score_bound bound{ score_bound::exact };
+};
+
+class Ponderer {
+public:
+	explicit Ponderer(std::size_t table_megabytes = 64);
+	~Ponderer();
+
+	Ponderer(const Ponderer&) = delete;
+	Ponderer& operator=(const Ponderer&) = delete;
+	Ponderer(Ponderer&&) = delete;
+	Ponderer& operator=(Ponderer&&) = delete;
+
+	// Start analyzing a position in the background, deeper and deeper until
+	// `stop` is called. An analysis that's already running is stopped first.
+	void start(const Board&, color active_color);
+
+	// Stop the analysis and wait for its thread to finish. This is quick: the
+	// search checks whether it should stop at every node.
+	void stop();
+
+	// The rest may only be called while the analysis is stopped.
+
+	// The deepest finished search of the last analysis, including its best
+	// line. Empty if no analysis has run.
+	const SearchResult& get_result() const { return result; }
+
+	// Look up a move from any position in the table without searching. Moves
+	// from the analyzed position were almost all searched.
+	std::optional<MoveScore> get_move_score(const Board&, const LegalMove&) const;
+
+private:
+	TranspositionTable table;
+	std::unique_ptr<Search> search;
+	std::thread thread;
+	SearchResult result;
+};
+
+#endif
@@ -0,0 +1,90 @@
+// Author: Daniel Kareh
+// Summary: A class that keeps track of a game between two computer players
+//          and decides when (and how) the game is over, including draws by
+//          repetition, the fifty-move rule, and insufficient material.
+
+#include "Referee.h"
+#include <algorithm> // For std::count.
+#include "zobrist.h"
+
+const char* get_termination_name(termination termination) {
+	switch (termination) {
+	case termination::checkmate:
+		return "checkmate";
+	case termination::stalemate:
+		return "stalemate";
+	case termination::repetition:
+		return "threefold repetition";
+	case termination::fifty_moves:
+		return "fifty-move rule";
+	case termination::insufficient_material:
+		return "insufficient material";
+	case termination::move_limit:
+		return "move limit";
+	default:
+		return "unknown";
+	}
+}
+
+Referee::Referee(Board board, color active_color, int max_plies)
+	: board{ board }
+	, active_color{ active_color }
+	, max_plies{ max_plies }
+	, history{ zobrist_hash(board, active_color) } {}
+
+void Referee::play(const LegalMove& legal_move) {
+	const auto piece{ board.get_piece(legal_move.move.from) };
+	const bool is_pawn_move{ piece && piece->type == piece_type::pawn };
+	const bool is_irreversible{ is_pawn_move || legal_move.details.captured_square };
+
+	board.play(legal_move);
+	active_color = get_opposing_color(active_color);
+	ply++;
+
+	// Positions from before an irreversible move can never happen again.
+	halfmove_clock = is_irreversible ? 0 : halfmove_clock + 1;
+	if (is_irreversible)
+		history.clear();
+	history.push_back(zobrist_hash(board, active_color));
+}
+
+std::optional<GameOutcome> Referee::adjudicate(const std::vector<LegalMove>& legal_moves) const {
+	if (legal_moves.empty()) {
+		if (!board.piece_is_under_attack(board.find_king(active_color)))
+			return GameOutcome{ game_result::draw, termination::stalemate };
+
+		const auto winner{ active_color == color::white ? game_result::black_wins
+														: game_result::white_wins };
+		return GameOutcome{ winner, termination::checkmate };
+	}
+
+	if (is_repeated_three_times())
+		return GameOutcome{ game_result::draw, termination::repetition };
+	if (halfmove_clock >= 100)
+		return GameOutcome{ game_result::draw, termination::fifty_moves };
+	if (has_insufficient_material())
+		return GameOutcome{ game_result::draw, termination::insufficient_material };
+	if (ply >= max_plies)
+		return GameOutcome{ game_result::draw, termination::move_limit };
+	return std::nullopt;
+}
+
+bool Referee::is_repeated_three_times() const {
+	return std::count(history.begin(), history.end(), history.back()) >= 3;
+}
+
+// Neither player can possibly checkmate with only a king and at most one
+// bishop or knight on the board.
+bool Referee::has_insufficient_material() const {
+	int minor_pieces{ 0 };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece || piece->is_king())
+			continue;
+
+		if (piece->type != piece_type::bishop && piece->type != piece_type::knight)
+			return false;
+		minor_pieces++;
+	}
+	return minor_pieces <= 1;
+}
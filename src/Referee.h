@@ -0,0 +1,64 @@
+// Author: Daniel Kareh
+// Summary: A class that keeps track of a game between two computer players
+//          and decides when (and how) the game is over, including draws by
+//          repetition, the fifty-move rule, and insufficient material.
+
+#ifndef CHESS_REFEREE_H
+#define CHESS_REFEREE_H
+
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+
+enum class game_result : unsigned char {
+	white_wins,
+	black_wins,
+	draw,
+};
+
+enum class termination : unsigned char {
+	checkmate,
+	stalemate,
+	repetition,
+	fifty_moves,
+	insufficient_material,
+	move_limit,
+};
+
+struct GameOutcome {
+	game_result result;
+	enum termination termination;
+};
+
+const char* get_termination_name(termination);
+
+class Referee {
+public:
+	// Games that reach `max_plies` plies are adjudicated as draws.
+	Referee(Board, color active_color, int max_plies);
+
+	const Board& get_board() const { return board; }
+	color get_active_color() const { return active_color; }
+	int get_ply() const { return ply; }
+	int get_halfmove_clock() const { return halfmove_clock; }
+
+	void play(const LegalMove&);
+
+	// Decide whether the game is over. `legal_moves` must be every legal move
+	// in the current position.
+	std::optional<GameOutcome> adjudicate(const std::vector<LegalMove>& legal_moves) const;
+
+private:
+	bool is_repeated_three_times() const;
+	bool has_insufficient_material() const;
+
+	Board board;
+	color active_color;
+	int max_plies;
+	int ply{ 0 };
+	int halfmove_clock{ 0 };
+	// The hash of every position since the last capture or pawn move.
+	std::vector<std::uint64_t> history;
+};
+
+#endif
@@ -0,0 +1,256 @@
+// Author: Daniel Kareh
+// Summary: A small alpha-beta search that lets the computer choose moves.
+//          It's not strong, but it's good enough to play complete games.
+
+#include "Search.h"
+#include <algorithm>
+#include <cmath> // For std::abs.
+#include "Arena.h"
+#include "MovePicker.h"
+#include "zobrist.h"
+
+static const int infinity{ mate_score + 1 };
+
+int get_piece_value(piece_type type) {
+	switch (get_base_type(type)) {
+	case piece_type::pawn:
+		return 100;
+	case piece_type::knight:
+		return 320;
+	case piece_type::bishop:
+		return 330;
+	case piece_type::rook:
+		return 500;
+	case piece_type::queen:
+		return 900;
+	default:
+		return 0;
+	}
+}
+
+// Most pieces are stronger near the center, and pawns get stronger as they
+// get closer to promoting.
+static int get_placement_bonus(Piece piece, Square square) {
+	const int center_distance{
+		std::max(std::abs(2 * square.get_file() - 7), std::abs(2 * square.get_rank() - 7)) / 2
+	};
+	switch (get_base_type(piece.type)) {
+	case piece_type::pawn: {
+		const int advancement{ piece.is_white() ? square.get_rank() - 1 : 6 - square.get_rank() };
+		return advancement * 8 + (3 - center_distance) * 2;
+	}
+	case piece_type::knight:
+	case piece_type::bishop:
+		return (3 - center_distance) * 10;
+	case piece_type::queen:
+		return (3 - center_distance) * 4;
+	default:
+		return 0;
+	}
+}
+
+int evaluate(const Board& board, color active_color) {
+	int score{ 0 };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+
+		const int value{ get_piece_value(piece->type) + get_placement_bonus(*piece, square) };
+		score += piece->color == active_color ? value : -value;
+	}
+	return score;
+}
+
+static bool is_in_check(const Board& board, color color) {
+	return board.piece_is_under_attack(board.find_king(color));
+}
+
+// Mate scores are stored relative to the position they belong to, since the
+// same position can be reached at different plies.
+static int get_score_for_table(int score, int ply) {
+	if (score > mate_score - max_mate_plies)
+		return score + ply;
+	if (score < -mate_score + max_mate_plies)
+		return score - ply;
+	return score;
+}
+
+static int get_score_from_table(int score, int ply) {
+	if (score > mate_score - max_mate_plies)
+		return score - ply;
+	if (score < -mate_score + max_mate_plies)
+		return score + ply;
+	return score;
+}
+
+SearchResult Search::run(const Board& board, color active_color) {
+	nodes = 0;
+	std::optional<LegalMove> hash_move;
+	const std::uint64_t key{ table ? zobrist_hash(board, active_color) : 0 };
+	if (table) {
+		table->start_new_search();
+		if (const auto* entry{ table->probe(key) })
+			hash_move = entry->best_move;
+	}
+
+	// The root moves are kept in the picker's order (starting with the best
+	// move from the table), with the best move of each iteration moved to
+	// the front for the next one.
+	SearchResult result;
+	std::vector<LegalMove> moves;
+	MovePicker picker{ board, active_color, hash_move };
+	while (const auto legal_move{ picker.next() })
+		moves.push_back(*legal_move);
+	if (moves.empty()) {
+		result.score = is_in_check(board, active_color) ? -mate_score : 0;
+		return result;
+	}
+
+	const color opponent{ get_opposing_color(active_color) };
+	for (int depth{ 1 }; depth <= std::max(limits.depth, 1); depth++) {
+		int alpha{ -infinity };
+		std::optional<std::size_t> best_index;
+		bool finished{ true };
+		for (std::size_t i{ 0 }; i < moves.size(); i++) {
+			Board child{ board };
+			child.play(moves[i]);
+			const int score{ -negamax(child, opponent, depth - 1, -infinity, -alpha, 1) };
+			if (should_stop()) {
+				finished = false;
+				break;
+			}
+
+			if (score > alpha) {
+				alpha = score;
+				best_index = i;
+			}
+		}
+
+		// Only trust an unfinished search if there's nothing better.
+		if (!finished && (depth > 1 || !best_index))
+			break;
+
+		result.best_move = moves[best_index.value_or(0)];
+		result.score = alpha;
+		result.depth = depth;
+
+		if (table)
+			table->store({ key, result.best_move, alpha, depth, score_bound::exact });
+
+		// Search the best move first next time.
+		std::rotate(moves.begin(), moves.begin() + static_cast<std::ptrdiff_t>(*best_index),
+			moves.begin() + static_cast<std::ptrdiff_t>(*best_index) + 1);
+
+		if (!finished || alpha > mate_score - max_mate_plies)
+			break;
+	}
+
+	if (!result.best_move)
+		result.best_move = moves.front();
+	result.nodes = nodes;
+	result.principal_variation = get_principal_variation(
+		board, active_color, *result.best_move, std::max(result.depth, 1));
+	return result;
+}
+
+int Search::negamax(
+	const Board& board, color active_color, int depth, int alpha, int beta, int ply) {
+	nodes++;
+	if (depth <= 0)
+		return evaluate(board, active_color);
+
+	// A position that was already searched deeply enough may be answered
+	// from the table. Otherwise, its best move is tried first.
+	const std::uint64_t key{ table ? zobrist_hash(board, active_color) : 0 };
+	std::optional<LegalMove> hash_move;
+	if (const auto* entry{ table ? table->probe(key) : nullptr }) {
+		hash_move = entry->best_move;
+		const int score{ get_score_from_table(entry->score, ply) };
+		if (entry->depth >= depth
+			&& (entry->bound == score_bound::exact
+				|| (entry->bound == score_bound::lower && score >= beta)
+				|| (entry->bound == score_bound::upper && score <= alpha)))
+			return score;
+	}
+
+	// Every ply's move picker goes in this thread's arena, one after the
+	// other, and is given back when the ply returns. Moves after a cutoff are
+	// never generated.
+	Arena& arena{ get_thread_arena() };
+	const ArenaScope scope{ arena };
+	auto& picker{ *arena.create<MovePicker>(board, active_color, hash_move) };
+	const color opponent{ get_opposing_color(active_color) };
+	const int original_alpha{ alpha };
+	int best{ -infinity };
+	std::optional<LegalMove> best_move;
+	bool has_moves{ false };
+	while (const auto legal_move{ picker.next() }) {
+		// At the frontier, the evaluation can't see the recapture, so a
+		// losing capture looks better than it is. Skip them (but only once a
+		// legal move has been found, so that mates are still detected).
+		if (depth == 1 && has_moves && picker.is_picking_losing_captures())
+			break;
+
+		has_moves = true;
+		if (should_stop())
+			return best;
+
+		Board child{ board };
+		child.play(*legal_move);
+		const int score{ -negamax(child, opponent, depth - 1, -beta, -alpha, ply + 1) };
+		if (score > best) {
+			best = score;
+			best_move = *legal_move;
+		}
+		alpha = std::max(alpha, score);
+		if (alpha >= beta)
+			break;
+	}
+
+	if (!has_moves) {
+		// Prefer faster mates by making mates that are further away score lower.
+		return is_in_check(board, active_color) ? -mate_score + ply : 0;
+	}
+
+	// A search that was stopped partway through hasn't learned anything
+	// reliable.
+	if (table && !should_stop()) {
+		const score_bound bound{ best <= original_alpha ? score_bound::upper
+				: best >= beta                          ? score_bound::lower
+														: score_bound::exact };
+		table->store({ key, best_move, get_score_for_table(best, ply), depth, bound });
+	}
+	return best;
+}
+
+// Follow the best moves stored in the table from the root. Entries can be
+// overwritten or belong to another position with the same hash, so each move
+// is checked before it's played.
+std::vector<LegalMove> Search::get_principal_variation(
+	const Board& board, color active_color, const LegalMove& best_move, int length) const {
+	std::vector<LegalMove> line{ best_move };
+	Board current{ board };
+	current.play(best_move);
+	color current_color{ get_opposing_color(active_color) };
+	while (table && line.size() < static_cast<std::size_t>(length)) {
+		const auto* entry{ table->probe(zobrist_hash(current, current_color)) };
+		if (!entry || !entry->best_move)
+			break;
+
+		const auto move{ MovePicker{ current, current_color, entry->best_move }.next() };
+		if (!move || !is_same_move(*move, *entry->best_move))
+			break;
+
+		line.push_back(*move);
+		current.play(*move);
+		current_color = get_opposing_color(current_color);
+	}
+	return line;
+}
+
+bool Search::should_stop() const {
+	if (stopped.load(std::memory_order_relaxed))
+		return true;
+	return limits.nodes != 0 && nodes >= limits.nodes;
+}
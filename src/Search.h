@@ -0,0 +1,74 @@
+// Author: Daniel Kareh
+// Summary: A small alpha-beta search that lets the computer choose moves.
+//          It's not strong, but it's good enough to play complete games.
+
+#ifndef CHESS_SEARCH_H
+#define CHESS_SEARCH_H
+
+#include <atomic>
+#include <cstdint>
+#include "Board.h"
+#include "TranspositionTable.h"
+
+// Scores are in centipawns from the point of view of the player to move.
+// A score near `mate_score` means that the player to move can force mate.
+const int mate_score{ 32000 };
+const int max_mate_plies{ 1000 };
+
+inline bool is_mate_score(int score) {
+	return score > mate_score - max_mate_plies || score < -mate_score + max_mate_plies;
+}
+
+// Material and piece placement, from the point of view of `active_color`.
+int evaluate(const Board&, color active_color);
+
+int get_piece_value(piece_type);
+
+struct SearchLimits {
+	int depth{ 2 };
+	// Stop after (roughly) this many nodes. Zero means no limit.
+	std::uint64_t nodes{ 0 };
+};
+
+struct SearchResult {
+	std::optional<LegalMove> best_move;
+	int score{ 0 };
+	int depth{ 0 };
+	std::uint64_t nodes{ 0 };
+	// The moves that both sides are expected to play, starting with the best
+	// move. Without a transposition table, only the best move is known.
+	std::vector<LegalMove> principal_variation;
+};
+
+class Search {
+public:
+	// A search can share a transposition table with later searches (but not
+	// with searches running at the same time), which then start with what
+	// this one learned.
+	explicit Search(SearchLimits limits, TranspositionTable* table = nullptr)
+		: limits{ limits }
+		, table{ table } {}
+
+	// Search deeper and deeper until a limit is reached. The result comes from
+	// the deepest search that finished (or from a partial search at depth one
+	// if nothing finished).
+	SearchResult run(const Board&, color active_color);
+
+	// Ask a running search to return as soon as possible. This is safe to
+	// call from another thread. A stopped search stays stopped, so stopping
+	// one that hasn't started yet works too.
+	void stop() { stopped.store(true, std::memory_order_relaxed); }
+
+private:
+	int negamax(const Board&, color active_color, int depth, int alpha, int beta, int ply);
+	std::vector<LegalMove> get_principal_variation(
+		const Board&, color active_color, const LegalMove& best_move, int length) const;
+	bool should_stop() const;
+
+	SearchLimits limits;
+	TranspositionTable* table;
+	std::uint64_t nodes{ 0 };
+	std::atomic<bool> stopped{ false };
+};
+
+#endif
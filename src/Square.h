@@ -6,56 +6,99 @@
 #define CHESS_SQUARE_H
 
 #include <cassert>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
 #include "safe_ctype.h"
 
-/// `rank` must be between 0 and 7.
+/// `rank` must be between 0 and 8. (Higher ranks need two digits.)
 inline char convert_rank_to_digit(int rank) {
-	assert(0 <= rank && rank < 8);
+	assert(0 <= rank && rank < 9);
 	return static_cast<char>(rank + '1');
 }
 
-/// `file` must be between 0 and 7.
+/// `file` must be between 0 and 25.
 inline char convert_file_to_letter(int file) {
-	assert(0 <= file && file < 8);
+	assert(0 <= file && file < 26);
 	return static_cast<char>(file + 'a');
 }
 
+// A square packs its rank into the high four bits of a byte and its file into
+// the low four bits, so stepping by whole ranks and files is a single add.
+// Every board leaves two spare ranks and files in those bits (BoardGeometry
+// checks this), so a step of up to two ranks or files off the board, as a
+// knight can make, lands on a square that's out of bounds instead of wrapping
+// around onto the board. (The board numbers its squares densely instead; see
+// `BoardGeometry::get_index`.)
 struct Square {
-	char get_rank_digit() const { return convert_rank_to_digit(rank); }
-	char get_file_letter() const { return convert_file_to_letter(file); }
-	std::string print() const { return std::string{ get_file_letter(), get_rank_digit() }; }
+	// The default square is out of bounds on every board.
+	constexpr Square() = default;
 
-	bool operator==(const Square& other) const { return rank == other.rank && file == other.file; }
-	bool operator!=(const Square& other) const { return rank != other.rank || file != other.file; }
+	// A rank or file outside 0 to 15 gives the default square.
+	constexpr Square(int rank, int file)
+		: index{ static_cast<unsigned>(rank) < 16 && static_cast<unsigned>(file) < 16
+				? static_cast<std::uint8_t>(rank << 4 | file)
+				: none } {}
+
+	constexpr int get_rank() const { return index >> 4; }
+	constexpr int get_file() const { return index & 0xF; }
+
+	// Step `ranks` ranks up and `files` files to the right. Steps of more
+	// than two ranks or files may wrap around onto the board.
+	constexpr Square get_offset(int ranks, int files) const {
+		Square square;
+		square.index = static_cast<std::uint8_t>(index + ranks * 16 + files);
+		return square;
+	}
+
+	char get_rank_digit() const { return convert_rank_to_digit(get_rank()); }
+	char get_file_letter() const { return convert_file_to_letter(get_file()); }
+
+	// Squares from the tenth rank up (on Grand chess boards) are named like 'j10'.
+	std::string print() const {
+		if (get_rank() < 9)
+			return std::string{ get_file_letter(), get_rank_digit() };
+		return get_file_letter() + std::to_string(get_rank() + 1);
+	}
+
+	constexpr bool operator==(const Square& other) const { return index == other.index; }
+	constexpr bool operator!=(const Square& other) const { return index != other.index; }
 
 	static Square from_chars(char file, char rank) {
 		return Square{ rank - '1', safe_to_lower(file) - 'a' };
 	}
 
-	/// Parse a square string in the form 'xN', such as 'd2'.
-	/// The string must be exactly two characters long.
-	static std::optional<Square> parse(std::string_view string) {
-		if (string.length() != 2)
+	/// Parse a square string in the form 'xN', such as 'd2', on a board with
+	/// the given number of files and ranks. See BoardGeometry.h.
+	static std::optional<Square> parse(std::string_view string, int files = 8, int ranks = 8) {
+		if (string.length() < 2 || 3 < string.length())
 			return {};
 
-		// The file must be a letter from 'A' to 'H'.
+		// The file must be a letter from 'A' to 'H' (on an 8x8 board).
 		const char file{ safe_to_lower(string[0]) };
-		if (file < 'a' || 'h' < file)
+		if (file < 'a' || 'a' + files <= file)
 			return {};
 
-		// The rank must be a number from 1 to 8.
-		const char rank{ string[1] };
-		if (rank < '1' || '8' < rank)
+		// The rank must be a number from 1 to 8 (on an 8x8 board), without
+		// leading zeros.
+		int rank{ 0 };
+		for (const char digit : string.substr(1)) {
+			if (digit < '0' || '9' < digit)
+				return {};
+			rank = rank * 10 + (digit - '0');
+		}
+		if (string[1] == '0' || ranks < rank)
 			return {};
 
-		return from_chars(file, rank);
+		return Square{ rank - 1, file - 'a' };
 	}
 
-	int rank{ -1 };
-	int file{ -1 };
+	static constexpr std::uint8_t none{ 0xFF };
+
+	std::uint8_t index{ none };
 };
 
+static_assert(sizeof(Square) == 1, "A square is one byte");
+
 #endif
@@ -0,0 +1,327 @@
+// Author: Daniel Kareh
+// Summary: Memory for large hash tables. It can be backed by huge pages, so
+//          that random lookups miss the TLB less often, and on machines with
+//          several NUMA nodes it can be spread evenly over the nodes, so that
+//          no single memory controller takes all of the traffic.
+
+#ifdef CHESS_ON_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define STRICT
+#endif
+
+#include "TableMemory.h"
+#include <charconv> // For std::from_chars.
+#include <cstdint>
+#include <cstdio> // For std::fopen, std::fread.
+#include <new> // For std::bad_alloc.
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility> // For std::exchange.
+
+#ifdef CHESS_ON_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static std::size_t round_up(std::size_t value, std::size_t multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+#ifdef __linux__
+// Files in /proc and /sys don't know their size in advance, so read them in
+// pieces until the end. A missing file reads as empty.
+static std::string read_file(const std::string& path) {
+	std::string text;
+	std::FILE* file{ std::fopen(path.c_str(), "r") };
+	if (file == nullptr)
+		return text;
+
+	char buffer[4096];
+	std::size_t count{ 0 };
+	while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+		text.append(buffer, count);
+	std::fclose(file);
+	return text;
+}
+
+// Split off the first line of `text`, leaving the rest.
+static std::string_view take_line(std::string_view& text) {
+	const std::size_t end{ text.find('\n') };
+	const std::string_view line{ text.substr(0, end) };
+	text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+	return line;
+}
+
+// Read a number after any leading spaces. Anything after it is ignored.
+static std::optional<std::uint64_t> parse_number(std::string_view text, int base = 10) {
+	const std::size_t start{ text.find_first_not_of(' ') };
+	if (start == std::string_view::npos)
+		return std::nullopt;
+
+	const char* end{ text.data() + text.size() };
+	std::uint64_t value{};
+	const auto result{ std::from_chars(text.data() + start, end, value, base) };
+	if (result.ec != std::errc{})
+		return std::nullopt;
+	return value;
+}
+
+// Read a list like '0-3,8-11' (the format of the kernel's CPU and node lists).
+static std::vector<int> parse_list(std::string_view text) {
+	std::vector<int> numbers;
+	text = take_line(text);
+	while (!text.empty()) {
+		const std::size_t comma{ text.find(',') };
+		const std::string_view range{ text.substr(0, comma) };
+		text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+
+		const std::size_t dash{ range.find('-') };
+		const auto first{ parse_number(range.substr(0, dash)) };
+		const auto last{ dash == std::string_view::npos ? first
+														: parse_number(range.substr(dash + 1)) };
+		if (!first || !last)
+			continue;
+		for (auto number{ *first }; number <= *last; number++)
+			numbers.push_back(static_cast<int>(number));
+	}
+	return numbers;
+}
+
+// The processors of each online node. Nodes without processors (memory
+// expanders, for example) are left out, since no thread can run there.
+static std::vector<std::vector<int>> get_numa_nodes() {
+	std::vector<std::vector<int>> nodes;
+	const std::string directory{ "/sys/devices/system/node/" };
+	for (const int node : parse_list(read_file(directory + "online"))) {
+		auto cpus{ parse_list(read_file(directory + "node" + std::to_string(node) + "/cpulist")) };
+		if (!cpus.empty())
+			nodes.push_back(std::move(cpus));
+	}
+	return nodes;
+}
+
+// Find a size in kilobytes, like 'Hugepagesize:       2048 kB', in a file.
+static std::size_t read_kilobytes(const std::string& path, std::string_view name) {
+	const std::string text{ read_file(path) };
+	std::string_view rest{ text };
+	while (!rest.empty()) {
+		const std::string_view line{ take_line(rest) };
+		if (line.substr(0, name.size()) == name) {
+			const auto kilobytes{ parse_number(line.substr(name.size())) };
+			return static_cast<std::size_t>(kilobytes.value_or(0) * 1024);
+		}
+	}
+	return 0;
+}
+
+static std::size_t get_reserved_page_size() {
+	const std::size_t size{ read_kilobytes("/proc/meminfo", "Hugepagesize:") };
+	return size != 0 ? size : 2 * 1024 * 1024;
+}
+
+static std::size_t get_transparent_page_size() {
+	const auto size{ parse_number(
+		read_file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size")) };
+	return size && *size != 0 ? static_cast<std::size_t>(*size) : 2 * 1024 * 1024;
+}
+
+// Failing to pin just means that the kernel places the slice wherever the
+// thread happens to run.
+static void run_on_cpus(const std::vector<int>& cpus) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (const int cpu : cpus) {
+		if (cpu < CPU_SETSIZE)
+			CPU_SET(cpu, &set);
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#endif
+
+#ifdef CHESS_ON_WINDOWS
+TableMemory::TableMemory(std::size_t bytes, TableMemoryOptions options)
+	: length{ bytes } {
+	// Large pages need the "Lock pages in memory" privilege, so asking for
+	// them usually fails.
+	const SIZE_T large_page_size{ GetLargePageMinimum() };
+	if (options.pages == page_size::reserved && large_page_size != 0) {
+		mapped_length = round_up(std::max<std::size_t>(bytes, 1), large_page_size);
+		address = VirtualAlloc(nullptr, mapped_length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+			PAGE_READWRITE);
+		pages = page_size::reserved;
+	}
+
+	if (address == nullptr) {
+		mapped_length = std::max<std::size_t>(bytes, 1);
+		address = VirtualAlloc(nullptr, mapped_length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		pages = page_size::standard;
+	}
+
+	if (address == nullptr)
+		throw std::bad_alloc{};
+}
+
+std::size_t TableMemory::get_huge_page_bytes() const {
+	return pages == page_size::reserved ? mapped_length : 0;
+}
+
+void TableMemory::release() {
+	if (address != nullptr)
+		VirtualFree(address, 0, MEM_RELEASE);
+}
+#else
+static void* map_anonymous(std::size_t length, int flags) {
+	void* mapped{ mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags,
+		-1, 0) };
+	return mapped == MAP_FAILED ? nullptr : mapped;
+}
+
+TableMemory::TableMemory(std::size_t bytes, TableMemoryOptions options)
+	: length{ bytes } {
+#ifdef MAP_HUGETLB
+	// This fails unless enough huge pages are reserved (see
+	// /proc/sys/vm/nr_hugepages).
+	if (options.pages == page_size::reserved) {
+		mapped_length = round_up(std::max<std::size_t>(bytes, 1), get_reserved_page_size());
+		address = map_anonymous(mapped_length, MAP_HUGETLB);
+		pages = page_size::reserved;
+	}
+#endif
+
+#ifdef MADV_HUGEPAGE
+	// Transparent huge pages are only used for aligned ranges, so map one
+	// extra huge page and trim the ends to line the memory up.
+	if (address == nullptr && options.pages != page_size::standard) {
+		const std::size_t huge_page_size{ get_transparent_page_size() };
+		const std::size_t rounded{ round_up(std::max<std::size_t>(bytes, 1), huge_page_size) };
+		if (auto* raw{ static_cast<char*>(map_anonymous(rounded + huge_page_size, 0)) }) {
+			const auto raw_start{ reinterpret_cast<std::uintptr_t>(raw) };
+			const std::size_t head{ round_up(raw_start, huge_page_size) - raw_start };
+			if (head != 0)
+				munmap(raw, head);
+			if (head != huge_page_size)
+				munmap(raw + head + rounded, huge_page_size - head);
+
+			address = raw + head;
+			mapped_length = rounded;
+			pages = madvise(address, rounded, MADV_HUGEPAGE) == 0 ? page_size::transparent
+																   : page_size::standard;
+		}
+	}
+#endif
+
+	if (address == nullptr) {
+		mapped_length = std::max<std::size_t>(bytes, 1);
+		address = map_anonymous(mapped_length, 0);
+		pages = page_size::standard;
+	}
+
+	if (address == nullptr)
+		throw std::bad_alloc{};
+
+#ifdef MADV_NOHUGEPAGE
+	// Kernels set to use transparent huge pages everywhere would otherwise
+	// ignore the request for ordinary pages.
+	if (options.pages == page_size::standard)
+		madvise(address, mapped_length, MADV_NOHUGEPAGE);
+#endif
+
+#ifdef __linux__
+	if (options.spread_over_nodes) {
+		node_cpus = get_numa_nodes();
+		if (node_cpus.size() < 2)
+			node_cpus.clear();
+	}
+#endif
+}
+
+std::size_t TableMemory::get_huge_page_bytes() const {
+	if (pages == page_size::reserved)
+		return mapped_length;
+
+	// Add up the huge pages of every mapping that overlaps this memory (the
+	// kernel may split it, or merge it with its neighbors).
+	std::size_t bytes{ 0 };
+#ifdef __linux__
+	const auto start{ reinterpret_cast<std::uintptr_t>(address) };
+	const std::uintptr_t end{ start + mapped_length };
+	const std::string smaps{ read_file("/proc/self/smaps") };
+	std::string_view rest{ smaps };
+	bool inside{ false };
+	while (!rest.empty()) {
+		const std::string_view line{ take_line(rest) };
+		const std::size_t dash{ line.find('-') };
+		const std::size_t space{ line.find(' ') };
+		if (dash != std::string_view::npos && space != std::string_view::npos && dash < space
+			&& line.find(':') > space) {
+			const auto first{ parse_number(line.substr(0, dash), 16) };
+			const auto last{ parse_number(line.substr(dash + 1, space - dash - 1), 16) };
+			inside = first && last && *first < end && start < *last;
+		} else if (inside && line.substr(0, 14) == "AnonHugePages:") {
+			bytes += static_cast<std::size_t>(parse_number(line.substr(14)).value_or(0) * 1024);
+		}
+	}
+#endif
+	return bytes;
+}
+
+void TableMemory::release() {
+	if (address != nullptr)
+		munmap(address, mapped_length);
+}
+#endif
+
+TableMemory::~TableMemory() { release(); }
+
+TableMemory::TableMemory(TableMemory&& other) noexcept
+	: address{ std::exchange(other.address, nullptr) }
+	, length{ std::exchange(other.length, 0) }
+	, mapped_length{ std::exchange(other.mapped_length, 0) }
+	, pages{ other.pages }
+	, node_cpus{ std::move(other.node_cpus) } {}
+
+TableMemory& TableMemory::operator=(TableMemory&& other) noexcept {
+	if (this != &other) {
+		release();
+		address = std::exchange(other.address, nullptr);
+		length = std::exchange(other.length, 0);
+		mapped_length = std::exchange(other.mapped_length, 0);
+		pages = other.pages;
+		node_cpus = std::move(other.node_cpus);
+	}
+	return *this;
+}
+
+void TableMemory::for_each_slice(std::size_t granularity,
+	const std::function<void(std::size_t begin, std::size_t end)>& visit) const {
+	if (node_cpus.empty()) {
+		visit(0, length);
+		return;
+	}
+
+#ifdef __linux__
+	const std::size_t units{ length / granularity };
+	const std::size_t slices{ node_cpus.size() };
+	std::vector<std::thread> threads;
+	for (std::size_t slice{ 0 }; slice < slices; slice++) {
+		const std::size_t begin{ units * slice / slices * granularity };
+		const std::size_t end{ slice + 1 == slices ? length
+												   : units * (slice + 1) / slices * granularity };
+		threads.emplace_back([this, &visit, slice, begin, end] {
+			run_on_cpus(node_cpus[slice]);
+			visit(begin, end);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+#endif
+}
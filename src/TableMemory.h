@@ -0,0 +1,84 @@
+// Author: Daniel Kareh
+// Summary: Memory for large hash tables. It can be backed by huge pages, so
+//          that random lookups miss the TLB less often, and on machines with
+//          several NUMA nodes it can be spread evenly over the nodes, so that
+//          no single memory controller takes all of the traffic.
+
+#ifndef CHESS_TABLE_MEMORY_H
+#define CHESS_TABLE_MEMORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+enum class page_size : unsigned char {
+	// Ordinary pages (usually 4 KiB).
+	standard,
+	// Ask the kernel for transparent huge pages with `madvise` (Linux only).
+	// It may still use ordinary pages, e.g. if memory is fragmented.
+	transparent,
+	// Take huge pages that the administrator reserved ahead of time
+	// (hugetlbfs on Linux, large pages on Windows).
+	reserved,
+};
+
+struct TableMemoryOptions {
+	// If the pages can't be had, the next smaller kind is tried.
+	page_size pages{ page_size::transparent };
+	// Split the memory into one slice per NUMA node, and touch each slice
+	// first from a thread running on its node, which makes the kernel place
+	// it there. This only matters on Linux machines with several nodes.
+	bool spread_over_nodes{ true };
+};
+
+class TableMemory {
+public:
+	// The memory starts out zero-filled. Throws `std::bad_alloc` if not even
+	// ordinary pages are available.
+	explicit TableMemory(std::size_t bytes, TableMemoryOptions = {});
+	~TableMemory();
+
+	TableMemory(const TableMemory&) = delete;
+	TableMemory& operator=(const TableMemory&) = delete;
+	TableMemory(TableMemory&&) noexcept;
+	TableMemory& operator=(TableMemory&&) noexcept;
+
+	void* data() const { return address; }
+	std::size_t size() const { return length; }
+
+	// The kind of pages that was asked for and given (after falling back).
+	// For transparent huge pages, the kernel has the final say; see
+	// `get_huge_page_bytes`.
+	page_size get_page_size() const { return pages; }
+
+	// How many bytes are backed by huge pages right now, as far as the
+	// operating system will tell (zero if it won't).
+	std::size_t get_huge_page_bytes() const;
+
+	// How many NUMA nodes the memory is spread over (one if it isn't).
+	int get_node_count() const { return std::max(static_cast<int>(node_cpus.size()), 1); }
+
+	// Call `visit(begin, end)` once for each slice of the memory, from a
+	// thread on the slice's node (or from this thread if the memory isn't
+	// spread). The byte offsets are multiples of `granularity`, so that no
+	// table entry is split between two slices. Tables use this to construct
+	// their entries, which is also what places the slices on their nodes.
+	void for_each_slice(std::size_t granularity,
+		const std::function<void(std::size_t begin, std::size_t end)>& visit) const;
+
+private:
+	void release();
+
+	void* address{ nullptr };
+	std::size_t length{ 0 };
+	// What was actually mapped, which may be larger than `length` (to round
+	// it up to whole huge pages).
+	std::size_t mapped_length{ 0 };
+	page_size pages{ page_size::standard };
+	// The processors of each node that the memory is spread over, or
+	// nothing if it isn't spread.
+	std::vector<std::vector<int>> node_cpus;
+};
+
+#endif
@@ -1,7 +1,19 @@
 #include "TerminalUserInterface.h"
 #include <cassert>
+#include <cstdlib> // For std::abs.
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <sstream>
+#include "Ponderer.h"
+#include "see.h"
+
+#ifdef CHESS_ON_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define STRICT
+#include <windows.h>
+#endif
 
 /// Parse a move string in the form 'xNxN', such as 'd2d4'.
 /// The string must be exactly four characters long.
@@ -53,6 +65,9 @@ static int read_move_index(int max_move) {
 	for (;;) {
 		std::string input;
 		if (!std::getline(std::cin, input)) {
+			// Nobody is left to choose.
+			if (std::cin.eof())
+				return -1;
 			std::cin.clear();
 			std::cout << "Please try again: _\b";
 			continue;
@@ -72,13 +87,15 @@ static int read_move_index(int max_move) {
 	}
 }
 
-Move TerminalUserInterface::read_move(color active_color) {
+std::optional<Move> TerminalUserInterface::read_move(color active_color) {
 	const auto* active_name{ active_color == color::black ? "Black" : "White" };
 	std::cout << active_name << ": ";
 	for (;;) {
 		std::cout << "Your move? ____\b\b\b\b";
 		std::string input;
 		if (!std::getline(std::cin >> std::ws, input)) {
+			if (std::cin.eof())
+				return std::nullopt;
 			std::cin.clear();
 			continue;
 		}
@@ -86,7 +103,7 @@ Move TerminalUserInterface::read_move(color active_color) {
 		input = remove_trailing_whitespace(input);
 		auto move{ parse_move(input, active_color) };
 		if (move.has_value())
-			return move.value();
+			return move;
 
 		std::cout << "Please try again.\n";
 	}
@@ -100,7 +117,42 @@ void TerminalUserInterface::notify(std::string_view message, notify_pause pause)
 	}
 }
 
-int TerminalUserInterface::choose_move(const std::vector<MoveDetails>& choices) {
+// Say whether a capture wins or loses material once every recapture on its
+// square is played out, like "wins 2.2 pawns".
+static std::string describe_exchange(const Board& board, const LegalMove& capture) {
+	const int exchange{ evaluate_exchange(board, capture) };
+	if (exchange == 0)
+		return "even trade";
+
+	std::ostringstream stream;
+	stream << (exchange > 0 ? "wins " : "loses ") << std::fixed << std::setprecision(1)
+		   << std::abs(exchange) / 100.0 << " pawns";
+	return stream.str();
+}
+
+// Describe an engine score in pawns, like "+0.35 at depth 4" or "at most
+// -1.20 at depth 3".
+static std::string describe_move_score(const MoveScore& move_score) {
+	std::ostringstream stream;
+	if (move_score.bound == score_bound::upper)
+		stream << "at most ";
+	else if (move_score.bound == score_bound::lower)
+		stream << "at least ";
+
+	const int score{ move_score.score };
+	if (is_mate_score(score)) {
+		const int moves{ (mate_score - std::abs(score) + 1) / 2 };
+		stream << (score > 0 ? "mate in " : "mated in ") << moves;
+	} else {
+		stream << std::showpos << std::fixed << std::setprecision(2) << score / 100.0
+			   << std::noshowpos;
+	}
+	stream << " at depth " << move_score.depth;
+	return stream.str();
+}
+
+int TerminalUserInterface::choose_move(
+	const Board& board, Move move, const std::vector<MoveDetails>& choices) {
 	if (choices.empty())
 		// No legal choice exists.
 		return -1;
@@ -117,7 +169,8 @@ int TerminalUserInterface::choose_move(const std::vector<MoveDetails>& choices)
 		std::cout << '\t' << (index + 1) << ". ";
 
 		if (choice.captured_square) {
-			std::cout << "Capture " << choice.captured_square->print() << ". ";
+			std::cout << "Capture " << choice.captured_square->print() << " ("
+					  << describe_exchange(board, { move, choice }) << "). ";
 		}
 
 		if (choice.promote_to) {
@@ -134,14 +187,65 @@ int TerminalUserInterface::choose_move(const std::vector<MoveDetails>& choices)
 		if (!choice.captured_square && !choice.promote_to && !choice.castling)
 			std::cout << "Standard. ";
 
+		if (const auto* ponderer{ get_ponderer() }) {
+			if (const auto move_score{ ponderer->get_move_score(board, { move, choice }) })
+				std::cout << "Engine: " << describe_move_score(*move_score) << ". ";
+		}
+
 		std::cout << '\n';
 	}
 
+	// A long list of choices may scroll the board out of place.
+	renderer.invalidate();
+
 	assert(choices.size() <= std::numeric_limits<int>::max());
 	return read_move_index(static_cast<int>(choices.size()));
 }
 
-void TerminalUserInterface::clear_screen() const {
-	for (int i{ 0 }; i < 200; i++)
-		std::cout << '\n';
+// The frame renderer uses ANSI escape sequences, which Windows consoles only
+// understand after being asked to.
+static void enable_escape_sequences() {
+#ifdef CHESS_ON_WINDOWS
+	static const bool enabled{ [] {
+		HANDLE output_handle{ GetStdHandle(STD_OUTPUT_HANDLE) };
+		DWORD console_mode;
+		if (GetConsoleMode(output_handle, &console_mode) == 0)
+			return false;
+		return SetConsoleMode(output_handle, console_mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING)
+			!= 0;
+	}() };
+	static_cast<void>(enabled);
+#endif
+}
+
+std::vector<std::string> TerminalUserInterface::describe_threats(const Board& board) {
+	static const std::string label{ "Under attack:" };
+	const auto attacked_by_black{ board.get_attacked_squares(color::black) };
+	const auto attacked_by_white{ board.get_attacked_squares(color::white) };
+	std::vector<std::string> lines;
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+
+		const auto& attacked{ piece->is_white() ? attacked_by_black : attacked_by_white };
+		if (!attacked.contains(square))
+			continue;
+
+		// Later lines are indented so that their squares line up with the
+		// squares on the first line.
+		const std::string name{ ' ' + square.print() };
+		if (lines.empty()
+			|| lines.back().size() + name.size() > static_cast<std::size_t>(threat_line_width))
+			lines.push_back(lines.empty() ? label : std::string(label.size(), ' '));
+		lines.back() += name;
+	}
+	return lines;
+}
+
+void TerminalUserInterface::present(const Frame& frame) {
+	enable_escape_sequences();
+	const auto output{ renderer.render(frame) };
+	std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+	std::cout.flush();
 }
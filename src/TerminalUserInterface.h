@@ -1,16 +1,30 @@
 #ifndef CHESS_TERMINAL_USER_INTERFACE_H
 #define CHESS_TERMINAL_USER_INTERFACE_H
 
+#include <string>
+#include <vector>
+#include "FrameRenderer.h"
 #include "UserInterface.h"
 
 class TerminalUserInterface : public UserInterface {
 public:
-	virtual Move read_move(color active_color) override;
+	virtual std::optional<Move> read_move(color active_color) override;
 	virtual void notify(std::string_view message, notify_pause) override;
-	virtual int choose_move(const std::vector<MoveDetails>&) override;
+	virtual int choose_move(const Board&, Move, const std::vector<MoveDetails>&) override;
 
 protected:
-	void clear_screen() const;
+	// Draw a frame over the previous one with a single write.
+	void present(const Frame&);
+
+	// Lines that name every piece that an opposing piece could capture, like
+	// "Under attack: e4 f7", or no lines if no piece is under attack. A long
+	// list wraps onto further lines of at most `threat_line_width` columns,
+	// and frames are at least that wide to make room.
+	static std::vector<std::string> describe_threats(const Board&);
+	static constexpr int threat_line_width{ 64 };
+
+private:
+	FrameRenderer renderer;
 };
 
 #endif
@@ -0,0 +1,60 @@
+// Author: Daniel Kareh
+// Summary: A hash table that remembers what a search learned about each
+//          position it visited (a score, how deep it looked, and the best
+//          move), so that positions reached again, in this search or a later
+//          one, don't have to be searched from scratch.
+
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <memory> // For std::uninitialized_fill.
+#include <type_traits>
+
+// Entries are constructed in place in the table's memory.
+static_assert(std::is_trivially_destructible_v<TranspositionEntry>, "Entries are never destroyed");
+
+// The number of entries is a power of two so that a slot is found by masking
+// the key.
+static std::size_t get_entry_count(std::size_t megabytes) {
+	const std::size_t wanted{
+		std::max<std::size_t>(megabytes * 1024 * 1024 / sizeof(TranspositionEntry), 1)
+	};
+	std::size_t count{ 1 };
+	while (count * 2 <= wanted)
+		count *= 2;
+	return count;
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes, TableMemoryOptions options)
+	: memory{ get_entry_count(megabytes) * sizeof(TranspositionEntry), options }
+	, entries{ static_cast<TranspositionEntry*>(memory.data()) }
+	, capacity{ get_entry_count(megabytes) } {
+	clear();
+}
+
+const TranspositionEntry* TranspositionTable::probe(std::uint64_t key) const {
+	const auto& entry{ entries[key & (capacity - 1)] };
+	return entry.key == key && key != 0 ? &entry : nullptr;
+}
+
+void TranspositionTable::store(TranspositionEntry new_entry) {
+	new_entry.generation = generation;
+	auto& entry{ entries[new_entry.key & (capacity - 1)] };
+	const bool is_current{ entry.generation == generation };
+	if (entry.key != new_entry.key && is_current && entry.depth > new_entry.depth)
+		return;
+
+	// Keep the old best move if the new search didn't find one.
+	const auto old_move{ entry.key == new_entry.key ? entry.best_move : std::nullopt };
+	entry = new_entry;
+	if (!entry.best_move)
+		entry.best_move = old_move;
+}
+
+// Each slice of the table is filled by a thread on the NUMA node that it
+// belongs to, which is what puts it there the first time.
+void TranspositionTable::clear() {
+	memory.for_each_slice(sizeof(TranspositionEntry), [this](std::size_t begin, std::size_t end) {
+		std::uninitialized_fill(entries + begin / sizeof(TranspositionEntry),
+			entries + end / sizeof(TranspositionEntry), TranspositionEntry{});
+	});
+}
@@ -0,0 +1,65 @@
+// Author: Daniel Kareh
+// Summary: A hash table that remembers what a search learned about each
+//          position it visited (a score, how deep it looked, and the best
+//          move), so that positions reached again, in this search or a later
+//          one, don't have to be searched from scratch.
+
+#ifndef CHESS_TRANSPOSITION_TABLE_H
+#define CHESS_TRANSPOSITION_TABLE_H
+
+#include <cstdint>
+#include "Board.h"
+#include "TableMemory.h"
+
+// Alpha-beta searches often only learn that a score is at least or at most
+// some value.
+enum class score_bound : unsigned char {
+	exact,
+	lower,
+	upper,
+};
+
+struct TranspositionEntry {
+	// The Zobrist hash of the position, including who moves next. Zero marks
+	// an empty entry.
+	std::uint64_t key{ 0 };
+	std::optional<LegalMove> best_move;
+	// From the point of view of the player to move. Mate scores count plies
+	// from this position, not from the root.
+	int score{ 0 };
+	int depth{ 0 };
+	score_bound bound{ score_bound::exact };
+	// Which search stored the entry (see `start_new_search`).
+	std::uint8_t generation{ 0 };
+};
+
+class TranspositionTable {
+public:
+	// The table never grows: a new entry replaces the old one in its slot
+	// unless the old one came from a deeper search of another position
+	// during the same search. Big tables benefit from huge pages and from
+	// being spread over NUMA nodes (see TableMemory.h).
+	explicit TranspositionTable(std::size_t megabytes = 16, TableMemoryOptions = {});
+
+	// Return the entry for a position, or nothing if it isn't stored.
+	const TranspositionEntry* probe(std::uint64_t key) const;
+
+	// Store an entry, stamped with the current generation.
+	void store(TranspositionEntry);
+	void clear();
+
+	// Entries from earlier searches stay useful, but they give way to new
+	// ones, so that the table doesn't fill up with old positions.
+	void start_new_search() { generation++; }
+
+	std::size_t get_capacity() const { return capacity; }
+	const TableMemory& get_memory() const { return memory; }
+
+private:
+	TableMemory memory;
+	TranspositionEntry* entries;
+	std::size_t capacity;
+	std::uint8_t generation{ 0 };
+};
+
+#endif
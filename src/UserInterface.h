@@ -7,6 +7,10 @@
 #include <string_view>
 #include "Board.h"
 
+// NOTE: Directly insert a forward reference to `Ponderer` instead of including
+// "Ponderer.h", which would bring threads into every user interface.
+class Ponderer;
+
 enum class notify_pause : unsigned char { no, yes };
 
 class UserInterface {
@@ -20,9 +24,25 @@ public:
 	UserInterface& operator=(UserInterface&&) = delete;
 
 	virtual void show(const Board&) = 0;
-	virtual Move read_move(color active_color) = 0;
+	// Return `std::nullopt` once there are no more moves to read (such as at
+	// the end of the input), which ends the game.
+	virtual std::optional<Move> read_move(color active_color) = 0;
 	virtual void notify(std::string_view message, notify_pause = notify_pause::no) = 0;
-	virtual int choose_move(const std::vector<MoveDetails>&) = 0;
+
+	// Ask which of several ways to make a move the player meant (such as
+	// which piece to promote to). The board is the position before the move.
+	virtual int choose_move(const Board&, Move, const std::vector<MoveDetails>&) = 0;
+
+	// Let the interface show what a background analysis thinks of each
+	// choice in `choose_move`. The analysis is stopped whenever the
+	// interface is asked to choose.
+	void set_ponderer(const Ponderer* new_ponderer) { ponderer = new_ponderer; }
+
+protected:
+	const Ponderer* get_ponderer() const { return ponderer; }
+
+private:
+	const Ponderer* ponderer{ nullptr };
 };
 
 #endif
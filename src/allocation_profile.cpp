@@ -0,0 +1,181 @@
+// Author: Daniel Kareh
+// Summary: An optional build mode that counts every heap allocation and
+//          attributes it to the code that made it. It only exists when
+//          `CHESS_ALLOCATION_PROFILE` is defined.
+
+#include "allocation_profile.h"
+
+#ifdef CHESS_ALLOCATION_PROFILE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib> // For std::malloc, std::free, std::abort, and std::atexit.
+#include <new>
+#include <vector>
+
+#if __has_include(<execinfo.h>) && __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <execinfo.h>
+#define CHESS_HAS_BACKTRACE
+#endif
+
+// Callers are told apart by this many return addresses.
+static const int frames_per_site{ 8 };
+
+struct Site {
+	std::atomic<std::uint64_t> key;
+	std::array<void*, frames_per_site> frames;
+	std::atomic<std::uint64_t> count;
+	std::atomic<std::uint64_t> bytes;
+};
+
+// A fixed-size hash table, since the profiler can't allocate memory while
+// recording an allocation. Once it's full, new call sites share one entry.
+static const std::size_t site_capacity{ 4096 };
+static std::array<Site, site_capacity> sites;
+static std::atomic<std::uint64_t> dropped_allocations{ 0 };
+
+static thread_local std::uint64_t thread_allocation_count{ 0 };
+static thread_local bool is_recording{ false };
+
+static std::uint64_t hash_frames(void* const* frames, int count) {
+	std::uint64_t hash{ 0xCBF29CE484222325 };
+	for (int i{ 0 }; i < count; i++) {
+		hash ^= reinterpret_cast<std::uintptr_t>(frames[i]);
+		hash *= 0x100000001B3;
+	}
+	// Zero marks an empty slot.
+	return hash == 0 ? 1 : hash;
+}
+
+static void record_allocation(std::size_t size) {
+	thread_allocation_count++;
+
+	// Finding the caller may allocate in some C libraries.
+	if (is_recording)
+		return;
+	is_recording = true;
+
+	// Skip this function and `operator new` itself.
+	std::array<void*, frames_per_site + 2> frames{};
+	int count{ 0 };
+#ifdef CHESS_HAS_BACKTRACE
+	count = std::max(backtrace(frames.data(), static_cast<int>(frames.size())) - 2, 0);
+#endif
+	void* const* const caller_frames{ frames.data() + 2 };
+	const std::uint64_t key{ hash_frames(caller_frames, count) };
+
+	for (std::size_t probe{ 0 }; probe < site_capacity; probe++) {
+		Site& site{ sites[(key + probe) % site_capacity] };
+		std::uint64_t expected{ 0 };
+		if (site.key.load(std::memory_order_acquire) != key
+			&& !site.key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+			if (expected != key)
+				continue;
+		}
+
+		if (site.count.fetch_add(1, std::memory_order_relaxed) == 0)
+			std::copy(caller_frames, caller_frames + count, site.frames.begin());
+		site.bytes.fetch_add(size, std::memory_order_relaxed);
+		is_recording = false;
+		return;
+	}
+
+	dropped_allocations.fetch_add(1, std::memory_order_relaxed);
+	is_recording = false;
+}
+
+void* operator new(std::size_t size) {
+	record_allocation(size);
+	if (void* pointer{ std::malloc(size == 0 ? 1 : size) })
+		return pointer;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+std::uint64_t get_thread_allocation_count() { return thread_allocation_count; }
+
+#ifdef CHESS_HAS_BACKTRACE
+// Symbols look like 'program(_ZN5Board4moveE...+0x2a) [0x55d0c]'.
+static std::string describe_frame(const char* symbol) {
+	const std::string text{ symbol };
+	const auto open{ text.find('(') };
+	const auto plus{ text.find('+', open) };
+	if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+		return text;
+
+	const std::string mangled{ text.substr(open + 1, plus - open - 1) };
+	int status{ 0 };
+	char* demangled{ abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status) };
+	if (status != 0 || !demangled)
+		return text;
+
+	std::string name{ demangled };
+	std::free(demangled);
+	return name;
+}
+#endif
+
+std::string get_allocation_report(std::size_t max_sites) {
+	const bool was_recording{ is_recording };
+	is_recording = true;
+
+	std::vector<const Site*> busiest;
+	std::uint64_t total{ 0 };
+	for (const auto& site : sites) {
+		if (site.count.load(std::memory_order_relaxed) == 0)
+			continue;
+		busiest.push_back(&site);
+		total += site.count.load(std::memory_order_relaxed);
+	}
+	std::sort(busiest.begin(), busiest.end(), [](const Site* a, const Site* b) {
+		return a->count.load(std::memory_order_relaxed) > b->count.load(std::memory_order_relaxed);
+	});
+	busiest.resize(std::min(busiest.size(), max_sites));
+
+	std::string report{ "Allocation report\n  Allocations: " + std::to_string(total) + " from "
+		+ std::to_string(busiest.size()) + " busiest call sites shown below\n" };
+	const auto dropped{ dropped_allocations.load(std::memory_order_relaxed) };
+	if (dropped != 0)
+		report += "  Not attributed (too many call sites): " + std::to_string(dropped) + '\n';
+
+	for (const Site* site : busiest) {
+		report += "  " + std::to_string(site->count.load(std::memory_order_relaxed))
+			+ " allocations, " + std::to_string(site->bytes.load(std::memory_order_relaxed))
+			+ " bytes\n";
+#ifdef CHESS_HAS_BACKTRACE
+		int frame_count{ 0 };
+		while (frame_count < frames_per_site && site->frames[frame_count])
+			frame_count++;
+		char** symbols{ backtrace_symbols(site->frames.data(), frame_count) };
+		for (int i{ 0 }; symbols && i < frame_count; i++)
+			report += "      " + describe_frame(symbols[i]) + '\n';
+		std::free(symbols);
+#endif
+	}
+
+	is_recording = was_recording;
+	return report;
+}
+
+NoAllocationScope::~NoAllocationScope() {
+	const auto allocations{ get_thread_allocation_count() - start };
+	if (allocations == 0)
+		return;
+
+	std::fprintf(stderr, "%s allocated memory %llu times, but it must never allocate.\n", name,
+		static_cast<unsigned long long>(allocations));
+	std::fputs(get_allocation_report().c_str(), stderr);
+	std::abort();
+}
+
+static void print_report_at_exit() { std::fputs(get_allocation_report().c_str(), stderr); }
+
+// Register the exit report before `main` runs.
+static const bool registered_exit_report{ std::atexit(print_report_at_exit) == 0 };
+
+#endif
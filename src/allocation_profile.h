@@ -0,0 +1,51 @@
+// Author: Daniel Kareh
+// Summary: An optional build mode that counts every heap allocation and
+//          attributes it to the code that made it. Define
+//          `CHESS_ALLOCATION_PROFILE` (or configure CMake with
+//          `-D CHESS_ALLOCATION_PROFILE=ON`) to replace the global
+//          `operator new` with a counting one. A report of the busiest call
+//          sites is printed to standard error when the program exits.
+//
+// The hot paths of the rules engine must never allocate. In this build
+// mode, they're wrapped in `CHESS_EXPECT_NO_ALLOCATIONS`, which aborts with
+// a report as soon as one of them allocates. Otherwise, it does nothing.
+
+#ifndef CHESS_ALLOCATION_PROFILE_H
+#define CHESS_ALLOCATION_PROFILE_H
+
+#ifdef CHESS_ALLOCATION_PROFILE
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// How many times the calling thread has allocated so far.
+std::uint64_t get_thread_allocation_count();
+
+// The call sites that allocated the most, busiest first.
+std::string get_allocation_report(std::size_t max_sites = 20);
+
+class NoAllocationScope {
+public:
+	explicit NoAllocationScope(const char* name)
+		: name{ name }
+		, start{ get_thread_allocation_count() } {}
+	~NoAllocationScope();
+
+	NoAllocationScope(const NoAllocationScope&) = delete;
+	NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+
+private:
+	const char* name;
+	std::uint64_t start;
+};
+
+#define CHESS_EXPECT_NO_ALLOCATIONS(name) const NoAllocationScope chess_no_allocation_scope{ name }
+
+#else
+
+#define CHESS_EXPECT_NO_ALLOCATIONS(name) static_cast<void>(0)
+
+#endif
+
+#endif
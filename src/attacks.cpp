@@ -0,0 +1,281 @@
+// Author: Daniel Kareh
+// Summary: Functions that compute every square attacked by each side in one
+//          pass over the whole board.
+
+#include "attacks.h"
+#include <stdexcept> // For std::invalid_argument.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CHESS_HAS_SSE2
+// GCC and Clang can compile AVX2 code on its own and check for it when the
+// program runs. Other compilers need to target AVX2 for the whole program.
+#if defined(__GNUC__)
+#define CHESS_HAS_AVX2
+#define CHESS_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#define CHESS_HAS_AVX2
+#define CHESS_TARGET_AVX2
+#endif
+#endif
+
+using Bitboard = std::uint64_t;
+
+static const Bitboard a_file{ 0x0101010101010101 };
+static const Bitboard not_a_file{ ~a_file };
+static const Bitboard not_h_file{ ~(a_file << 7) };
+static const Bitboard not_ab_files{ ~(a_file | a_file << 1) };
+static const Bitboard not_gh_files{ ~(a_file << 6 | a_file << 7) };
+static const Bitboard all_files{ ~Bitboard{ 0 } };
+
+static const int black_index{ 0 };
+static const int white_index{ 1 };
+
+// Black pawns attack toward the first rank and white pawns toward the eighth.
+static Bitboard get_pawn_attacks(Bitboard pawns, int color_index) {
+	if (color_index == white_index)
+		return ((pawns << 9) & not_a_file) | ((pawns << 7) & not_h_file);
+	return ((pawns >> 7) & not_a_file) | ((pawns >> 9) & not_h_file);
+}
+
+static Bitboard get_knight_attacks(Bitboard knights) {
+	const Bitboard one_file{ ((knights >> 1) & not_h_file) | ((knights << 1) & not_a_file) };
+	const Bitboard two_files{ ((knights >> 2) & not_gh_files) | ((knights << 2) & not_ab_files) };
+	return (one_file << 16) | (one_file >> 16) | (two_files << 8) | (two_files >> 8);
+}
+
+static Bitboard get_king_attacks(Bitboard kings) {
+	const Bitboard attacks{ ((kings << 1) & not_a_file) | ((kings >> 1) & not_h_file) };
+	const Bitboard row{ attacks | kings };
+	return attacks | (row << 8) | (row >> 8);
+}
+
+// Every direction is a shift toward higher squares (left) or lower squares
+// (right). The mask removes squares that wrapped around to the other side of
+// the board.
+//
+//   Left:  north 8, east 1 (not a), northeast 9 (not a), northwest 7 (not h)
+//   Right: south 8, west 1 (not h), southwest 9 (not h), southeast 7 (not a)
+template <bool Left>
+static Bitboard shift(Bitboard bits, int amount) {
+	return Left ? bits << amount : bits >> amount;
+}
+
+// Spread the sliders through empty squares in one direction, doubling the
+// distance each step (Kogge-Stone), then take one more step to reach the
+// squares they attack (including the first piece in the way).
+template <bool Left>
+static Bitboard slide(Bitboard sliders, Bitboard empty, int amount, Bitboard mask) {
+	Bitboard open{ empty & mask };
+	sliders |= open & shift<Left>(sliders, amount);
+	open &= shift<Left>(open, amount);
+	sliders |= open & shift<Left>(sliders, amount * 2);
+	open &= shift<Left>(open, amount * 2);
+	sliders |= open & shift<Left>(sliders, amount * 4);
+	return shift<Left>(sliders, amount) & mask;
+}
+
+static std::array<Bitboard, 2> get_sliding_attacks_scalar(
+	const std::array<AttackingPieces, 2>& pieces, Bitboard empty) {
+	std::array<Bitboard, 2> attacks{};
+	for (int i{ 0 }; i < 2; i++) {
+		const Bitboard orthogonal{ pieces[i].orthogonal_sliders };
+		const Bitboard diagonal{ pieces[i].diagonal_sliders };
+		attacks[i] = slide<true>(orthogonal, empty, 8, all_files)
+			| slide<true>(orthogonal, empty, 1, not_a_file)
+			| slide<true>(diagonal, empty, 9, not_a_file)
+			| slide<true>(diagonal, empty, 7, not_h_file)
+			| slide<false>(orthogonal, empty, 8, all_files)
+			| slide<false>(orthogonal, empty, 1, not_h_file)
+			| slide<false>(diagonal, empty, 9, not_h_file)
+			| slide<false>(diagonal, empty, 7, not_a_file);
+	}
+	return attacks;
+}
+
+#ifdef CHESS_HAS_SSE2
+// Both sides at once, one in each 64-bit lane (black in the low lane).
+template <int Amount, bool Left>
+static __m128i shift_sse2(__m128i bits) {
+	return Left ? _mm_slli_epi64(bits, Amount) : _mm_srli_epi64(bits, Amount);
+}
+
+template <int Amount, bool Left>
+static __m128i slide_sse2(__m128i sliders, __m128i empty, Bitboard mask) {
+	const __m128i lane_mask{ _mm_set1_epi64x(static_cast<long long>(mask)) };
+	__m128i open{ _mm_and_si128(empty, lane_mask) };
+	sliders = _mm_or_si128(sliders, _mm_and_si128(open, shift_sse2<Amount, Left>(sliders)));
+	open = _mm_and_si128(open, shift_sse2<Amount, Left>(open));
+	sliders = _mm_or_si128(sliders, _mm_and_si128(open, shift_sse2<Amount * 2, Left>(sliders)));
+	open = _mm_and_si128(open, shift_sse2<Amount * 2, Left>(open));
+	sliders = _mm_or_si128(sliders, _mm_and_si128(open, shift_sse2<Amount * 4, Left>(sliders)));
+	return _mm_and_si128(shift_sse2<Amount, Left>(sliders), lane_mask);
+}
+
+static std::array<Bitboard, 2> get_sliding_attacks_sse2(
+	const std::array<AttackingPieces, 2>& pieces, Bitboard empty) {
+	const __m128i orthogonal{ _mm_set_epi64x(
+		static_cast<long long>(pieces[white_index].orthogonal_sliders),
+		static_cast<long long>(pieces[black_index].orthogonal_sliders)) };
+	const __m128i diagonal{ _mm_set_epi64x(
+		static_cast<long long>(pieces[white_index].diagonal_sliders),
+		static_cast<long long>(pieces[black_index].diagonal_sliders)) };
+	const __m128i open{ _mm_set1_epi64x(static_cast<long long>(empty)) };
+
+	__m128i attacks{ slide_sse2<8, true>(orthogonal, open, all_files) };
+	attacks = _mm_or_si128(attacks, slide_sse2<1, true>(orthogonal, open, not_a_file));
+	attacks = _mm_or_si128(attacks, slide_sse2<9, true>(diagonal, open, not_a_file));
+	attacks = _mm_or_si128(attacks, slide_sse2<7, true>(diagonal, open, not_h_file));
+	attacks = _mm_or_si128(attacks, slide_sse2<8, false>(orthogonal, open, all_files));
+	attacks = _mm_or_si128(attacks, slide_sse2<1, false>(orthogonal, open, not_h_file));
+	attacks = _mm_or_si128(attacks, slide_sse2<9, false>(diagonal, open, not_h_file));
+	attacks = _mm_or_si128(attacks, slide_sse2<7, false>(diagonal, open, not_a_file));
+
+	std::array<Bitboard, 2> result{};
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()), attacks);
+	return result;
+}
+#endif
+
+#ifdef CHESS_HAS_AVX2
+// Two directions for both sides at once: black and white in the first
+// direction, then black and white in the second. AVX2 can shift each lane by
+// a different amount.
+template <bool Left>
+CHESS_TARGET_AVX2 static __m256i shift_avx2(__m256i bits, __m256i amounts) {
+	return Left ? _mm256_sllv_epi64(bits, amounts) : _mm256_srlv_epi64(bits, amounts);
+}
+
+template <bool Left>
+CHESS_TARGET_AVX2 static __m256i slide_avx2(
+	__m256i sliders, __m256i empty, int first_amount, int second_amount, Bitboard first_mask,
+	Bitboard second_mask) {
+	const __m256i amounts{ _mm256_set_epi64x(
+		second_amount, second_amount, first_amount, first_amount) };
+	const __m256i amounts2{ _mm256_add_epi64(amounts, amounts) };
+	const __m256i amounts4{ _mm256_add_epi64(amounts2, amounts2) };
+	const auto second{ static_cast<long long>(second_mask) };
+	const auto first{ static_cast<long long>(first_mask) };
+	const __m256i lane_mask{ _mm256_set_epi64x(second, second, first, first) };
+
+	__m256i open{ _mm256_and_si256(empty, lane_mask) };
+	sliders = _mm256_or_si256(sliders, _mm256_and_si256(open, shift_avx2<Left>(sliders, amounts)));
+	open = _mm256_and_si256(open, shift_avx2<Left>(open, amounts));
+	sliders = _mm256_or_si256(sliders, _mm256_and_si256(open, shift_avx2<Left>(sliders, amounts2)));
+	open = _mm256_and_si256(open, shift_avx2<Left>(open, amounts2));
+	sliders = _mm256_or_si256(sliders, _mm256_and_si256(open, shift_avx2<Left>(sliders, amounts4)));
+	return _mm256_and_si256(shift_avx2<Left>(sliders, amounts), lane_mask);
+}
+
+CHESS_TARGET_AVX2 static std::array<Bitboard, 2> get_sliding_attacks_avx2(
+	const std::array<AttackingPieces, 2>& pieces, Bitboard empty) {
+	const auto black_orthogonal{ static_cast<long long>(pieces[black_index].orthogonal_sliders) };
+	const auto white_orthogonal{ static_cast<long long>(pieces[white_index].orthogonal_sliders) };
+	const auto black_diagonal{ static_cast<long long>(pieces[black_index].diagonal_sliders) };
+	const auto white_diagonal{ static_cast<long long>(pieces[white_index].diagonal_sliders) };
+	const __m256i orthogonal{ _mm256_set_epi64x(
+		white_orthogonal, black_orthogonal, white_orthogonal, black_orthogonal) };
+	const __m256i diagonal{ _mm256_set_epi64x(
+		white_diagonal, black_diagonal, white_diagonal, black_diagonal) };
+	const __m256i open{ _mm256_set1_epi64x(static_cast<long long>(empty)) };
+
+	// North and east, northeast and northwest, south and west, then
+	// southwest and southeast.
+	__m256i attacks{ slide_avx2<true>(orthogonal, open, 8, 1, all_files, not_a_file) };
+	attacks = _mm256_or_si256(
+		attacks, slide_avx2<true>(diagonal, open, 9, 7, not_a_file, not_h_file));
+	attacks = _mm256_or_si256(
+		attacks, slide_avx2<false>(orthogonal, open, 8, 1, all_files, not_h_file));
+	attacks = _mm256_or_si256(
+		attacks, slide_avx2<false>(diagonal, open, 9, 7, not_h_file, not_a_file));
+
+	// Fold the second direction's lanes onto the first's.
+	const __m128i folded{ _mm_or_si128(
+		_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1)) };
+	std::array<Bitboard, 2> result{};
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()), folded);
+	return result;
+}
+#endif
+
+bool is_attack_implementation_supported(attack_implementation implementation) {
+	switch (implementation) {
+	case attack_implementation::scalar:
+		return true;
+	case attack_implementation::sse2:
+#ifdef CHESS_HAS_SSE2
+		return true;
+#else
+		return false;
+#endif
+	case attack_implementation::avx2:
+#if defined(CHESS_HAS_AVX2) && defined(__GNUC__)
+		return __builtin_cpu_supports("avx2");
+#elif defined(CHESS_HAS_AVX2)
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+attack_implementation get_best_attack_implementation() {
+	static const attack_implementation best{ [] {
+		if (is_attack_implementation_supported(attack_implementation::avx2))
+			return attack_implementation::avx2;
+		if (is_attack_implementation_supported(attack_implementation::sse2))
+			return attack_implementation::sse2;
+		return attack_implementation::scalar;
+	}() };
+	return best;
+}
+
+const char* get_attack_implementation_name(attack_implementation implementation) {
+	switch (implementation) {
+	case attack_implementation::scalar:
+		return "scalar";
+	case attack_implementation::sse2:
+		return "sse2";
+	case attack_implementation::avx2:
+		return "avx2";
+	default:
+		throw std::invalid_argument{ "Invalid attack implementation" };
+	}
+}
+
+std::array<Bitboard, 2> compute_attack_maps(
+	const std::array<AttackingPieces, 2>& pieces, Bitboard occupied) {
+	return compute_attack_maps(pieces, occupied, get_best_attack_implementation());
+}
+
+std::array<Bitboard, 2> compute_attack_maps(const std::array<AttackingPieces, 2>& pieces,
+	Bitboard occupied, attack_implementation implementation) {
+	if (!is_attack_implementation_supported(implementation))
+		throw std::invalid_argument{ "Unsupported attack implementation" };
+
+	std::array<Bitboard, 2> attacks{};
+	switch (implementation) {
+#ifdef CHESS_HAS_AVX2
+	case attack_implementation::avx2:
+		attacks = get_sliding_attacks_avx2(pieces, ~occupied);
+		break;
+#endif
+#ifdef CHESS_HAS_SSE2
+	case attack_implementation::sse2:
+		attacks = get_sliding_attacks_sse2(pieces, ~occupied);
+		break;
+#endif
+	default:
+		attacks = get_sliding_attacks_scalar(pieces, ~occupied);
+		break;
+	}
+
+	for (int i{ 0 }; i < 2; i++) {
+		attacks[i] |= get_pawn_attacks(pieces[i].pawns, i);
+		attacks[i] |= get_knight_attacks(pieces[i].knights);
+		attacks[i] |= get_king_attacks(pieces[i].kings);
+	}
+	return attacks;
+}
@@ -0,0 +1,52 @@
+// Author: Daniel Kareh
+// Summary: Functions that compute every square attacked by each side in one
+//          pass over the whole board. Sliding pieces are handled with
+//          Kogge-Stone fills, which spread all the sliders of one direction
+//          at once, and the eight directions are vectorized with SSE2 or
+//          AVX2 where the processor has them.
+//
+// Bitboards have bit `rank * 8 + file` set for each square in them, the same
+// numbering as `StandardGeometry::get_index`.
+
+#ifndef CHESS_ATTACKS_H
+#define CHESS_ATTACKS_H
+
+#include <array>
+#include <cstdint>
+
+// One side's pieces, grouped by how they attack. Queens are in both sets of
+// sliders.
+struct AttackingPieces {
+	std::uint64_t pawns{ 0 };
+	std::uint64_t knights{ 0 };
+	std::uint64_t diagonal_sliders{ 0 };
+	std::uint64_t orthogonal_sliders{ 0 };
+	std::uint64_t kings{ 0 };
+};
+
+enum class attack_implementation : unsigned char {
+	scalar,
+	sse2,
+	avx2,
+};
+
+// Whether this build has the implementation and this processor can run it.
+bool is_attack_implementation_supported(attack_implementation);
+
+// The fastest implementation that this processor supports.
+attack_implementation get_best_attack_implementation();
+const char* get_attack_implementation_name(attack_implementation);
+
+// Return the squares that each side attacks, indexed by `color` (black first,
+// like the enum). Both sides are computed at once because the vectorized
+// implementations do it for the price of one. Sliders are blocked by any
+// piece in `occupied`. En passant captures aren't included.
+std::array<std::uint64_t, 2> compute_attack_maps(
+	const std::array<AttackingPieces, 2>& pieces, std::uint64_t occupied);
+
+// Like above, but with a particular implementation, which must be supported.
+// All of them give the same results.
+std::array<std::uint64_t, 2> compute_attack_maps(const std::array<AttackingPieces, 2>& pieces,
+	std::uint64_t occupied, attack_implementation);
+
+#endif
@@ -36,8 +36,10 @@ Board generate_chess960_board() {
 
 	// Select one of the 960 valid arrangements.
 	std::uniform_int_distribution fischer_scheme{ 0, 960 - 1 };
-	int index{ fischer_scheme(prng) };
+	return generate_chess960_board(fischer_scheme(prng));
+}
 
+Board generate_chess960_board(int index) {
 	// Determine where the bishops and queen will go.
 	const int bishop1_position{ div_rem(index, 4) };
 	const int bishop2_position{ div_rem(index, 4) };
@@ -80,7 +82,7 @@ Board generate_chess960_board() {
 	ranks[1].fill(Piece{ piece_type::pawn, color::white });
 	ranks[6].fill(Piece{ piece_type::pawn, color::black });
 	ranks[7] = black_home_rank;
-	return Board{ ranks };
+	return Board{ ranks, {}, variant::chess960 };
 }
 
 template <typename T>
@@ -6,6 +6,11 @@
 
 #include "Board.h"
 
+// Choose one of the 960 starting positions at random.
 Board generate_chess960_board();
 
+// Build the starting position with the given number (from 0 to 959) in the
+// Fischer random chess numbering scheme. Number 518 is the classical position.
+Board generate_chess960_board(int index);
+
 #endif
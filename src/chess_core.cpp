@@ -0,0 +1,142 @@
+// Author: Daniel Kareh
+// Summary: A C interface to the rules of chess, for programs that want to
+//          embed the rules instead of running the game. Positions are opaque
+//          handles. No function prints anything or throws.
+
+#include "chess_core.h"
+#include <algorithm>
+#include <cstring> // For std::memcpy.
+#include <new>
+#include "fen.h"
+#include "san.h"
+
+struct chess_position {
+	FenPosition position;
+};
+
+static std::uint8_t get_square_index(Square square) {
+	return static_cast<std::uint8_t>(square.get_rank() * 8 + square.get_file());
+}
+
+static chess_move convert_move(const LegalMove& legal_move) {
+	const auto& [move, details]{ legal_move };
+	chess_move result{};
+	result.from = get_square_index(move.from);
+	result.to = get_square_index(move.to);
+	if (details.promote_to)
+		result.promotion = safe_to_lower(convert_piece_type_to_letter(*details.promote_to));
+	if (details.captured_square)
+		result.flags |= CHESS_MOVE_CAPTURE;
+	if (details.captured_square && *details.captured_square != move.to)
+		result.flags |= CHESS_MOVE_EN_PASSANT;
+	if (details.castling)
+		result.flags |= CHESS_MOVE_CASTLING;
+	return result;
+}
+
+static bool is_same_move(const chess_move& a, const chess_move& b) {
+	const bool a_castles{ (a.flags & CHESS_MOVE_CASTLING) != 0 };
+	const bool b_castles{ (b.flags & CHESS_MOVE_CASTLING) != 0 };
+	return a.from == b.from && a.to == b.to && a.promotion == b.promotion && a_castles == b_castles;
+}
+
+chess_position* chess_position_from_fen(const char* fen) {
+	try {
+		auto position{ parse_fen(fen) };
+		if (!position)
+			return nullptr;
+		return new chess_position{ *position };
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+chess_position* chess_position_copy(const chess_position* position) {
+	return new (std::nothrow) chess_position{ *position };
+}
+
+void chess_position_free(chess_position* position) { delete position; }
+
+size_t chess_position_to_fen(const chess_position* position, char* buffer, size_t capacity) {
+	try {
+		const auto& [board, active_color, halfmove_clock, fullmove_number]{ position->position };
+		const auto fen{ format_fen(board, active_color, halfmove_clock, fullmove_number) };
+		if (capacity > 0) {
+			const auto length{ std::min(fen.size(), capacity - 1) };
+			std::memcpy(buffer, fen.data(), length);
+			buffer[length] = '\0';
+		}
+		return fen.size();
+	} catch (...) {
+		if (capacity > 0)
+			buffer[0] = '\0';
+		return 0;
+	}
+}
+
+chess_color chess_get_active_color(const chess_position* position) {
+	return position->position.active_color == color::white ? CHESS_WHITE : CHESS_BLACK;
+}
+
+chess_status chess_get_status(const chess_position* position) {
+	try {
+		const auto& [board, active_color, halfmove_clock, fullmove_number]{ position->position };
+		const bool in_check{ board.piece_is_under_attack(board.find_king(active_color)) };
+		if (!board.get_all_legal_moves(active_color).empty())
+			return in_check ? CHESS_CHECK : CHESS_PLAYING;
+		return in_check ? CHESS_CHECKMATE : CHESS_STALEMATE;
+	} catch (...) {
+		// Only running out of memory can get here. Don't claim the game is over.
+		return CHESS_PLAYING;
+	}
+}
+
+size_t chess_generate_moves(const chess_position* position, chess_move* moves, size_t capacity) {
+	try {
+		const auto& [board, active_color, halfmove_clock, fullmove_number]{ position->position };
+		const auto legal_moves{ board.get_all_legal_moves(active_color) };
+		for (std::size_t i{ 0 }; i < std::min(legal_moves.size(), capacity); i++)
+			moves[i] = convert_move(legal_moves[i]);
+		return legal_moves.size();
+	} catch (...) {
+		return 0;
+	}
+}
+
+int chess_apply_move(chess_position* position, chess_move move) {
+	try {
+		auto& [board, active_color, halfmove_clock, fullmove_number]{ position->position };
+		for (const auto& legal_move : board.get_all_legal_moves(active_color)) {
+			if (!is_same_move(convert_move(legal_move), move))
+				continue;
+
+			const auto piece{ board.get_piece(legal_move.move.from) };
+			const bool is_pawn{ piece && piece->type == piece_type::pawn };
+			halfmove_clock = is_pawn || legal_move.details.captured_square ? 0 : halfmove_clock + 1;
+			if (active_color == color::black)
+				fullmove_number++;
+
+			board.play(legal_move);
+			active_color = get_opposing_color(active_color);
+			return 0;
+		}
+	} catch (...) {
+	}
+	return -1;
+}
+
+int chess_parse_move(const chess_position* position, const char* string, chess_move* move) {
+	try {
+		const auto& [board, active_color, halfmove_clock, fullmove_number]{ position->position };
+		auto legal_move{ parse_coordinate_move(string, board, active_color) };
+		if (!legal_move)
+			legal_move = parse_san(string, board, active_color);
+		if (!legal_move)
+			return -1;
+
+		*move = convert_move(*legal_move);
+		return 0;
+	} catch (...) {
+		return -1;
+	}
+}
@@ -0,0 +1,94 @@
+/* Author: Daniel Kareh
+ * Summary: A C interface to the rules of chess, for programs that want to
+ *          embed the rules instead of running the game. Positions are opaque
+ *          handles. No function prints anything or throws.
+ */
+
+#ifndef CHESS_CORE_H
+#define CHESS_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(CHESS_CORE_SHARED)
+#ifdef CHESS_CORE_BUILDING
+#define CHESS_CORE_API __declspec(dllexport)
+#else
+#define CHESS_CORE_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define CHESS_CORE_API __attribute__((visibility("default")))
+#else
+#define CHESS_CORE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* No position has more legal moves than this. */
+#define CHESS_MAX_MOVES 256
+
+/* Squares are numbered from 0 (a1) to 63 (h8): `rank * 8 + file`. */
+typedef struct chess_move {
+	uint8_t from;
+	/* When castling, this is where the king ends up (the c-file or the g-file). */
+	uint8_t to;
+	/* One of 'n', 'b', 'r', or 'q' for promotions, or 0. */
+	char promotion;
+	/* A combination of the CHESS_MOVE_* flags. */
+	uint8_t flags;
+} chess_move;
+
+#define CHESS_MOVE_CAPTURE 1
+#define CHESS_MOVE_EN_PASSANT 2
+#define CHESS_MOVE_CASTLING 4
+
+typedef enum chess_color {
+	CHESS_WHITE,
+	CHESS_BLACK,
+} chess_color;
+
+typedef enum chess_status {
+	CHESS_PLAYING,
+	CHESS_CHECK,
+	CHESS_CHECKMATE,
+	CHESS_STALEMATE,
+} chess_status;
+
+typedef struct chess_position chess_position;
+
+/* Return NULL if the FEN record is invalid, doesn't give each side exactly
+ * one king, or has a pawn on the first or last rank (or if memory runs out).
+ * Castling rights may be written like in X-FEN or Shredder-FEN for Chess960. */
+CHESS_CORE_API chess_position* chess_position_from_fen(const char* fen);
+CHESS_CORE_API chess_position* chess_position_copy(const chess_position*);
+CHESS_CORE_API void chess_position_free(chess_position*);
+
+/* Write the position's FEN record (with a null terminator) into `buffer`, like
+ * snprintf. Return the length the record needs, not counting the terminator.
+ * A buffer of 128 bytes is always large enough. */
+CHESS_CORE_API size_t chess_position_to_fen(const chess_position*, char* buffer, size_t capacity);
+
+CHESS_CORE_API chess_color chess_get_active_color(const chess_position*);
+CHESS_CORE_API chess_status chess_get_status(const chess_position*);
+
+/* Write up to `capacity` legal moves into `moves` and return how many legal
+ * moves there are. A capacity of CHESS_MAX_MOVES is always large enough. */
+CHESS_CORE_API size_t chess_generate_moves(
+	const chess_position*, chess_move* moves, size_t capacity);
+
+/* Play a legal move (as returned by chess_generate_moves or chess_parse_move)
+ * for the active color. Return 0 on success, or -1 if the move is illegal, in
+ * which case the position doesn't change. */
+CHESS_CORE_API int chess_apply_move(chess_position*, chess_move);
+
+/* Parse a move in coordinate notation (like 'e2e4' or 'e7e8q') or in SAN
+ * (like 'Nf3' or 'O-O'). Return 0 on success, or -1 if it isn't legal. */
+CHESS_CORE_API int chess_parse_move(const chess_position*, const char* string, chess_move* move);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,277 @@
+// Author: Daniel Kareh
+// Summary: Functions to read and write positions in Forsyth-Edwards Notation
+//          (FEN). Castling rights may also be written like in X-FEN and
+//          Shredder-FEN (using rook files) so that Chess960 positions work.
+
+#include "fen.h"
+#include <charconv> // For std::from_chars.
+#include <vector>
+
+using Ranks = std::array<Board::Rank, 8>;
+
+static std::vector<std::string_view> split_fields(std::string_view string) {
+	std::vector<std::string_view> fields;
+	std::size_t start{ string.find_first_not_of(" \t\r\n") };
+	while (start != std::string_view::npos) {
+		const std::size_t end{ string.find_first_of(" \t\r\n", start) };
+		fields.push_back(string.substr(start, end - start));
+		if (end == std::string_view::npos)
+			break;
+		start = string.find_first_not_of(" \t\r\n", end);
+	}
+	return fields;
+}
+
+static std::optional<int> parse_int(std::string_view string) {
+	int value{};
+	const auto* end{ string.data() + string.size() };
+	const auto result{ std::from_chars(string.data(), end, value) };
+	if (result.ec != std::errc{} || result.ptr != end)
+		return std::nullopt;
+	return value;
+}
+
+static bool parse_placement(std::string_view placement, Ranks& ranks) {
+	int rank{ 7 };
+	int file{ 0 };
+	for (const char ch : placement) {
+		if (ch == '/') {
+			if (file != 8 || rank == 0)
+				return false;
+			rank--;
+			file = 0;
+		} else if ('1' <= ch && ch <= '8') {
+			file += ch - '0';
+			if (file > 8)
+				return false;
+		} else {
+			const auto type{ convert_letter_to_piece_type(ch) };
+			if (!type || file >= 8)
+				return false;
+			const color color{ safe_to_upper(ch) == ch ? color::white : color::black };
+			ranks.at(rank).at(file++) = Piece{ *type, color };
+		}
+	}
+	return rank == 0 && file == 8;
+}
+
+// The rules (and everything built on them) assume that each side has exactly
+// one king and that no pawn stands where it could never have got to.
+static bool is_playable(const Ranks& ranks) {
+	int white_kings{ 0 };
+	int black_kings{ 0 };
+	for (std::size_t rank{ 0 }; rank < ranks.size(); rank++) {
+		for (const auto& piece : ranks[rank]) {
+			if (!piece)
+				continue;
+			if (piece->is_king())
+				(piece->color == color::white ? white_kings : black_kings)++;
+			if (piece->type == piece_type::pawn && (rank == 0 || rank == ranks.size() - 1))
+				return false;
+		}
+	}
+	return white_kings == 1 && black_kings == 1;
+}
+
+static int get_home_rank(color color) { return color == color::white ? 0 : 7; }
+
+static std::optional<int> find_king_file(const Board::Rank& rank, color color) {
+	for (int file{ 0 }; file < 8; file++) {
+		const auto& piece{ rank.at(file) };
+		if (piece && piece->is_king() && piece->color == color)
+			return file;
+	}
+	return std::nullopt;
+}
+
+static bool is_rook_of(const std::optional<Piece>& piece, color color) {
+	return piece && piece->is_rook() && piece->color == color;
+}
+
+// Give a player the right to castle with the rook on `rook_file`. If no file
+// is given, use the outermost rook on the given side (like 'K' and 'Q' do).
+static bool grant_castling_right(
+	Ranks& ranks, color color, side side, std::optional<int> rook_file) {
+	Board::Rank& rank{ ranks.at(get_home_rank(color)) };
+	const auto king_file{ find_king_file(rank, color) };
+	if (!king_file)
+		return false;
+
+	if (!rook_file) {
+		const int step{ side == side::a_side ? 1 : -1 };
+		for (int file{ side == side::a_side ? 0 : 7 }; file != *king_file; file += step) {
+			if (is_rook_of(rank.at(file), color)) {
+				rook_file = file;
+				break;
+			}
+		}
+	}
+
+	if (!rook_file || !is_rook_of(rank.at(*rook_file), color))
+		return false;
+
+	rank.at(*rook_file)->type = piece_type::castleable_rook;
+	rank.at(*king_file)->type = piece_type::castleable_king;
+	return true;
+}
+
+static bool parse_castling(std::string_view castling, Ranks& ranks) {
+	if (castling == "-")
+		return true;
+
+	for (const char ch : castling) {
+		const color color{ safe_to_upper(ch) == ch ? color::white : color::black };
+		const char upper{ safe_to_upper(ch) };
+		bool granted{ false };
+		if (upper == 'K') {
+			granted = grant_castling_right(ranks, color, side::h_side, std::nullopt);
+		} else if (upper == 'Q') {
+			granted = grant_castling_right(ranks, color, side::a_side, std::nullopt);
+		} else if ('A' <= upper && upper <= 'H') {
+			const int rook_file{ upper - 'A' };
+			const auto king_file{ find_king_file(ranks.at(get_home_rank(color)), color) };
+			const side side{ king_file && rook_file < *king_file ? side::a_side : side::h_side };
+			granted = grant_castling_right(ranks, color, side, rook_file);
+		}
+
+		if (!granted)
+			return false;
+	}
+	return true;
+}
+
+std::optional<FenPosition> parse_fen(std::string_view string) {
+	const auto fields{ split_fields(string) };
+	if (fields.size() < 4)
+		return std::nullopt;
+
+	Ranks ranks{};
+	if (!parse_placement(fields[0], ranks) || !is_playable(ranks))
+		return std::nullopt;
+
+	color active_color{};
+	if (fields[1] == "w")
+		active_color = color::white;
+	else if (fields[1] == "b")
+		active_color = color::black;
+	else
+		return std::nullopt;
+
+	if (!parse_castling(fields[2], ranks))
+		return std::nullopt;
+
+	Square en_passant_target{};
+	if (fields[3] != "-") {
+		const auto target{ Square::parse(fields[3]) };
+		if (!target || (target->get_rank() != 2 && target->get_rank() != 5))
+			return std::nullopt;
+		en_passant_target = *target;
+	}
+
+	FenPosition position{ Board{ ranks, en_passant_target }, active_color };
+
+	// EPD records end after four fields and may be followed by operations, so
+	// only treat the next fields as clocks if they actually are numbers.
+	if (fields.size() >= 6) {
+		const auto halfmove_clock{ parse_int(fields[4]) };
+		const auto fullmove_number{ parse_int(fields[5]) };
+		if (halfmove_clock && fullmove_number) {
+			position.halfmove_clock = *halfmove_clock;
+			position.fullmove_number = *fullmove_number;
+		}
+	}
+
+	return position;
+}
+
+static char get_piece_letter(Piece piece) {
+	const char letter{ convert_piece_type_to_letter(piece.type) };
+	return piece.is_black() ? safe_to_lower(letter) : letter;
+}
+
+static std::string format_placement(const Board& board) {
+	std::string placement;
+	for (int rank{ 7 }; rank >= 0; rank--) {
+		int empty{ 0 };
+		for (int file{ 0 }; file < 8; file++) {
+			const auto piece{ board.get_piece({ rank, file }) };
+			if (!piece) {
+				empty++;
+				continue;
+			}
+
+			if (empty > 0)
+				placement += static_cast<char>('0' + empty);
+			empty = 0;
+			placement += get_piece_letter(*piece);
+		}
+
+		if (empty > 0)
+			placement += static_cast<char>('0' + empty);
+		if (rank > 0)
+			placement += '/';
+	}
+	return placement;
+}
+
+// Write 'K' or 'Q' when the castling rook is the outermost rook on its side
+// (as in X-FEN), and the rook's file otherwise.
+static std::string format_castling_rights(const Board& board, color color) {
+	const int rank{ get_home_rank(color) };
+	std::optional<int> king_file;
+	for (int file{ 0 }; file < 8; file++) {
+		const auto piece{ board.get_piece({ rank, file }) };
+		if (piece && piece->type == piece_type::castleable_king && piece->color == color)
+			king_file = file;
+	}
+
+	std::string rights;
+	if (!king_file)
+		return rights;
+
+	for (const side side : { side::h_side, side::a_side }) {
+		const int step{ side == side::a_side ? -1 : 1 };
+		std::optional<int> rook_file;
+		bool is_outermost{ true };
+		for (int file{ *king_file + step }; 0 <= file && file < 8; file += step) {
+			const auto piece{ board.get_piece({ rank, file }) };
+			if (!piece || !piece->is_rook() || piece->color != color)
+				continue;
+
+			if (rook_file)
+				is_outermost = false;
+			if (piece->type == piece_type::castleable_rook) {
+				rook_file = file;
+				is_outermost = true;
+			}
+		}
+
+		if (!rook_file)
+			continue;
+
+		char letter{};
+		if (is_outermost)
+			letter = side == side::h_side ? 'K' : 'Q';
+		else
+			letter = static_cast<char>('A' + *rook_file);
+		rights += color == color::black ? safe_to_lower(letter) : letter;
+	}
+	return rights;
+}
+
+std::string format_fen(
+	const Board& board, color active_color, int halfmove_clock, int fullmove_number) {
+	std::string fen{ format_placement(board) };
+	fen += active_color == color::white ? " w " : " b ";
+
+	const std::string castling{ format_castling_rights(board, color::white)
+		+ format_castling_rights(board, color::black) };
+	fen += castling.empty() ? "-" : castling;
+
+	const Square target{ board.get_en_passant_target() };
+	fen += ' ';
+	fen += board.is_in_bounds(target) ? target.print() : "-";
+
+	fen += ' ' + std::to_string(halfmove_clock) + ' ' + std::to_string(fullmove_number);
+	return fen;
+}
@@ -0,0 +1,29 @@
+// Author: Daniel Kareh
+// Summary: Functions to read and write positions in Forsyth-Edwards Notation
+//          (FEN). Castling rights may also be written like in X-FEN and
+//          Shredder-FEN (using rook files) so that Chess960 positions work.
+
+#ifndef CHESS_FEN_H
+#define CHESS_FEN_H
+
+#include <string>
+#include <string_view>
+#include "Board.h"
+
+struct FenPosition {
+	Board board;
+	color active_color{ color::white };
+	int halfmove_clock{ 0 };
+	int fullmove_number{ 1 };
+};
+
+// Parse a FEN record. The halfmove clock and fullmove number may be omitted
+// (as they are in EPD records). Return `std::nullopt` if the record is invalid,
+// or if it doesn't give each side exactly one king or puts a pawn on the first
+// or last rank.
+std::optional<FenPosition> parse_fen(std::string_view);
+
+std::string format_fen(const Board&, color active_color, int halfmove_clock = 0,
+	int fullmove_number = 1);
+
+#endif
@@ -0,0 +1,120 @@
+// Author: Daniel Kareh
+// Summary: Optional counters and timers for the hot paths of the rules
+//          engine. They only exist when `CHESS_INSTRUMENT` is defined.
+
+#include "instrument.h"
+
+#ifndef CHESS_INSTRUMENT
+
+std::string get_instrumentation_report() { return ""; }
+
+#else
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib> // For std::malloc, std::abort, and std::atexit.
+#include <new>
+
+static const std::size_t counter_count{ 4 };
+static const std::size_t timer_count{ 1 };
+
+static const std::array<const char*, counter_count> counter_names{
+	"generate_move_details calls",
+	"Board copies in legality checks",
+	"Board copies in piece_would_be_attacked",
+	"piece_is_under_attack calls",
+};
+
+static const std::array<const char*, timer_count> timer_names{
+	"detect_mate",
+};
+
+// Only the owning thread writes to a block, so plain loads and stores are
+// enough. They're atomic only so that a report can read them at any time.
+struct ThreadBlock {
+	std::array<std::atomic<std::uint64_t>, counter_count> counters{};
+	std::array<std::atomic<std::uint64_t>, timer_count> timer_calls{};
+	std::array<std::atomic<std::uint64_t>, timer_count> timer_nanoseconds{};
+	ThreadBlock* next{ nullptr };
+};
+
+// Every thread's block, newest first. Blocks are never freed, so the counts
+// of threads that have exited still show up in reports.
+static std::atomic<ThreadBlock*> blocks{ nullptr };
+
+static void add(std::atomic<std::uint64_t>& value, std::uint64_t amount) {
+	value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static void print_report_at_exit() { std::fputs(get_instrumentation_report().c_str(), stderr); }
+
+static ThreadBlock* register_thread_block() {
+	static const bool registered_exit_report{ std::atexit(print_report_at_exit) == 0 };
+	static_cast<void>(registered_exit_report);
+
+	// Use `malloc` so that registering never counts as an allocation in the
+	// code that happened to count something first. See allocation_profile.h.
+	void* const memory{ std::malloc(sizeof(ThreadBlock)) };
+	if (!memory)
+		std::abort();
+	auto* const block{ new (memory) ThreadBlock };
+	block->next = blocks.load(std::memory_order_relaxed);
+	while (!blocks.compare_exchange_weak(block->next, block, std::memory_order_release,
+		std::memory_order_relaxed)) {
+	}
+	return block;
+}
+
+static ThreadBlock& get_thread_block() {
+	thread_local ThreadBlock* const block{ register_thread_block() };
+	return *block;
+}
+
+void add_to_counter(instrument_counter counter, std::uint64_t amount) {
+	add(get_thread_block().counters[static_cast<std::size_t>(counter)], amount);
+}
+
+void add_to_timer(instrument_timer timer, std::chrono::steady_clock::duration duration) {
+	auto& block{ get_thread_block() };
+	const auto index{ static_cast<std::size_t>(timer) };
+	const std::chrono::nanoseconds nanoseconds{ duration };
+	add(block.timer_calls[index], 1);
+	add(block.timer_nanoseconds[index], static_cast<std::uint64_t>(nanoseconds.count()));
+}
+
+std::string get_instrumentation_report() {
+	std::array<std::uint64_t, counter_count> counters{};
+	std::array<std::uint64_t, timer_count> timer_calls{};
+	std::array<std::uint64_t, timer_count> timer_nanoseconds{};
+	int thread_count{ 0 };
+	for (auto* block{ blocks.load(std::memory_order_acquire) }; block; block = block->next) {
+		thread_count++;
+		for (std::size_t i{ 0 }; i < counter_count; i++)
+			counters[i] += block->counters[i].load(std::memory_order_relaxed);
+		for (std::size_t i{ 0 }; i < timer_count; i++) {
+			timer_calls[i] += block->timer_calls[i].load(std::memory_order_relaxed);
+			timer_nanoseconds[i] += block->timer_nanoseconds[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	std::string report{
+		"Instrumentation report\n  Threads: " + std::to_string(thread_count) + '\n'
+	};
+	for (std::size_t i{ 0 }; i < counter_count; i++)
+		report += "  " + std::string{ counter_names[i] } + ": " + std::to_string(counters[i])
+			+ '\n';
+
+	for (std::size_t i{ 0 }; i < timer_count; i++) {
+		const double milliseconds{ static_cast<double>(timer_nanoseconds[i]) / 1e6 };
+		const double average{
+			timer_calls[i] == 0 ? 0.0 : milliseconds / static_cast<double>(timer_calls[i])
+		};
+		report += "  " + std::string{ timer_names[i] } + ": " + std::to_string(timer_calls[i])
+			+ " calls, " + std::to_string(milliseconds) + " ms total, " + std::to_string(average)
+			+ " ms each\n";
+	}
+	return report;
+}
+
+#endif
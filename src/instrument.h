@@ -0,0 +1,67 @@
+// Author: Daniel Kareh
+// Summary: Optional counters and timers for the hot paths of the rules
+//          engine. Define `CHESS_INSTRUMENT` (or configure CMake with
+//          `-D CHESS_INSTRUMENT=ON`) to turn them on. Otherwise, the macros
+//          below expand to nothing, so they cost nothing.
+//
+// Each thread counts into its own block of counters, so counting never takes
+// a lock. A report adds up every thread's counters, including threads that
+// have already exited. When instrumentation is on, the report is also
+// printed to standard error when the program exits.
+
+#ifndef CHESS_INSTRUMENT_H
+#define CHESS_INSTRUMENT_H
+
+#include <cstdint>
+#include <string>
+
+enum class instrument_counter : unsigned char {
+	generate_move_details,
+	legal_move_board_copies,
+	would_be_attacked_board_copies,
+	attack_checks,
+};
+
+enum class instrument_timer : unsigned char {
+	detect_mate,
+};
+
+// Return a human-readable report of every counter and timer, or an empty
+// string if instrumentation is off.
+std::string get_instrumentation_report();
+
+#ifdef CHESS_INSTRUMENT
+
+#include <chrono>
+
+void add_to_counter(instrument_counter, std::uint64_t amount);
+void add_to_timer(instrument_timer, std::chrono::steady_clock::duration);
+
+// Time the rest of the enclosing scope.
+class InstrumentScope {
+public:
+	explicit InstrumentScope(instrument_timer timer)
+		: timer{ timer }
+		, start{ std::chrono::steady_clock::now() } {}
+	~InstrumentScope() { add_to_timer(timer, std::chrono::steady_clock::now() - start); }
+
+	InstrumentScope(const InstrumentScope&) = delete;
+	InstrumentScope& operator=(const InstrumentScope&) = delete;
+
+private:
+	instrument_timer timer;
+	std::chrono::steady_clock::time_point start;
+};
+
+#define CHESS_COUNT(name) add_to_counter(instrument_counter::name, 1)
+#define CHESS_TIME_SCOPE(name) \
+	const InstrumentScope chess_instrument_scope_##name{ instrument_timer::name }
+
+#else
+
+#define CHESS_COUNT(name) static_cast<void>(0)
+#define CHESS_TIME_SCOPE(name) static_cast<void>(0)
+
+#endif
+
+#endif
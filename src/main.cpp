@@ -4,11 +4,18 @@
 //          chess and all of the rules are enforced. The user can also choose
 //          between several different visual styles.
 
+#include <algorithm> // For std::max.
+#include <chrono>
+#include <fstream>
+#include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include "Game.h"
+#include "HeadlessUserInterface.h"
 #include "Menu.h"
 #include "chess960.h"
+#include "fen.h"
 #include "ui/AsciiUi.h"
 #include "ui/LetterUi.h"
 #include "ui/TwoLetterUi.h"
@@ -51,15 +58,34 @@ static const Menu variant_menu{
 	},
 };
 
-enum class variant : unsigned char {
-	classical,
-	chess960,
+// FIXME(Daniel): NOLINTNEXTLINE(cert-err58-cpp)
+static const Menu analysis_menu{
+	"Engine Analysis",
+	{
+		{ "Off" },
+		{ "Analyze the position while you type (uses another core)" },
+	},
 };
 
 static Board setup_initial_board(variant);
+static int replay(const std::string& path, const std::string& fen);
 
 // FIXME(Daniel): NOLINTNEXTLINE(bugprone-exception-escape)
-int main() {
+int main(int argc, char* argv[]) {
+	// Usage: chess --replay SCRIPT [--fen FEN]
+	// Replay the moves in SCRIPT (or standard input, if SCRIPT is '-') without
+	// drawing anything, and print the final position and how long each move
+	// took. See HeadlessUserInterface.h for what a script can contain.
+	if (argc > 1) {
+		const std::string command{ argv[1] };
+		if (command == "--replay"
+			&& (argc == 3 || (argc == 5 && std::string{ argv[3] } == "--fen")))
+			return replay(argv[2], argc == 5 ? argv[4] : "");
+
+		std::cerr << "Usage: " << argv[0] << " [--replay SCRIPT [--fen FEN]]\n";
+		return 2;
+	}
+
 	auto choice{ main_menu.run() };
 	if (choice == 0) {
 		auto visual_style{ visual_style_menu.run() };
@@ -87,7 +113,10 @@ int main() {
 
 		auto variant{ static_cast<enum variant>(variant_menu.run()) };
 		const Board initial_board{ setup_initial_board(variant) };
+		const bool ponder{ analysis_menu.run() == 1 };
 		Game game{ initial_board, std::move(user_interface) };
+		if (ponder)
+			game.enable_pondering();
 		game.run();
 	} else {
 		return 1;
@@ -104,3 +133,75 @@ static Board setup_initial_board(variant variant) {
 		throw std::invalid_argument{ "Invalid variant" };
 	}
 }
+
+// The history doesn't say which pieces moved, so play it again from the start
+// to find the last pawn move or capture.
+static int get_halfmove_clock(const FenPosition& start, const ArenaVector<MoveRecord>& history) {
+	Board board{ start.board };
+	int halfmove_clock{ start.halfmove_clock };
+	for (const auto& [move, details] : history) {
+		const auto piece{ board.get_piece(move.from) };
+		const bool is_pawn{ piece && piece->type == piece_type::pawn };
+		halfmove_clock = is_pawn || details.captured_square ? 0 : halfmove_clock + 1;
+		board.play({ move, details });
+	}
+	return halfmove_clock;
+}
+
+static int replay(const std::string& path, const std::string& fen) {
+	std::optional<FenPosition> position{ FenPosition{} };
+	if (!fen.empty())
+		position = parse_fen(fen);
+	if (!position) {
+		std::cerr << "Invalid FEN: " << fen << '\n';
+		return 2;
+	}
+
+	std::ifstream file;
+	if (path != "-") {
+		file.open(path);
+		if (!file) {
+			std::cerr << "Cannot open " << path << '\n';
+			return 1;
+		}
+	}
+
+	auto user_interface{ std::make_unique<HeadlessUserInterface>(path == "-" ? std::cin : file) };
+	const auto& headless{ *user_interface };
+	Game game{ position->board, std::move(user_interface), position->active_color };
+	const auto start{ std::chrono::steady_clock::now() };
+	game.run();
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+	const auto& move_times{ headless.get_move_times() };
+	std::chrono::nanoseconds total_time{ 0 };
+	std::chrono::nanoseconds slowest{ 0 };
+	for (const auto move_time : move_times) {
+		total_time += move_time;
+		slowest = std::max(slowest, move_time);
+	}
+	const double average{ static_cast<double>(total_time.count())
+		/ static_cast<double>(std::max<std::size_t>(move_times.size(), 1)) };
+
+	// Count plies from White's move in the first full move.
+	const int plies{ static_cast<int>(game.get_history().size())
+		+ (position->active_color == color::black ? 1 : 0) };
+	const int fullmove_number{ position->fullmove_number + plies / 2 };
+	const int halfmove_clock{ get_halfmove_clock(*position, game.get_history()) };
+	std::cout << "Moves: " << game.get_history().size() << '\n';
+	std::cout << "Final position: "
+			  << format_fen(game.get_board(), game.get_active_color(), halfmove_clock,
+					 fullmove_number)
+			  << '\n';
+	if (!headless.get_last_notification().empty())
+		std::cout << "Last notice: " << headless.get_last_notification() << '\n';
+	std::cout << "Seconds: " << elapsed.count() << '\n';
+	std::cout << "Nanoseconds per move: " << average << " (slowest " << slowest.count() << ")\n";
+
+	if (!headless.get_error().empty()) {
+		std::cerr << "Move " << game.get_history().size() + 1 << ": " << headless.get_error()
+				  << '\n';
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,546 @@
+// Author: Daniel Kareh
+// Summary: A slow but plain reference for the rules, and checks that compare
+//          the fast move generators (and make/unmake, and the attack maps)
+//          against it. The reference shares no code with the fast paths
+//          apart from `Board::play`. When they disagree, the position can be
+//          shrunk to a small reproducer.
+
+#include "move_oracle.h"
+#include <algorithm>
+#include <initializer_list>
+#include "LegalMoveSet.h"
+#include "MovePicker.h"
+#include "attacks.h"
+#include "san.h"
+
+using Step = std::pair<int, int>;
+
+static const std::array<Step, 8> knight_steps{ {
+	{ 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } } };
+static const std::array<Step, 4> orthogonal_steps{ { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } } };
+static const std::array<Step, 4> diagonal_steps{ { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } } };
+static const std::array<Step, 8> king_steps{ {
+	{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } } };
+
+// Is there a piece of one of the (base) types and the color on the square?
+static bool has_piece(
+	const Board& board, Square square, color color, std::initializer_list<piece_type> types) {
+	if (!board.is_in_bounds(square))
+		return false;
+
+	const auto piece{ board.get_piece(square) };
+	return piece && piece->color == color
+		&& std::find(types.begin(), types.end(), get_base_type(piece->type)) != types.end();
+}
+
+// Look outward from the square for a piece that could capture on it, one
+// step at a time along each ray. En passant doesn't count.
+static bool is_attacked(const Board& board, Square square, color attacker) {
+	const int forward{ attacker == color::white ? 1 : -1 };
+	for (const int file_step : { -1, 1 }) {
+		const Square from{ square.get_offset(-forward, file_step) };
+		if (has_piece(board, from, attacker, { piece_type::pawn }))
+			return true;
+	}
+
+	for (const auto& [ranks, files] : knight_steps) {
+		if (has_piece(board, square.get_offset(ranks, files), attacker, { piece_type::knight }))
+			return true;
+	}
+
+	for (const auto& [ranks, files] : king_steps) {
+		if (has_piece(board, square.get_offset(ranks, files), attacker, { piece_type::king }))
+			return true;
+	}
+
+	const auto find_slider{ [&](const std::array<Step, 4>& steps, piece_type slider) {
+		for (const auto& [ranks, files] : steps) {
+			Square current{ square.get_offset(ranks, files) };
+			while (board.is_in_bounds(current) && !board.is_occupied(current))
+				current = current.get_offset(ranks, files);
+			if (has_piece(board, current, attacker, { slider, piece_type::queen }))
+				return true;
+		}
+		return false;
+	} };
+	return find_slider(orthogonal_steps, piece_type::rook)
+		|| find_slider(diagonal_steps, piece_type::bishop);
+}
+
+static bool is_in_check(const Board& board, color color) {
+	for (const Square square : board) {
+		if (has_piece(board, square, color, { piece_type::king }))
+			return is_attacked(board, square, get_opposing_color(color));
+	}
+	return false;
+}
+
+static void add_move(std::vector<LegalMove>& moves, Move move, MoveDetails details, bool promotes) {
+	if (!promotes) {
+		moves.push_back({ move, details });
+		return;
+	}
+
+	for (const piece_type type :
+		{ piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen }) {
+		details.promote_to = type;
+		moves.push_back({ move, details });
+	}
+}
+
+static void add_pawn_moves(
+	const Board& board, Square from, color color, std::vector<LegalMove>& moves) {
+	const int forward{ color == color::white ? 1 : -1 };
+	const int start_rank{ color == color::white ? 1 : 6 };
+	const int last_rank{ color == color::white ? 7 : 0 };
+
+	const Square one_step{ from.get_offset(forward, 0) };
+	if (board.is_in_bounds(one_step) && !board.is_occupied(one_step)) {
+		add_move(moves, { color, from, one_step }, {}, one_step.get_rank() == last_rank);
+
+		const Square two_steps{ one_step.get_offset(forward, 0) };
+		if (from.get_rank() == start_rank && !board.is_occupied(two_steps))
+			add_move(moves, { color, from, two_steps }, { std::nullopt, one_step }, false);
+	}
+
+	const auto opponent{ get_opposing_color(color) };
+	for (const int file_step : { -1, 1 }) {
+		const Square to{ from.get_offset(forward, file_step) };
+		if (!board.is_in_bounds(to))
+			continue;
+
+		const auto piece{ board.get_piece(to) };
+		if (piece && piece->color == opponent) {
+			add_move(moves, { color, from, to }, { to }, to.get_rank() == last_rank);
+			continue;
+		}
+
+		// The pawn that just skipped over the target is taken.
+		const Square passed{ from.get_rank(), to.get_file() };
+		if (!piece && to == board.get_en_passant_target()
+			&& has_piece(board, passed, opponent, { piece_type::pawn }))
+			add_move(moves, { color, from, to }, { passed }, false);
+	}
+}
+
+// Knights and kings take one step, and sliders keep going until they run into
+// a piece.
+template <std::size_t Count>
+static void add_steps(const Board& board, Square from, color color,
+	const std::array<Step, Count>& steps, bool slides, std::vector<LegalMove>& moves) {
+	for (const auto& [ranks, files] : steps) {
+		for (Square to{ from.get_offset(ranks, files) }; board.is_in_bounds(to);
+			to = to.get_offset(ranks, files)) {
+			const auto piece{ board.get_piece(to) };
+			if (piece && piece->color == color)
+				break;
+
+			add_move(moves, { color, from, to },
+				{ piece ? std::optional{ to } : std::nullopt }, false);
+			if (piece || !slides)
+				break;
+		}
+	}
+}
+
+// The king ends on the c- or g-file and the rook next to it, on the d- or
+// f-file, wherever they started (so this covers Chess960 too). Only the king
+// and the rook may be on the squares that they cross or land on, and the king
+// can't castle out of, through, or into check.
+static void add_castling(
+	const Board& board, Square king, color color, std::vector<LegalMove>& moves) {
+	const int rank{ king.get_rank() };
+	if (rank != (color == color::white ? 0 : 7))
+		return;
+
+	for (const side side : { side::a_side, side::h_side }) {
+		const int step{ side == side::a_side ? -1 : 1 };
+		std::optional<Square> rook;
+		for (Square square{ king.get_offset(0, step) }; board.is_in_bounds(square);
+			square = square.get_offset(0, step)) {
+			const auto piece{ board.get_piece(square) };
+			if (piece && piece->type == piece_type::castleable_rook && piece->color == color) {
+				rook = square;
+				break;
+			}
+		}
+		if (!rook)
+			continue;
+
+		const Square king_to{ rank, side == side::a_side ? 2 : 6 };
+		const Square rook_to{ rank, side == side::a_side ? 3 : 5 };
+		const auto is_clear{ [&](Square from, Square to) {
+			const int first{ std::min(from.get_file(), to.get_file()) };
+			const int last{ std::max(from.get_file(), to.get_file()) };
+			for (int file{ first }; file <= last; file++) {
+				const Square square{ rank, file };
+				if (square != king && square != *rook && board.is_occupied(square))
+					return false;
+			}
+			return true;
+		} };
+		if (!is_clear(king, king_to) || !is_clear(*rook, rook_to))
+			continue;
+
+		const int first{ std::min(king.get_file(), king_to.get_file()) };
+		const int last{ std::max(king.get_file(), king_to.get_file()) };
+		bool is_safe{ true };
+		for (int file{ first }; file <= last && is_safe; file++)
+			is_safe = !is_attacked(board, { rank, file }, get_opposing_color(color));
+		if (!is_safe)
+			continue;
+
+		MoveDetails details;
+		details.castling = CastlingDetails{ *rook, rook_to, side };
+		moves.push_back({ { color, king, king_to }, details });
+	}
+}
+
+std::vector<LegalMove> generate_reference_moves(const Board& board, color active_color) {
+	std::vector<LegalMove> pseudo_legal;
+	for (const Square from : board) {
+		const auto piece{ board.get_piece(from) };
+		if (!piece || piece->color != active_color)
+			continue;
+
+		switch (get_base_type(piece->type)) {
+		case piece_type::pawn:
+			add_pawn_moves(board, from, active_color, pseudo_legal);
+			break;
+		case piece_type::knight:
+			add_steps(board, from, active_color, knight_steps, false, pseudo_legal);
+			break;
+		case piece_type::bishop:
+			add_steps(board, from, active_color, diagonal_steps, true, pseudo_legal);
+			break;
+		case piece_type::rook:
+			add_steps(board, from, active_color, orthogonal_steps, true, pseudo_legal);
+			break;
+		case piece_type::queen:
+			add_steps(board, from, active_color, orthogonal_steps, true, pseudo_legal);
+			add_steps(board, from, active_color, diagonal_steps, true, pseudo_legal);
+			break;
+		case piece_type::king:
+			add_steps(board, from, active_color, king_steps, false, pseudo_legal);
+			if (piece->type == piece_type::castleable_king)
+				add_castling(board, from, active_color, pseudo_legal);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Make each move on a copy and see if it left the king in check.
+	std::vector<LegalMove> moves;
+	for (const auto& legal_move : pseudo_legal) {
+		Board copy{ board };
+		copy.play(legal_move);
+		if (!is_in_check(copy, active_color))
+			moves.push_back(legal_move);
+	}
+	return moves;
+}
+
+static bool is_same_castling(
+	const std::optional<CastlingDetails>& a, const std::optional<CastlingDetails>& b) {
+	if (!a || !b)
+		return a.has_value() == b.has_value();
+	return a->secondary_from == b->secondary_from && a->secondary_to == b->secondary_to
+		&& a->side == b->side;
+}
+
+// Unlike `is_same_move`, this compares the details too, which the fast
+// generators must get exactly right.
+static bool is_identical(const LegalMove& a, const LegalMove& b) {
+	return a.move.active_color == b.move.active_color && a.move.from == b.move.from
+		&& a.move.to == b.move.to && a.details.captured_square == b.details.captured_square
+		&& a.details.en_passant_target == b.details.en_passant_target
+		&& a.details.promote_to == b.details.promote_to
+		&& is_same_castling(a.details.castling, b.details.castling);
+}
+
+static bool is_identical(const Board& a, const Board& b) {
+	if (a.get_en_passant_target() != b.get_en_passant_target()
+		|| a.get_variant() != b.get_variant())
+		return false;
+
+	for (const Square square : a) {
+		const auto piece_a{ a.get_piece(square) };
+		const auto piece_b{ b.get_piece(square) };
+		if (piece_a.has_value() != piece_b.has_value())
+			return false;
+		if (piece_a && (piece_a->type != piece_b->type || piece_a->color != piece_b->color))
+			return false;
+	}
+	return true;
+}
+
+// Each move of the reference must be matched by exactly one candidate.
+template <typename Moves>
+static std::optional<Discrepancy> compare_moves(const Board& board,
+	const std::vector<LegalMove>& reference, const Moves& candidates, const std::string& source) {
+	std::vector<bool> matched(reference.size(), false);
+	std::string extra;
+	for (const auto& candidate : candidates) {
+		bool found{ false };
+		for (std::size_t i{ 0 }; i < reference.size() && !found; i++) {
+			if (!matched[i] && is_identical(reference[i], candidate))
+				matched[i] = found = true;
+		}
+		if (!found)
+			extra += ' ' + format_coordinate_move(board, candidate);
+	}
+
+	std::string missing;
+	for (std::size_t i{ 0 }; i < reference.size(); i++) {
+		if (!matched[i])
+			missing += ' ' + format_coordinate_move(board, reference[i]);
+	}
+
+	if (missing.empty() && extra.empty())
+		return std::nullopt;
+
+	std::string description;
+	if (!missing.empty())
+		description += "missing" + missing;
+	if (!extra.empty())
+		description += (description.empty() ? "" : "; ") + ("extra" + extra);
+	return Discrepancy{ source, description };
+}
+
+static std::string get_mate_name(mate status) {
+	switch (status) {
+	case mate::no:
+		return "no mate";
+	case mate::checkmate:
+		return "checkmate";
+	case mate::stalemate:
+		return "stalemate";
+	}
+	return "unknown";
+}
+
+static std::optional<Discrepancy> check_legal_move_set(
+	const Board& board, color active_color, const std::vector<LegalMove>& reference) {
+	const LegalMoveSet set{ board, active_color };
+	std::vector<LegalMove> moves;
+	for (const Square from : board) {
+		for (const Square to : board) {
+			const Move move{ active_color, from, to };
+			for (const auto& details : set.get_moves(move))
+				moves.push_back({ move, details });
+		}
+	}
+	if (auto discrepancy{ compare_moves(board, reference, moves, "LegalMoveSet") })
+		return discrepancy;
+
+	const mate expected{ !reference.empty()     ? mate::no
+			: is_in_check(board, active_color) ? mate::checkmate
+											   : mate::stalemate };
+	if (set.get_status() != expected) {
+		return Discrepancy{ "LegalMoveSet",
+			"status is " + get_mate_name(set.get_status()) + " instead of "
+				+ get_mate_name(expected) };
+	}
+	return std::nullopt;
+}
+
+// `play` keeps no record for taking the move back, so it's the reference for
+// `make_move`, and the original board is the reference for `unmake_move`.
+static std::optional<Discrepancy> check_make_unmake(
+	const Board& board, const std::vector<LegalMove>& reference) {
+	Board scratch{ board };
+	for (const auto& legal_move : reference) {
+		Board expected{ board };
+		expected.play(legal_move);
+
+		const auto undo{ scratch.make_move(legal_move) };
+		const bool made{ is_identical(scratch, expected) };
+		scratch.unmake_move(undo);
+		if (!made)
+			return Discrepancy{ "Board::make_move", format_coordinate_move(board, legal_move) };
+		if (!is_identical(scratch, board))
+			return Discrepancy{ "Board::unmake_move", format_coordinate_move(board, legal_move) };
+	}
+	return std::nullopt;
+}
+
+// Every pair of squares is asked about, like a user interface would.
+static std::optional<Discrepancy> check_get_legal_moves(
+	const Board& board, color active_color, const std::vector<LegalMove>& reference) {
+	std::vector<LegalMove> moves;
+	for (const Square from : board) {
+		for (const Square to : board) {
+			const Move move{ active_color, from, to };
+			for (const auto& details : board.get_legal_moves(move))
+				moves.push_back({ move, details });
+		}
+	}
+	return compare_moves(board, reference, moves, "Board::get_legal_moves");
+}
+
+static std::string describe_squares(std::uint64_t squares) {
+	std::string names;
+	for (; squares != 0; squares &= squares - 1)
+		names += ' ' + Board::Geometry::get_square(find_lowest_bit(squares)).print();
+	return names;
+}
+
+static std::optional<Discrepancy> compare_attacks(
+	std::uint64_t expected, std::uint64_t actual, color attacker, const std::string& source) {
+	if (expected == actual)
+		return std::nullopt;
+
+	std::string description{ attacker == color::white ? "White" : "Black" };
+	description += " attacks";
+	if (const auto missing{ expected & ~actual })
+		description += ": missing" + describe_squares(missing);
+	if (const auto extra{ actual & ~expected })
+		description += ": extra" + describe_squares(extra);
+	return Discrepancy{ source, description };
+}
+
+// Every implementation of the attack maps (and the board's use of them) must
+// agree with walking the rays from each square.
+static std::optional<Discrepancy> check_attack_maps(const Board& board) {
+	std::array<AttackingPieces, 2> pieces{};
+	std::array<std::uint64_t, 2> expected{};
+	std::uint64_t occupied{ 0 };
+	for (const Square square : board) {
+		const std::uint64_t bit{ std::uint64_t{ 1 } << Board::Geometry::get_index(square) };
+		for (const color color : { color::black, color::white }) {
+			if (is_attacked(board, square, color))
+				expected[static_cast<std::size_t>(color)] |= bit;
+		}
+
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+
+		occupied |= bit;
+		auto& own{ pieces[static_cast<std::size_t>(piece->color)] };
+		const piece_type type{ get_base_type(piece->type) };
+		if (type == piece_type::pawn)
+			own.pawns |= bit;
+		if (type == piece_type::knight)
+			own.knights |= bit;
+		if (type == piece_type::bishop || type == piece_type::queen)
+			own.diagonal_sliders |= bit;
+		if (type == piece_type::rook || type == piece_type::queen)
+			own.orthogonal_sliders |= bit;
+		if (type == piece_type::king)
+			own.kings |= bit;
+	}
+
+	for (const auto implementation : { attack_implementation::scalar, attack_implementation::sse2,
+			 attack_implementation::avx2 }) {
+		if (!is_attack_implementation_supported(implementation))
+			continue;
+
+		const auto attacks{ compute_attack_maps(pieces, occupied, implementation) };
+		const std::string source{ std::string{ "compute_attack_maps (" }
+			+ get_attack_implementation_name(implementation) + ")" };
+		for (const color color : { color::black, color::white }) {
+			const auto index{ static_cast<std::size_t>(color) };
+			if (auto discrepancy{ compare_attacks(expected[index], attacks[index], color, source) })
+				return discrepancy;
+		}
+	}
+
+	for (const color color : { color::black, color::white }) {
+		const auto attacked{ board.get_attacked_squares(color).get_words()[0] };
+		const auto index{ static_cast<std::size_t>(color) };
+		if (auto discrepancy{
+				compare_attacks(expected[index], attacked, color, "Board::get_attacked_squares") })
+			return discrepancy;
+	}
+	return std::nullopt;
+}
+
+std::optional<Discrepancy> check_move_generators(const Board& board, color active_color) {
+	return check_move_generators(
+		board, active_color, generate_reference_moves(board, active_color));
+}
+
+std::optional<Discrepancy> check_move_generators(
+	const Board& board, color active_color, const std::vector<LegalMove>& reference) {
+	MoveList generated;
+	board.generate_legal_moves(active_color, generated);
+	const std::string generator{ "Board::generate_legal_moves" };
+	if (auto discrepancy{ compare_moves(board, reference, generated, generator) })
+		return discrepancy;
+
+	std::vector<LegalMove> picked;
+	MovePicker picker{ board, active_color };
+	while (const auto legal_move{ picker.next() })
+		picked.push_back(*legal_move);
+	if (auto discrepancy{ compare_moves(board, reference, picked, "MovePicker") })
+		return discrepancy;
+
+	if (auto discrepancy{ check_get_legal_moves(board, active_color, reference) })
+		return discrepancy;
+
+	if (auto discrepancy{ check_legal_move_set(board, active_color, reference) })
+		return discrepancy;
+
+	if (auto discrepancy{ check_attack_maps(board) })
+		return discrepancy;
+
+	return check_make_unmake(board, reference);
+}
+
+static std::array<Board::Rank, Board::Geometry::ranks> get_ranks(const Board& board) {
+	std::array<Board::Rank, Board::Geometry::ranks> ranks{};
+	for (const Square square : board)
+		ranks[square.get_rank()][square.get_file()] = board.get_piece(square);
+	return ranks;
+}
+
+// Every position that is one step simpler than `board`.
+static std::vector<Board> get_simplifications(const Board& board) {
+	const auto ranks{ get_ranks(board) };
+	std::vector<Board> boards;
+	if (board.is_in_bounds(board.get_en_passant_target()))
+		boards.emplace_back(ranks, Square{}, board.get_variant());
+
+	// The en passant target goes away with the pawn that skipped over it.
+	const Square target{ board.get_en_passant_target() };
+	const Square passed{ target.get_offset(target.get_rank() == 5 ? -1 : 1, 0) };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+
+		auto simpler{ ranks };
+		auto& simpler_piece{ simpler[square.get_rank()][square.get_file()] };
+		if (get_base_type(piece->type) != piece->type)
+			simpler_piece->make_uncastleable();
+		else if (!piece->is_king())
+			simpler_piece.reset();
+		else
+			continue;
+		boards.emplace_back(simpler, square == passed ? Square{} : target, board.get_variant());
+	}
+	return boards;
+}
+
+Board minimize_discrepancy(
+	const Board& board, color active_color, const Discrepancy& discrepancy) {
+	const color opponent{ get_opposing_color(active_color) };
+	Board smallest{ board };
+	for (bool simplified{ true }; simplified;) {
+		simplified = false;
+		for (const Board& simpler : get_simplifications(smallest)) {
+			if (is_in_check(simpler, opponent))
+				continue;
+
+			const auto found{ check_move_generators(simpler, active_color) };
+			if (found && found->source == discrepancy.source) {
+				smallest = simpler;
+				simplified = true;
+				break;
+			}
+		}
+	}
+	return smallest;
+}
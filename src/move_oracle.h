@@ -0,0 +1,47 @@
+// Author: Daniel Kareh
+// Summary: A slow but plain reference for the rules, and checks that compare
+//          the fast move generators (and make/unmake, and the attack maps)
+//          against it. The reference shares no code with the fast paths
+//          apart from `Board::play`. When they disagree, the position can be
+//          shrunk to a small reproducer.
+
+#ifndef CHESS_MOVE_ORACLE_H
+#define CHESS_MOVE_ORACLE_H
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "Board.h"
+
+// Every legal move, generated piece by piece straight from the rules. Each
+// move is made on a fresh copy of the board, which is then checked for an
+// attack on the king by walking out from it along every ray. None of the
+// engine's move generation or attack maps is used, so a bug in them can't
+// hide by showing up in the reference too. An en passant capture needs an
+// opposing pawn beside the capturing one.
+std::vector<LegalMove> generate_reference_moves(const Board&, color active_color);
+
+struct Discrepancy {
+	// What disagreed with the reference, like "MovePicker".
+	std::string source;
+	// How it disagreed, like "missing e5d6; extra e1c1".
+	std::string description;
+};
+
+// Compare `Board::generate_legal_moves`, `MovePicker`,
+// `Board::get_legal_moves`, `LegalMoveSet`, every supported implementation
+// of `compute_attack_maps`, `Board::get_attacked_squares`, and
+// `Board::make_move`/`unmake_move` with the reference in one position, and
+// return the first disagreement. The reference moves can be passed in if
+// they're already known.
+std::optional<Discrepancy> check_move_generators(const Board&, color active_color);
+std::optional<Discrepancy> check_move_generators(
+	const Board&, color active_color, const std::vector<LegalMove>& reference);
+
+// Make a position with a discrepancy smaller while it still has one (from
+// the same source): take away pieces other than the kings, castling rights,
+// and the en passant target, one at a time, as long as the player who just
+// moved isn't left in check.
+Board minimize_discrepancy(const Board&, color active_color, const Discrepancy&);
+
+#endif
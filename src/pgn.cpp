@@ -0,0 +1,290 @@
+// Author: Daniel Kareh
+// Summary: A streaming reader and a writer for Portable Game Notation (PGN).
+//          The reader walks over text in place (usually a memory-mapped
+//          file) and yields one game at a time, so the size of a database
+//          doesn't affect how much memory is used.
+//          See https://www.saremba.de/chessgml/standards/pgn/pgn-complete.htm
+
+#include "pgn.h"
+#include "fen.h"
+#include "san.h"
+
+static const std::size_t max_line_length{ 79 };
+
+static bool is_space(char ch) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; }
+
+static bool is_result(std::string_view token) {
+	return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// Return the index just past the end of a line (or the end of the text).
+static std::size_t skip_line(std::string_view text, std::size_t position) {
+	const std::size_t end{ text.find('\n', position) };
+	return end == std::string_view::npos ? text.size() : end + 1;
+}
+
+// Return the index just past a comment that starts with '{'.
+static std::size_t skip_brace_comment(std::string_view text, std::size_t position) {
+	const std::size_t end{ text.find('}', position) };
+	return end == std::string_view::npos ? text.size() : end + 1;
+}
+
+// Return the index just past a variation that starts with '('. Variations
+// can be nested and can contain comments.
+static std::size_t skip_variation(std::string_view text, std::size_t position) {
+	int depth{ 0 };
+	while (position < text.size()) {
+		const char ch{ text[position] };
+		if (ch == '{') {
+			position = skip_brace_comment(text, position);
+			continue;
+		}
+		if (ch == ';') {
+			position = skip_line(text, position);
+			continue;
+		}
+
+		position++;
+		if (ch == '(')
+			depth++;
+		else if (ch == ')' && --depth == 0)
+			break;
+	}
+	return position;
+}
+
+static bool is_line_start(std::string_view text, std::size_t position) {
+	return position == 0 || text[position - 1] == '\n';
+}
+
+std::optional<std::string_view> PgnGame::get_tag(std::string_view name) const {
+	for (const auto& tag : tags) {
+		if (tag.name == name)
+			return tag.value;
+	}
+	return std::nullopt;
+}
+
+bool PgnReader::next(PgnGame& game) {
+	game.tags.clear();
+	game.movetext = {};
+
+	// Skip a UTF-8 byte order mark.
+	if (position == 0 && text.substr(0, 3) == "\xEF\xBB\xBF")
+		position = 3;
+
+	// Read the tag pairs, like '[Event "F/S Return Match"]'.
+	for (;;) {
+		while (position < text.size() && is_space(text[position]))
+			position++;
+
+		if (position == text.size())
+			return false;
+
+		if (text[position] == '%' && is_line_start(text, position)) {
+			position = skip_line(text, position);
+			continue;
+		}
+
+		if (text[position] != '[')
+			break;
+
+		const std::size_t name_start{ position + 1 };
+		const std::size_t name_end{ text.find_first_of(" \t\"]", name_start) };
+		const std::size_t quote{ text.find('"', name_start) };
+		const std::size_t line_end{ skip_line(text, position) };
+		if (name_end == std::string_view::npos || quote == std::string_view::npos
+			|| quote >= line_end) {
+			// This tag is malformed, so ignore it.
+			position = line_end;
+			continue;
+		}
+
+		std::size_t value_end{ quote + 1 };
+		while (value_end < text.size() && text[value_end] != '"' && text[value_end] != '\n')
+			value_end += text[value_end] == '\\' ? 2 : 1;
+		value_end = std::min(value_end, text.size());
+
+		game.tags.push_back({ text.substr(name_start, name_end - name_start),
+			text.substr(quote + 1, value_end - quote - 1) });
+		const std::size_t close{ text.find(']', value_end) };
+		position = close == std::string_view::npos ? text.size() : close + 1;
+	}
+
+	// Read the movetext up to and including the game termination marker.
+	const std::size_t start{ position };
+	while (position < text.size()) {
+		const char ch{ text[position] };
+		if (ch == '{') {
+			position = skip_brace_comment(text, position);
+		} else if (ch == ';') {
+			position = skip_line(text, position);
+		} else if (ch == '(') {
+			position = skip_variation(text, position);
+		} else if (ch == '[' && is_line_start(text, position)) {
+			// The next game started without a termination marker.
+			break;
+		} else if (is_space(ch)) {
+			position++;
+		} else {
+			std::size_t end{ position };
+			while (end < text.size() && !is_space(text[end]) && text[end] != '{'
+				&& text[end] != '(' && text[end] != ';')
+				end++;
+
+			const std::string_view token{ text.substr(position, end - position) };
+			position = end;
+			if (is_result(token))
+				break;
+		}
+	}
+
+	game.movetext = text.substr(start, position - start);
+	return true;
+}
+
+std::optional<std::string_view> PgnMoveTokenizer::next() {
+	while (position < movetext.size()) {
+		const char ch{ movetext[position] };
+		if (is_space(ch) || ch == ')') {
+			position++;
+			continue;
+		}
+		if (ch == '{') {
+			position = skip_brace_comment(movetext, position);
+			continue;
+		}
+		if (ch == ';') {
+			position = skip_line(movetext, position);
+			continue;
+		}
+		if (ch == '(') {
+			position = skip_variation(movetext, position);
+			continue;
+		}
+
+		std::size_t end{ position };
+		while (end < movetext.size() && !is_space(movetext[end]) && movetext[end] != '{'
+			&& movetext[end] != '(' && movetext[end] != ')' && movetext[end] != ';')
+			end++;
+
+		std::string_view token{ movetext.substr(position, end - position) };
+		position = end;
+		if (is_result(token))
+			return std::nullopt;
+
+		// Skip numeric annotation glyphs like '$1'.
+		if (token[0] == '$')
+			continue;
+
+		// Remove move numbers like '12.' and '12...', even if they're
+		// attached to the move itself (like '12.Nf3').
+		const std::size_t dot{ token.find('.') };
+		if ('0' <= token[0] && token[0] <= '9' && dot != std::string_view::npos) {
+			token.remove_prefix(dot);
+			while (!token.empty() && token[0] == '.')
+				token.remove_prefix(1);
+		}
+
+		if (!token.empty())
+			return token;
+	}
+	return std::nullopt;
+}
+
+std::optional<PgnStartingPosition> get_starting_position(const PgnGame& game) {
+	const auto fen{ game.get_tag("FEN") };
+	if (!fen)
+		return PgnStartingPosition{};
+
+	const auto position{ parse_fen(unescape_pgn_string(*fen)) };
+	if (!position)
+		return std::nullopt;
+	return PgnStartingPosition{ position->board, position->active_color,
+		position->fullmove_number };
+}
+
+std::optional<std::vector<LegalMove>> replay_pgn_game(const PgnGame& game) {
+	auto start{ get_starting_position(game) };
+	if (!start)
+		return std::nullopt;
+
+	Board& board{ start->board };
+	color active_color{ start->active_color };
+	std::vector<LegalMove> moves;
+	PgnMoveTokenizer tokenizer{ game.movetext };
+	while (const auto token{ tokenizer.next() }) {
+		const auto legal_move{ parse_san(*token, board, active_color) };
+		if (!legal_move)
+			return std::nullopt;
+
+		board.play(*legal_move);
+		moves.push_back(*legal_move);
+		active_color = get_opposing_color(active_color);
+	}
+	return moves;
+}
+
+std::string unescape_pgn_string(std::string_view escaped) {
+	std::string string;
+	string.reserve(escaped.size());
+	for (std::size_t i{ 0 }; i < escaped.size(); i++) {
+		if (escaped[i] == '\\' && i + 1 < escaped.size())
+			i++;
+		string += escaped[i];
+	}
+	return string;
+}
+
+static std::string escape_pgn_string(std::string_view string) {
+	std::string escaped;
+	for (const char ch : string) {
+		if (ch == '\\' || ch == '"')
+			escaped += '\\';
+		escaped += ch;
+	}
+	return escaped;
+}
+
+// Add a token to the movetext, starting a new line if it wouldn't fit.
+static void append_token(std::string& output, std::size_t& line_length, std::string_view token) {
+	if (line_length > 0 && line_length + 1 + token.size() > max_line_length) {
+		output += '\n';
+		line_length = 0;
+	} else if (line_length > 0) {
+		output += ' ';
+		line_length++;
+	}
+	output += token;
+	line_length += token.size();
+}
+
+void write_pgn_game(std::string& output, const std::vector<PgnWriterTag>& tags,
+	const PgnStartingPosition& start, const std::vector<LegalMove>& moves,
+	std::string_view result) {
+	for (const auto& tag : tags)
+		output += '[' + tag.name + " \"" + escape_pgn_string(tag.value) + "\"]\n";
+	output += '\n';
+
+	Board board{ start.board };
+	int fullmove_number{ start.fullmove_number };
+	std::size_t line_length{ 0 };
+	for (std::size_t i{ 0 }; i < moves.size(); i++) {
+		// Keep move numbers on the same line as their moves.
+		const color active_color{ moves[i].move.active_color };
+		std::string token;
+		if (active_color == color::white)
+			token = std::to_string(fullmove_number) + ". ";
+		else if (i == 0)
+			token = std::to_string(fullmove_number) + "... ";
+
+		token += format_san(board, moves[i]);
+		append_token(output, line_length, token);
+		board.play(moves[i]);
+		if (active_color == color::black)
+			fullmove_number++;
+	}
+
+	append_token(output, line_length, result);
+	output += "\n\n";
+}
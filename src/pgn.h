@@ -0,0 +1,87 @@
+// Author: Daniel Kareh
+// Summary: A streaming reader and a writer for Portable Game Notation (PGN).
+//          The reader walks over text in place (usually a memory-mapped
+//          file) and yields one game at a time, so the size of a database
+//          doesn't affect how much memory is used.
+
+#ifndef CHESS_PGN_H
+#define CHESS_PGN_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Board.h"
+
+struct PgnTag {
+	std::string_view name;
+	// The value as written in the file, without quotes but with any escape
+	// sequences still in place. See `unescape_pgn_string`.
+	std::string_view value;
+};
+
+// A game whose strings all point into the text that the reader walks over.
+struct PgnGame {
+	std::optional<std::string_view> get_tag(std::string_view name) const;
+
+	std::vector<PgnTag> tags;
+	// Everything after the tags, including move numbers, comments, and the result.
+	std::string_view movetext;
+};
+
+class PgnReader {
+public:
+	// The text must outlive the reader and every game that it returns.
+	explicit PgnReader(std::string_view text)
+		: text{ text } {}
+
+	// Read the next game into `game`, reusing its memory.
+	// Return false once there are no more games.
+	bool next(PgnGame& game);
+
+private:
+	std::string_view text;
+	std::size_t position{ 0 };
+};
+
+// Split movetext into SAN moves, skipping move numbers, comments, variations,
+// numeric annotation glyphs, and the result.
+class PgnMoveTokenizer {
+public:
+	explicit PgnMoveTokenizer(std::string_view movetext)
+		: movetext{ movetext } {}
+
+	// Return `std::nullopt` after the last move.
+	std::optional<std::string_view> next();
+
+private:
+	std::string_view movetext;
+	std::size_t position{ 0 };
+};
+
+struct PgnStartingPosition {
+	Board board;
+	color active_color{ color::white };
+	int fullmove_number{ 1 };
+};
+
+// Use the 'FEN' tag if there is one, and the standard starting position otherwise.
+std::optional<PgnStartingPosition> get_starting_position(const PgnGame&);
+
+// Play every move of a game. Return `std::nullopt` if a move is invalid.
+std::optional<std::vector<LegalMove>> replay_pgn_game(const PgnGame&);
+
+std::string unescape_pgn_string(std::string_view);
+
+struct PgnWriterTag {
+	std::string name;
+	std::string value;
+};
+
+// Append a complete game to `output`. The Seven Tag Roster should come first
+// in `tags`. If the game didn't start from the standard position, include
+// 'SetUp' and 'FEN' tags.
+void write_pgn_game(std::string& output, const std::vector<PgnWriterTag>& tags,
+	const PgnStartingPosition& start, const std::vector<LegalMove>& moves,
+	std::string_view result);
+
+#endif
@@ -0,0 +1,252 @@
+// Author: Daniel Kareh
+// Summary: A reader for opening books in the Polyglot format. Books are
+//          memory-mapped and searched in place, so even very large books
+//          are never copied into the heap.
+//          See http://hgm.nubati.net/book_format.html for the format.
+
+#include "polyglot.h"
+#include <stdexcept> // For std::runtime_error.
+
+// Every entry is 16 bytes: a 64-bit key, a 16-bit move, a 16-bit weight,
+// and a 32-bit learning value. All of them are big-endian.
+static const std::size_t entry_size{ 16 };
+
+// The offsets into the random numbers for each part of a position.
+static const std::size_t castling_offset{ 768 };
+static const std::size_t en_passant_offset{ 772 };
+static const std::size_t turn_offset{ 780 };
+
+// This is the key of the starting position according to the specification.
+static const std::uint64_t starting_position_key{ 0x463B96181691FC9C };
+
+template <typename T>
+static T read_big_endian(const unsigned char* bytes) {
+	T value{ 0 };
+	for (std::size_t i{ 0 }; i < sizeof(T); i++)
+		value = static_cast<T>(value << 8 | bytes[i]);
+	return value;
+}
+
+static int convert_hex_digit(char ch) {
+	if ('0' <= ch && ch <= '9')
+		return ch - '0';
+	if ('a' <= ch && ch <= 'f')
+		return ch - 'a' + 10;
+	if ('A' <= ch && ch <= 'F')
+		return ch - 'A' + 10;
+	return -1;
+}
+
+PolyglotKeys PolyglotKeys::load(const std::string& path) {
+	const MappedFile file{ path };
+	const std::string_view text{ file.view() };
+
+	// Collect every hexadecimal literal (like '0x9D39247E33776D41') in the file.
+	PolyglotKeys keys;
+	std::size_t count{ 0 };
+	for (std::size_t i{ 0 }; i + 2 < text.size(); i++) {
+		if (text[i] != '0' || (text[i + 1] != 'x' && text[i + 1] != 'X'))
+			continue;
+
+		std::uint64_t number{ 0 };
+		std::size_t end{ i + 2 };
+		for (; end < text.size() && convert_hex_digit(text[end]) >= 0; end++)
+			number = number << 4 | static_cast<std::uint64_t>(convert_hex_digit(text[end]));
+
+		if (end == i + 2)
+			continue;
+
+		if (count == keys.randoms.size())
+			throw std::runtime_error{ path + " contains more than 781 numbers" };
+
+		keys.randoms[count++] = number;
+		i = end - 1;
+	}
+
+	if (count != keys.randoms.size())
+		throw std::runtime_error{ path + " contains fewer than 781 numbers" };
+
+	if (keys.hash(Board{}, color::white) != starting_position_key)
+		throw std::runtime_error{ path + " does not contain the Polyglot random numbers" };
+
+	return keys;
+}
+
+// Polyglot orders pieces as "black pawn, white pawn, black knight, ...".
+static std::size_t get_piece_kind(Piece piece) {
+	std::size_t kind{ 0 };
+	switch (piece.type) {
+	case piece_type::pawn:
+		kind = 0;
+		break;
+	case piece_type::knight:
+		kind = 1;
+		break;
+	case piece_type::bishop:
+		kind = 2;
+		break;
+	case piece_type::rook:
+	case piece_type::castleable_rook:
+		kind = 3;
+		break;
+	case piece_type::queen:
+		kind = 4;
+		break;
+	case piece_type::king:
+	case piece_type::castleable_king:
+		kind = 5;
+		break;
+	default:
+		throw std::invalid_argument{ "Invalid piece type" };
+	}
+	return kind * 2 + (piece.is_white() ? 1 : 0);
+}
+
+// A player may castle if their king and a rook on the correct side of the
+// king have both never moved.
+static bool has_castling_right(const Board& board, color color, side side) {
+	const int home_rank{ color == color::black ? board.get_dimensions().get_rank() - 1 : 0 };
+	std::optional<int> king_file;
+	for (int file{ 0 }; file < board.get_dimensions().get_file(); file++) {
+		const auto piece{ board.get_piece({ home_rank, file }) };
+		if (piece && piece->type == piece_type::castleable_king && piece->color == color)
+			king_file = file;
+	}
+
+	if (!king_file.has_value())
+		return false;
+
+	const int step{ side == side::a_side ? -1 : 1 };
+	for (Square current{ home_rank, *king_file + step }; board.is_in_bounds(current);
+		current = current.get_offset(0, step)) {
+		const auto piece{ board.get_piece(current) };
+		if (piece && piece->type == piece_type::castleable_rook && piece->color == color)
+			return true;
+	}
+	return false;
+}
+
+// Polyglot only hashes the en passant file if a pawn of the active player
+// could actually make the capture (ignoring whether it would be legal).
+static bool en_passant_is_possible(const Board& board, color active_color) {
+	const Square target{ board.get_en_passant_target() };
+	if (board.is_out_of_bounds(target))
+		return false;
+
+	// The pawn that skipped over the target is one rank closer to the active player.
+	const int pawn_rank{ target.get_rank() + (active_color == color::white ? -1 : 1) };
+	for (const int file : { target.get_file() - 1, target.get_file() + 1 }) {
+		const Square square{ pawn_rank, file };
+		if (board.is_out_of_bounds(square))
+			continue;
+
+		const auto piece{ board.get_piece(square) };
+		if (piece && piece->type == piece_type::pawn && piece->color == active_color)
+			return true;
+	}
+	return false;
+}
+
+std::uint64_t PolyglotKeys::hash(const Board& board, color active_color) const {
+	std::uint64_t key{ 0 };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (piece) {
+			const std::size_t offset{ 64 * get_piece_kind(*piece) + 8 * square.get_rank()
+				+ square.get_file() };
+			key ^= randoms.at(offset);
+		}
+	}
+
+	if (has_castling_right(board, color::white, side::h_side))
+		key ^= randoms[castling_offset + 0];
+	if (has_castling_right(board, color::white, side::a_side))
+		key ^= randoms[castling_offset + 1];
+	if (has_castling_right(board, color::black, side::h_side))
+		key ^= randoms[castling_offset + 2];
+	if (has_castling_right(board, color::black, side::a_side))
+		key ^= randoms[castling_offset + 3];
+
+	if (en_passant_is_possible(board, active_color))
+		key ^= randoms.at(en_passant_offset + board.get_en_passant_target().get_file());
+
+	if (active_color == color::white)
+		key ^= randoms[turn_offset];
+
+	return key;
+}
+
+OpeningBook::OpeningBook(const std::string& path)
+	: file{ path }
+	, entry_count{ file.size() / entry_size } {
+	if (file.size() % entry_size != 0)
+		throw std::runtime_error{ path + " is not a Polyglot book" };
+}
+
+std::uint64_t OpeningBook::key_at(std::size_t index) const {
+	return read_big_endian<std::uint64_t>(file.data() + index * entry_size);
+}
+
+static std::optional<piece_type> decode_promotion(unsigned bits) {
+	switch (bits) {
+	case 1:
+		return piece_type::knight;
+	case 2:
+		return piece_type::bishop;
+	case 3:
+		return piece_type::rook;
+	case 4:
+		return piece_type::queen;
+	default:
+		return std::nullopt;
+	}
+}
+
+static BookMove decode_move(const unsigned char* entry, const Board& board, color active_color) {
+	const auto raw{ read_big_endian<std::uint16_t>(entry + 8) };
+	const Square to{ raw >> 3 & 7, raw & 7 };
+	const Square from{ raw >> 9 & 7, raw >> 6 & 7 };
+
+	BookMove book_move{
+		Move{ active_color, from, to },
+		decode_promotion(raw >> 12 & 7),
+		read_big_endian<std::uint16_t>(entry + 10),
+		read_big_endian<std::uint32_t>(entry + 12),
+	};
+
+	// Polyglot encodes castling as "the king captures its own rook", but we
+	// describe castling by where the king ends up.
+	const auto king{ board.get_piece(from) };
+	const auto rook{ board.get_piece(to) };
+	if (king && rook && king->is_king() && rook->is_rook() && king->color == rook->color) {
+		const char file{ to.get_file() < from.get_file() ? 'c' : 'g' };
+		const char rank{ active_color == color::black ? '8' : '1' };
+		book_move.move.to = Square::from_chars(file, rank);
+	}
+
+	return book_move;
+}
+
+std::vector<BookMove> OpeningBook::find(
+	const PolyglotKeys& keys, const Board& board, color active_color) const {
+	return find(keys.hash(board, active_color), board, active_color);
+}
+
+std::vector<BookMove> OpeningBook::find(
+	std::uint64_t key, const Board& board, color active_color) const {
+	// Entries are sorted by key, so binary search for the first matching one.
+	std::size_t low{ 0 };
+	std::size_t high{ entry_count };
+	while (low < high) {
+		const std::size_t middle{ low + (high - low) / 2 };
+		if (key_at(middle) < key)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	std::vector<BookMove> moves;
+	for (std::size_t index{ low }; index < entry_count && key_at(index) == key; index++)
+		moves.push_back(decode_move(file.data() + index * entry_size, board, active_color));
+	return moves;
+}
@@ -0,0 +1,62 @@
+// Author: Daniel Kareh
+// Summary: A reader for opening books in the Polyglot format. Books are
+//          memory-mapped and searched in place, so even very large books
+//          are never copied into the heap.
+//          See http://hgm.nubati.net/book_format.html for the format.
+
+#ifndef CHESS_POLYGLOT_H
+#define CHESS_POLYGLOT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "MappedFile.h"
+
+// The 781 random numbers that Polyglot hashes positions with.
+//
+// NOTE: The numbers are loaded at runtime instead of being compiled in.
+// Any text file containing the numbers as C-style hexadecimal literals works,
+// such as "random.c" from the Polyglot sources or a copy of the table from
+// the book format specification.
+class PolyglotKeys {
+public:
+	// Throws `std::runtime_error` if the file doesn't contain exactly 781
+	// numbers or if the numbers are not the standard Polyglot numbers.
+	static PolyglotKeys load(const std::string& path);
+
+	std::uint64_t hash(const Board&, color active_color) const;
+
+private:
+	std::array<std::uint64_t, 781> randoms{};
+};
+
+struct BookMove {
+	Move move;
+	std::optional<piece_type> promote_to;
+	std::uint16_t weight;
+	std::uint32_t learn;
+};
+
+class OpeningBook {
+public:
+	// Throws `std::runtime_error` if the file cannot be mapped or is not a
+	// whole number of book entries.
+	explicit OpeningBook(const std::string& path);
+
+	std::size_t size() const { return entry_count; }
+
+	// Return every move that the book suggests for a position, in the order
+	// that they appear in the book (which is usually highest weight first).
+	std::vector<BookMove> find(const PolyglotKeys&, const Board&, color active_color) const;
+	std::vector<BookMove> find(std::uint64_t key, const Board&, color active_color) const;
+
+private:
+	std::uint64_t key_at(std::size_t index) const;
+
+	MappedFile file;
+	std::size_t entry_count;
+};
+
+#endif
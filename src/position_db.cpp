@@ -0,0 +1,351 @@
+// Author: Daniel Kareh
+// Summary: A compact fixed-width encoding of positions, and a database of
+//          positions that is looked up straight out of a memory-mapped file.
+//          The file has a hash index by Zobrist key, so a lookup reads one
+//          or two slots and one record, and every process that opens the
+//          same database shares its pages.
+//
+// File format (all numbers are little-endian):
+//   8 bytes     The magic string "CPPCHPD2".
+//   8 bytes     The number of positions, N.
+//   8 bytes     The number of index slots, S (a power of two, at least 2N).
+//   8 bytes     Zero.
+//   S*16 bytes  The index. Each slot has a Zobrist key (8 bytes), the number
+//               of the position's record (4 bytes), and how many times the
+//               position appeared (4 bytes). Empty slots are all zeros. A
+//               position is found by linear probing from slot `key % S`.
+//   N*32 bytes  The packed positions, in order of their keys.
+
+#include "position_db.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio> // For std::fopen, std::fwrite.
+#include <cstring> // For std::memcmp.
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include "zobrist.h"
+
+static_assert(Board::Geometry::square_count == 64, "Packed positions assume an 8x8 board");
+
+static const std::string_view magic{ "CPPCHPD2" };
+static const std::size_t header_size{ 32 };
+static const std::size_t slot_size{ 16 };
+static const std::size_t record_size{ sizeof(PackedPosition) };
+
+static const std::size_t pieces_offset{ 8 };
+static const std::size_t flags_offset{ 24 };
+static const std::size_t halfmove_offset{ 25 };
+static const std::size_t fullmove_offset{ 26 };
+
+static const unsigned black_to_move_flag{ 1 };
+static const unsigned en_passant_shift{ 1 };
+static const unsigned chess960_flag{ 1 << 5 };
+
+template <typename T>
+static void write_little_endian(unsigned char* bytes, T value) {
+	for (std::size_t i{ 0 }; i < sizeof(T); i++)
+		bytes[i] = static_cast<unsigned char>(static_cast<std::uint64_t>(value) >> (8 * i) & 0xFF);
+}
+
+template <typename T>
+static T read_little_endian(const unsigned char* bytes) {
+	std::uint64_t value{ 0 };
+	for (std::size_t i{ 0 }; i < sizeof(T); i++)
+		value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+	return static_cast<T>(value);
+}
+
+bool PackedPosition::is_same_position(const PackedPosition& other) const {
+	return std::memcmp(bytes.data(), other.bytes.data(), identity_size) == 0;
+}
+
+std::optional<PackedPosition> pack_position(const FenPosition& position) {
+	const Board& board{ position.board };
+	PackedPosition packed;
+	std::uint64_t occupied{ 0 };
+	std::size_t piece_count{ 0 };
+	for (int index{ 0 }; index < Board::Geometry::square_count; index++) {
+		const auto piece{ board.get_piece(Board::Geometry::get_square(index)) };
+		if (!piece)
+			continue;
+		if (piece_count == 32)
+			return std::nullopt;
+
+		const unsigned nibble{ static_cast<unsigned>(piece->color) << 3
+			| static_cast<unsigned>(piece->type) };
+		auto& byte{ packed.bytes[pieces_offset + piece_count / 2] };
+		byte = static_cast<unsigned char>(byte | nibble << (4 * (piece_count % 2)));
+		occupied |= std::uint64_t{ 1 } << index;
+		piece_count++;
+	}
+	write_little_endian(packed.bytes.data(), occupied);
+
+	unsigned flags{ 0 };
+	if (position.active_color == color::black)
+		flags |= black_to_move_flag;
+	// A target that no pawn can use doesn't make a different position.
+	if (board.can_capture_en_passant(position.active_color)) {
+		const Square target{ board.get_en_passant_target() };
+		flags |= static_cast<unsigned>(target.get_file() + 1) << en_passant_shift;
+	}
+	if (board.get_variant() == variant::chess960)
+		flags |= chess960_flag;
+	packed.bytes[flags_offset] = static_cast<unsigned char>(flags);
+
+	packed.bytes[halfmove_offset]
+		= static_cast<unsigned char>(std::clamp(position.halfmove_clock, 0, 255));
+	write_little_endian(packed.bytes.data() + fullmove_offset,
+		static_cast<std::uint16_t>(std::clamp(position.fullmove_number, 0, 65535)));
+	return packed;
+}
+
+FenPosition unpack_position(const PackedPosition& packed) {
+	std::array<Board::Rank, Board::Geometry::ranks> ranks{};
+	auto occupied{ read_little_endian<std::uint64_t>(packed.bytes.data()) };
+	for (std::size_t piece_count{ 0 }; occupied != 0; occupied &= occupied - 1, piece_count++) {
+		const int index{ find_lowest_bit(occupied) };
+		const unsigned byte{ packed.bytes[pieces_offset + piece_count / 2] };
+		const unsigned nibble{ byte >> (4 * (piece_count % 2)) & 0xF };
+		const Square square{ Board::Geometry::get_square(index) };
+		ranks[square.get_rank()][square.get_file()]
+			= Piece{ static_cast<piece_type>(nibble & 7), static_cast<color>(nibble >> 3) };
+	}
+
+	const unsigned flags{ packed.bytes[flags_offset] };
+	const color active_color{ flags & black_to_move_flag ? color::black : color::white };
+	Square en_passant_target{};
+	if (const unsigned file{ flags >> en_passant_shift & 0xF }; file != 0) {
+		// The target is the square that the pawn that just moved skipped over.
+		en_passant_target = { active_color == color::white ? 5 : 2, static_cast<int>(file) - 1 };
+	}
+	const variant variant{ flags & chess960_flag ? variant::chess960 : variant::classical };
+
+	return FenPosition{
+		Board{ ranks, en_passant_target, variant },
+		active_color,
+		packed.bytes[halfmove_offset],
+		read_little_endian<std::uint16_t>(packed.bytes.data() + fullmove_offset),
+	};
+}
+
+PositionDatabase::PositionDatabase(const std::string& path)
+	: file{ path } {
+	const std::string_view view{ file.view() };
+	if (view.size() < header_size || view.substr(0, magic.size()) != magic)
+		throw std::runtime_error{ path + " is not a position database" };
+
+	position_count = read_little_endian<std::uint64_t>(file.data() + 8);
+	slot_count = read_little_endian<std::uint64_t>(file.data() + 16);
+	const bool is_power_of_two{ slot_count != 0 && (slot_count & (slot_count - 1)) == 0 };
+	if (!is_power_of_two || slot_count <= position_count)
+		throw std::runtime_error{ path + " has an invalid index" };
+	if (view.size() != header_size + slot_count * slot_size + position_count * record_size)
+		throw std::runtime_error{ path + " has the wrong size" };
+}
+
+std::optional<PositionRecord> PositionDatabase::find(const Board& board, color active_color) const {
+	const auto packed{ pack_position({ board, active_color }) };
+	if (!packed)
+		return std::nullopt;
+
+	// The index is never more than half full, so probing always reaches an
+	// empty slot.
+	const std::uint64_t key{ zobrist_hash(board, active_color) };
+	const unsigned char* index{ file.data() + header_size };
+	for (std::size_t slot{ key & (slot_count - 1) };; slot = (slot + 1) & (slot_count - 1)) {
+		const unsigned char* entry{ index + slot * slot_size };
+		const auto count{ read_little_endian<std::uint32_t>(entry + 12) };
+		if (count == 0)
+			return std::nullopt;
+		if (read_little_endian<std::uint64_t>(entry) != key)
+			continue;
+
+		// Different positions can share a key, so compare the records too.
+		const auto record_index{ read_little_endian<std::uint32_t>(entry + 8) };
+		if (record_index >= position_count)
+			continue;
+		const PackedPosition record{ get_packed_position(record_index) };
+		if (record.is_same_position(*packed))
+			return PositionRecord{ unpack_position(record), count };
+	}
+}
+
+PackedPosition PositionDatabase::get_packed_position(std::size_t index) const {
+	PackedPosition packed;
+	const unsigned char* records{ file.data() + header_size + slot_count * slot_size };
+	std::copy_n(records + index * record_size, record_size, packed.bytes.begin());
+	return packed;
+}
+
+struct KeyedPosition {
+	std::uint64_t key;
+	PackedPosition packed;
+};
+
+static bool operator<(const KeyedPosition& a, const KeyedPosition& b) {
+	if (a.key != b.key)
+		return a.key < b.key;
+	return std::memcmp(a.packed.bytes.data(), b.packed.bytes.data(), PackedPosition::identity_size)
+		< 0;
+}
+
+// What one thread found in its share of the input.
+struct ParsedChunk {
+	std::vector<KeyedPosition> positions;
+	std::size_t lines{ 0 };
+	std::size_t invalid_lines{ 0 };
+};
+
+// Split text into about `count` pieces that end at line breaks.
+static std::vector<std::string_view> split_lines(std::string_view text, std::size_t count) {
+	std::vector<std::string_view> chunks;
+	const std::size_t target_size{ text.size() / std::max<std::size_t>(count, 1) + 1 };
+	while (!text.empty()) {
+		const std::size_t line_end{ text.find('\n', std::min(target_size, text.size() - 1)) };
+		const std::size_t size{ line_end == std::string_view::npos ? text.size() : line_end + 1 };
+		chunks.push_back(text.substr(0, size));
+		text.remove_prefix(size);
+	}
+	return chunks;
+}
+
+static void parse_chunk(std::string_view text, ParsedChunk& parsed) {
+	while (!text.empty()) {
+		const std::size_t line_end{ std::min(text.find('\n'), text.size()) };
+		std::string_view line{ text.substr(0, line_end) };
+		text.remove_prefix(std::min(line_end + 1, text.size()));
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		if (line.empty())
+			continue;
+
+		parsed.lines++;
+		const auto position{ parse_fen(line) };
+		const auto packed{ position ? pack_position(*position) : std::nullopt };
+		if (!packed) {
+			parsed.invalid_lines++;
+			continue;
+		}
+		parsed.positions.push_back(
+			{ zobrist_hash(position->board, position->active_color), *packed });
+	}
+	std::sort(parsed.positions.begin(), parsed.positions.end());
+}
+
+// Merge sorted runs pairwise until one is left.
+static std::vector<KeyedPosition> merge_runs(std::vector<std::vector<KeyedPosition>> runs) {
+	if (runs.empty())
+		return {};
+
+	while (runs.size() > 1) {
+		std::vector<std::vector<KeyedPosition>> merged;
+		for (std::size_t i{ 0 }; i + 1 < runs.size(); i += 2) {
+			std::vector<KeyedPosition> both;
+			both.reserve(runs[i].size() + runs[i + 1].size());
+			std::merge(runs[i].begin(), runs[i].end(), runs[i + 1].begin(), runs[i + 1].end(),
+				std::back_inserter(both));
+			merged.push_back(std::move(both));
+		}
+		if (runs.size() % 2 == 1)
+			merged.push_back(std::move(runs.back()));
+		runs = std::move(merged);
+	}
+	return std::move(runs.front());
+}
+
+static void write_database(const std::string& output, const std::vector<KeyedPosition>& positions,
+	const std::vector<std::uint32_t>& counts) {
+	const std::size_t position_count{ counts.size() };
+	std::size_t slot_count{ 2 };
+	while (slot_count < 2 * position_count)
+		slot_count *= 2;
+
+	std::vector<unsigned char> header(header_size, 0);
+	std::copy(magic.begin(), magic.end(), header.begin());
+	write_little_endian(header.data() + 8, static_cast<std::uint64_t>(position_count));
+	write_little_endian(header.data() + 16, static_cast<std::uint64_t>(slot_count));
+
+	std::vector<unsigned char> index(slot_count * slot_size, 0);
+	std::vector<unsigned char> records;
+	records.reserve(position_count * record_size);
+	for (std::size_t i{ 0 }; i < position_count; i++) {
+		const auto& [key, packed]{ positions[i] };
+		std::size_t slot{ key & (slot_count - 1) };
+		while (read_little_endian<std::uint32_t>(&index[slot * slot_size + 12]) != 0)
+			slot = (slot + 1) & (slot_count - 1);
+		write_little_endian(&index[slot * slot_size], key);
+		write_little_endian(&index[slot * slot_size + 8], static_cast<std::uint32_t>(i));
+		write_little_endian(&index[slot * slot_size + 12], counts[i]);
+		records.insert(records.end(), packed.bytes.begin(), packed.bytes.end());
+	}
+
+	std::FILE* file{ std::fopen(output.c_str(), "wb") };
+	if (file == nullptr)
+		throw std::runtime_error{ "Cannot write " + output };
+
+	bool ok{ std::fwrite(header.data(), 1, header.size(), file) == header.size() };
+	ok = ok && std::fwrite(index.data(), 1, index.size(), file) == index.size();
+	ok = ok && std::fwrite(records.data(), 1, records.size(), file) == records.size();
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok)
+		throw std::runtime_error{ "Cannot write " + output };
+}
+
+PositionDatabaseStats build_position_database(const std::vector<std::string>& inputs,
+	const std::string& output, unsigned thread_count) {
+	thread_count = std::max(thread_count, 1U);
+	PositionDatabaseStats stats;
+	std::vector<std::vector<KeyedPosition>> runs;
+	for (const auto& input : inputs) {
+		const MappedFile file{ input };
+		file.advise_sequential();
+
+		// Threads take chunks in turn, so a thread that gets short lines
+		// doesn't sit idle. Each chunk is parsed and sorted on its own.
+		const auto chunks{ split_lines(file.view(), std::size_t{ thread_count } * 4) };
+		std::vector<ParsedChunk> parsed(chunks.size());
+		std::atomic<std::size_t> next_chunk{ 0 };
+		const auto work{ [&] {
+			for (std::size_t i{ next_chunk++ }; i < chunks.size(); i = next_chunk++)
+				parse_chunk(chunks[i], parsed[i]);
+		} };
+
+		std::vector<std::thread> threads;
+		for (unsigned i{ 1 }; i < thread_count; i++)
+			threads.emplace_back(work);
+		work();
+		for (auto& thread : threads)
+			thread.join();
+
+		for (auto& chunk : parsed) {
+			stats.lines += chunk.lines;
+			stats.invalid_lines += chunk.invalid_lines;
+			runs.push_back(std::move(chunk.positions));
+		}
+	}
+
+	// Keep one copy of each position (with its move counters), and count
+	// the copies.
+	auto positions{ merge_runs(std::move(runs)) };
+	std::vector<std::uint32_t> counts;
+	std::size_t unique{ 0 };
+	for (std::size_t i{ 0 }; i < positions.size(); i++) {
+		const bool is_repeat{ unique != 0 && positions[unique - 1].key == positions[i].key
+			&& positions[unique - 1].packed.is_same_position(positions[i].packed) };
+		if (is_repeat) {
+			if (counts.back() != UINT32_MAX)
+				counts.back()++;
+			continue;
+		}
+		positions[unique++] = positions[i];
+		counts.push_back(1);
+	}
+	positions.resize(unique);
+	if (unique > UINT32_MAX)
+		throw std::runtime_error{ "Too many positions for one database" };
+
+	write_database(output, positions, counts);
+	stats.unique_positions = unique;
+	return stats;
+}
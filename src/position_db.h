@@ -0,0 +1,83 @@
+// Author: Daniel Kareh
+// Summary: A compact fixed-width encoding of positions, and a database of
+//          positions that is looked up straight out of a memory-mapped file.
+//          The file has a hash index by Zobrist key, so a lookup reads one
+//          or two slots and one record, and every process that opens the
+//          same database shares its pages.
+
+#ifndef CHESS_POSITION_DB_H
+#define CHESS_POSITION_DB_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "fen.h"
+
+// A position packed into 32 bytes:
+//   8 bytes   Which squares are occupied, bit `rank * 8 + file` (little-endian).
+//   16 bytes  One nibble per occupied square, in the same order: the color
+//             (high bit) and the piece type (low three bits). Castling rights
+//             are part of the piece types.
+//   1 byte    Bit 0: Black is to move. Bits 1-4: the en passant file plus
+//             one, or zero. Bit 5: the board uses the Chess960 castling rules.
+//   1 byte    The halfmove clock (at most 255).
+//   2 bytes   The fullmove number (little-endian, at most 65535).
+//   4 bytes   Zero. (chess-selfplay keeps a score and a game result here.)
+// The first 25 bytes identify the position; the rest are its move counters.
+struct PackedPosition {
+	static constexpr std::size_t identity_size{ 25 };
+
+	bool is_same_position(const PackedPosition& other) const;
+
+	std::array<unsigned char, 32> bytes{};
+};
+
+static_assert(sizeof(PackedPosition) == 32, "Packed positions are 32 bytes");
+
+// Return `std::nullopt` if the position has more than 32 pieces.
+std::optional<PackedPosition> pack_position(const FenPosition&);
+FenPosition unpack_position(const PackedPosition&);
+
+struct PositionRecord {
+	FenPosition position;
+	// How many times the position appeared in the input.
+	std::uint32_t count;
+};
+
+class PositionDatabase {
+public:
+	// Throws `std::runtime_error` if the file cannot be mapped or isn't a
+	// position database.
+	explicit PositionDatabase(const std::string& path);
+
+	std::size_t size() const { return position_count; }
+
+	// Look up a position, ignoring its move counters. Return `std::nullopt`
+	// if it isn't in the database.
+	std::optional<PositionRecord> find(const Board&, color active_color) const;
+
+	// The positions are stored in order of their keys.
+	PackedPosition get_packed_position(std::size_t index) const;
+
+private:
+	MappedFile file;
+	std::size_t position_count;
+	std::size_t slot_count;
+};
+
+struct PositionDatabaseStats {
+	std::size_t lines{ 0 };
+	std::size_t invalid_lines{ 0 };
+	std::size_t unique_positions{ 0 };
+};
+
+// Read FEN or EPD records (one per line) from every input file, using several
+// threads, and write a database of the distinct positions to `output`.
+// Throws `std::runtime_error` if a file cannot be read or written.
+PositionDatabaseStats build_position_database(const std::vector<std::string>& inputs,
+	const std::string& output, unsigned thread_count);
+
+#endif
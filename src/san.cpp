@@ -0,0 +1,247 @@
+// Author: Daniel Kareh
+// Summary: Functions to read and write moves in Standard Algebraic Notation
+//          (SAN), such as 'Nbd7', 'exd6', 'e8=Q+', and 'O-O-O', and in
+//          coordinate notation, such as 'g1f3' and 'e7e8q'.
+
+#include "san.h"
+
+static std::string_view remove_suffixes(std::string_view san) {
+	while (!san.empty()) {
+		const char last{ san.back() };
+		if (last != '+' && last != '#' && last != '!' && last != '?')
+			break;
+		san.remove_suffix(1);
+	}
+	return san;
+}
+
+static bool is_same_type(Piece piece, piece_type type) {
+	return get_base_type(piece.type) == get_base_type(type);
+}
+
+static std::optional<LegalMove> parse_castling(side side, const Board& board, color active_color) {
+	const Square king{ board.find_king(active_color) };
+	if (board.is_out_of_bounds(king))
+		return std::nullopt;
+
+	// The king always ends up on the c-file or g-file, even in Chess960.
+	const Square to{ king.get_rank(), side == side::a_side ? 2 : 6 };
+	const Move move{ active_color, king, to };
+	for (const auto& details : board.get_legal_moves(move)) {
+		if (details.castling && details.castling->side == side)
+			return LegalMove{ move, details };
+	}
+	return std::nullopt;
+}
+
+std::optional<LegalMove> parse_san(std::string_view san, const Board& board, color active_color) {
+	san = remove_suffixes(san);
+	if (san == "O-O" || san == "0-0")
+		return parse_castling(side::h_side, board, active_color);
+	if (san == "O-O-O" || san == "0-0-0")
+		return parse_castling(side::a_side, board, active_color);
+
+	if (san.size() < 2)
+		return std::nullopt;
+
+	// Pieces other than pawns begin with an uppercase letter.
+	piece_type type{ piece_type::pawn };
+	if (san[0] == 'N' || san[0] == 'B' || san[0] == 'R' || san[0] == 'Q' || san[0] == 'K') {
+		type = convert_letter_to_piece_type(san[0]).value_or(piece_type::pawn);
+		san.remove_prefix(1);
+	}
+
+	// Promotions end with the new piece, usually after an equals sign.
+	std::optional<piece_type> promote_to;
+	if (type == piece_type::pawn && san.size() >= 3) {
+		const auto promotion{ convert_letter_to_piece_type(san.back()) };
+		if (promotion && *promotion != piece_type::pawn && *promotion != piece_type::king) {
+			promote_to = promotion;
+			san.remove_suffix(1);
+			if (san.back() == '=')
+				san.remove_suffix(1);
+		}
+	}
+
+	if (san.size() < 2)
+		return std::nullopt;
+
+	const auto to{ Square::parse(san.substr(san.size() - 2)) };
+	if (!to)
+		return std::nullopt;
+	san.remove_suffix(2);
+
+	// Whatever is left describes where the piece came from (and whether it
+	// captured something, but that doesn't need to be checked).
+	std::optional<int> from_file;
+	std::optional<int> from_rank;
+	for (const char ch : san) {
+		if ('a' <= ch && ch <= 'h')
+			from_file = ch - 'a';
+		else if ('1' <= ch && ch <= '8')
+			from_rank = ch - '1';
+		else if (ch != 'x' && ch != ':' && ch != '-')
+			return std::nullopt;
+	}
+
+	std::optional<LegalMove> found;
+	for (const Square from : board) {
+		if ((from_file && from.get_file() != *from_file)
+			|| (from_rank && from.get_rank() != *from_rank))
+			continue;
+
+		const auto piece{ board.get_piece(from) };
+		if (!piece || piece->color != active_color || !is_same_type(*piece, type))
+			continue;
+
+		const Move move{ active_color, from, *to };
+		for (const auto& details : board.get_legal_moves(move)) {
+			if (details.castling || details.promote_to != promote_to)
+				continue;
+
+			// Two different moves match, so the string is ambiguous.
+			if (found)
+				return std::nullopt;
+			found = LegalMove{ move, details };
+		}
+	}
+	return found;
+}
+
+// Does a piece like the moving piece, but on another square, have a legal
+// move to the same destination? Return the squares of all such pieces.
+static std::vector<Square> find_rivals(const Board& board, const Move& move, Piece piece) {
+	std::vector<Square> rivals;
+	for (const Square other : board) {
+		if (other == move.from)
+			continue;
+
+		const auto rival{ board.get_piece(other) };
+		if (!rival || rival->color != piece.color || !is_same_type(*rival, piece.type))
+			continue;
+
+		for (const auto& details : board.get_legal_moves({ move.active_color, other, move.to })) {
+			if (!details.castling) {
+				rivals.push_back(other);
+				break;
+			}
+		}
+	}
+	return rivals;
+}
+
+static std::string format_disambiguation(const Board& board, const Move& move, Piece piece) {
+	const auto rivals{ find_rivals(board, move, piece) };
+	if (rivals.empty())
+		return "";
+
+	bool file_is_shared{ false };
+	bool rank_is_shared{ false };
+	for (const Square rival : rivals) {
+		file_is_shared = file_is_shared || rival.get_file() == move.from.get_file();
+		rank_is_shared = rank_is_shared || rival.get_rank() == move.from.get_rank();
+	}
+
+	// Prefer the file, then the rank, then both.
+	if (!file_is_shared)
+		return { move.from.get_file_letter() };
+	if (!rank_is_shared)
+		return { move.from.get_rank_digit() };
+	return move.from.print();
+}
+
+static std::string format_check(const Board& board, const LegalMove& legal_move) {
+	Board after{ board };
+	after.play(legal_move);
+
+	const color opponent{ get_opposing_color(legal_move.move.active_color) };
+	if (!after.piece_is_under_attack(after.find_king(opponent)))
+		return "";
+	return after.get_all_legal_moves(opponent).empty() ? "#" : "+";
+}
+
+std::string format_san(const Board& board, const LegalMove& legal_move) {
+	const auto& [move, details]{ legal_move };
+	if (details.castling) {
+		const bool is_a_side{ details.castling->side == side::a_side };
+		return (is_a_side ? "O-O-O" : "O-O") + format_check(board, legal_move);
+	}
+
+	const Piece piece{ board.get_piece(move.from).value_or(Piece{}) };
+	std::string san;
+	if (piece.type == piece_type::pawn) {
+		if (details.captured_square)
+			san += move.from.get_file_letter();
+	} else {
+		san += convert_piece_type_to_letter(piece.type);
+		san += format_disambiguation(board, move, piece);
+	}
+
+	if (details.captured_square)
+		san += 'x';
+	san += move.to.print();
+
+	if (details.promote_to) {
+		san += '=';
+		san += convert_piece_type_to_letter(*details.promote_to);
+	}
+
+	return san + format_check(board, legal_move);
+}
+
+std::optional<LegalMove> parse_coordinate_move(
+	std::string_view string, const Board& board, color active_color) {
+	if (string.size() != 4 && string.size() != 5)
+		return std::nullopt;
+
+	const auto from{ Square::parse(string.substr(0, 2)) };
+	const auto to{ Square::parse(string.substr(2, 2)) };
+	if (!from || !to)
+		return std::nullopt;
+
+	std::optional<piece_type> promote_to;
+	if (string.size() == 5) {
+		promote_to = convert_letter_to_piece_type(string[4]);
+		if (!promote_to)
+			return std::nullopt;
+	}
+
+	// A king that "captures" its own rook is castling with that rook. The
+	// king always ends up on the c-file or the g-file.
+	const auto king{ board.get_piece(*from) };
+	const auto rook{ board.get_piece(*to) };
+	if (king && rook && king->type == piece_type::castleable_king
+		&& rook->type == piece_type::castleable_rook && rook->color == king->color) {
+		const int file{ to->get_file() < from->get_file() ? 2 : 6 };
+		const Move move{ active_color, *from, Square{ from->get_rank(), file } };
+		for (const auto& details : board.get_legal_moves(move)) {
+			if (details.castling && details.castling->secondary_from == *to)
+				return LegalMove{ move, details };
+		}
+		return std::nullopt;
+	}
+
+	// A king that moves one square might also be castling in Chess960, so
+	// prefer the ordinary move.
+	const Move move{ active_color, *from, *to };
+	std::optional<LegalMove> found;
+	for (const auto& details : board.get_legal_moves(move)) {
+		const bool is_queen{ details.promote_to == piece_type::queen };
+		if (details.promote_to != promote_to && (promote_to || !is_queen))
+			continue;
+		if (!found || found->details.castling)
+			found = LegalMove{ move, details };
+	}
+	return found;
+}
+
+std::string format_coordinate_move(const Board& board, const LegalMove& legal_move) {
+	const auto& [move, details]{ legal_move };
+	if (details.castling && board.get_legal_moves(move).size() > 1)
+		return move.from.print() + details.castling->secondary_from.print();
+
+	std::string string{ move.from.print() + move.to.print() };
+	if (details.promote_to)
+		string += safe_to_lower(convert_piece_type_to_letter(*details.promote_to));
+	return string;
+}
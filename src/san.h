@@ -0,0 +1,33 @@
+// Author: Daniel Kareh
+// Summary: Functions to read and write moves in Standard Algebraic Notation
+//          (SAN), such as 'Nbd7', 'exd6', 'e8=Q+', and 'O-O-O', and in
+//          coordinate notation, such as 'g1f3' and 'e7e8q'.
+
+#ifndef CHESS_SAN_H
+#define CHESS_SAN_H
+
+#include <string>
+#include <string_view>
+#include "Board.h"
+
+// Find the legal move that a SAN string describes. Check and annotation
+// suffixes (like '+', '#', '!?') are ignored. Castling is written 'O-O' or
+// 'O-O-O' (or with zeros), which also works in Chess960.
+// Return `std::nullopt` if the string is invalid, illegal, or ambiguous.
+std::optional<LegalMove> parse_san(std::string_view, const Board&, color active_color);
+
+// The board must be the position *before* the move is played.
+std::string format_san(const Board&, const LegalMove&);
+
+// Find the legal move that a coordinate string describes. Castling is written
+// as the king's move (like 'e1g1') or as the king capturing its own rook
+// (like 'e1h1'). Promotions without a piece letter promote to a queen.
+// Return `std::nullopt` if the string is invalid or illegal.
+std::optional<LegalMove> parse_coordinate_move(std::string_view, const Board&, color active_color);
+
+// The board must be the position *before* the move is played. Castling is
+// written as the king's move, unless the king could also move to the same
+// square without castling (which happens in Chess960).
+std::string format_coordinate_move(const Board&, const LegalMove&);
+
+#endif
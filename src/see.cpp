@@ -0,0 +1,149 @@
+// Author: Daniel Kareh
+// Summary: Static exchange evaluation (SEE), which works out how much material
+//          a move wins or loses if both sides keep capturing on its target
+//          square, cheapest piece first, for as long as it pays. No moves are
+//          made on the board, so it's cheap enough for move ordering.
+
+#include "see.h"
+#include <algorithm>
+#include <array>
+#include "Search.h"
+#include "throw_if_empty.h"
+
+using Geometry = Board::Geometry;
+
+// A king is worth more than everything else, so the exchange never ends
+// with one being captured: whoever would have to capture with the king
+// while the square is still defended stops instead.
+static int get_exchange_value(piece_type type) {
+	return get_base_type(type) == piece_type::king ? 100000 : get_piece_value(type);
+}
+
+struct Offset {
+	int rank, file;
+};
+
+static const std::array<Offset, 8> knight_offsets{ {
+	{ 1, 2 },
+	{ 2, 1 },
+	{ 2, -1 },
+	{ 1, -2 },
+	{ -1, -2 },
+	{ -2, -1 },
+	{ -2, 1 },
+	{ -1, 2 },
+} };
+
+// The first four are diagonal and the rest are orthogonal.
+static const std::array<Offset, 8> directions{ {
+	{ 1, 1 },
+	{ 1, -1 },
+	{ -1, 1 },
+	{ -1, -1 },
+	{ 1, 0 },
+	{ -1, 0 },
+	{ 0, 1 },
+	{ 0, -1 },
+} };
+
+// Find the least valuable piece of one color that attacks `target`. Only the
+// pieces still in `occupied` take part, and only they block sliders, so the
+// attackers are found afresh after every capture.
+static std::optional<Square> find_least_valuable_attacker(
+	const Board& board, const Geometry::Set& occupied, Square target, color side) {
+	std::optional<Square> best;
+	int best_value{ 0 };
+	const auto consider{ [&](Square square, bool (*can_attack)(piece_type)) {
+		if (!Geometry::is_in_bounds(square) || !occupied.contains(square))
+			return;
+		const Piece piece{ throw_if_empty(board.get_piece(square)) };
+		if (piece.color != side || !can_attack(get_base_type(piece.type)))
+			return;
+		const int value{ get_exchange_value(piece.type) };
+		if (!best || value < best_value) {
+			best = square;
+			best_value = value;
+		}
+	} };
+
+	// Pawns attack diagonally forward, so they're found diagonally behind.
+	const int pawn_direction{ side == color::white ? 1 : -1 };
+	for (const int file : { target.get_file() - 1, target.get_file() + 1 }) {
+		consider({ target.get_rank() - pawn_direction, file },
+			[](piece_type type) { return type == piece_type::pawn; });
+	}
+
+	for (const auto& offset : knight_offsets) {
+		consider(target.get_offset(offset.rank, offset.file),
+			[](piece_type type) { return type == piece_type::knight; });
+	}
+
+	for (std::size_t i{ 0 }; i < directions.size(); i++) {
+		const auto& offset{ directions[i] };
+		const Square adjacent{ target.get_offset(offset.rank, offset.file) };
+		consider(adjacent, [](piece_type type) { return type == piece_type::king; });
+
+		// Only the first piece along each line can attack; the pieces behind
+		// it are x-rays until it leaves.
+		Square current{ adjacent };
+		while (Geometry::is_in_bounds(current) && !occupied.contains(current)) {
+			current = current.get_offset(offset.rank, offset.file);
+		}
+		if (i < 4) {
+			consider(current, [](piece_type type) {
+				return type == piece_type::bishop || type == piece_type::queen;
+			});
+		} else {
+			consider(current, [](piece_type type) {
+				return type == piece_type::rook || type == piece_type::queen;
+			});
+		}
+	}
+	return best;
+}
+
+int evaluate_exchange(const Board& board, const LegalMove& legal_move) {
+	const auto& [move, details]{ legal_move };
+	if (details.castling)
+		return 0;
+
+	// `gains[i]` is what the side making the i-th capture has gained so far,
+	// if the exchange stopped right after it.
+	std::array<int, Geometry::square_count + 1> gains{};
+	gains[0] = 0;
+
+	auto occupied{ board.get_occupied_squares() };
+	if (details.captured_square) {
+		gains[0]
+			= get_exchange_value(throw_if_empty(board.get_piece(*details.captured_square)).type);
+		// An en passant capture removes a pawn from another square.
+		occupied.erase(*details.captured_square);
+	}
+
+	int on_target{ get_exchange_value(throw_if_empty(board.get_piece(move.from)).type) };
+	if (details.promote_to) {
+		const int promoted{ get_exchange_value(*details.promote_to) };
+		gains[0] += promoted - on_target;
+		on_target = promoted;
+	}
+	occupied.erase(move.from);
+
+	int depth{ 0 };
+	color side{ get_opposing_color(move.active_color) };
+	for (;;) {
+		const auto attacker{ find_least_valuable_attacker(board, occupied, move.to, side) };
+		if (!attacker)
+			break;
+
+		depth++;
+		gains[depth] = on_target - gains[depth - 1];
+		on_target = get_exchange_value(throw_if_empty(board.get_piece(*attacker)).type);
+		occupied.erase(*attacker);
+		side = get_opposing_color(side);
+	}
+
+	// Each side only makes its capture if that beats stopping before it.
+	for (; depth > 0; depth--)
+		gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+	return gains[0];
+}
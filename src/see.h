@@ -0,0 +1,19 @@
+// Author: Daniel Kareh
+// Summary: Static exchange evaluation (SEE), which works out how much material
+//          a move wins or loses if both sides keep capturing on its target
+//          square, cheapest piece first, for as long as it pays. No moves are
+//          made on the board, so it's cheap enough for move ordering.
+
+#ifndef CHESS_SEE_H
+#define CHESS_SEE_H
+
+#include "Board.h"
+
+// Return the material that the mover gains (or loses, if negative) in
+// centipawns, using the values from `get_piece_value`. Either side may stop
+// capturing whenever going on would cost it. Sliders lined up behind other
+// attackers (x-rays) join in once the pieces in front have captured. Pins
+// are ignored. The move must be legal for this exact position.
+int evaluate_exchange(const Board&, const LegalMove&);
+
+#endif
@@ -0,0 +1,405 @@
+// Author: Daniel Kareh
+// Summary: A single-threaded server that hosts many games at once. Clients
+//          connect over TCP or a Unix domain socket and send one command per
+//          line. An epoll event loop handles every connection, so an idle
+//          game costs only its memory.
+
+#include "GameServer.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring> // For std::strerror.
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../chess960.h"
+#include "../fen.h"
+#include "../san.h"
+
+// A client that sends this much without a newline is misbehaving.
+static const std::size_t max_line_length{ 4096 };
+
+// Once this much output waits for a client, stop reading its commands until
+// it catches up, so a client that never reads can't use up the server's
+// memory. (Its commands wait in the socket, and TCP slows the client down.)
+static const std::size_t max_pending_output{ 64 * 1024 };
+
+[[noreturn]] static void throw_system_error(const std::string& what) {
+	throw std::runtime_error{ what + ": " + std::strerror(errno) };
+}
+
+static int open_listener(int domain, const sockaddr* address, socklen_t length) {
+	const int descriptor{ socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0) };
+	if (descriptor < 0)
+		throw_system_error("socket");
+
+	const int enable{ 1 };
+	if (domain == AF_INET)
+		setsockopt(descriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof enable);
+
+	if (bind(descriptor, address, length) < 0 || listen(descriptor, SOMAXCONN) < 0) {
+		const int error{ errno };
+		close(descriptor);
+		errno = error;
+		throw_system_error("Could not listen");
+	}
+	return descriptor;
+}
+
+int listen_on_tcp_port(const std::string& host, int port) {
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(static_cast<std::uint16_t>(port));
+	if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+		throw std::runtime_error{ "Invalid IPv4 address: " + host };
+	return open_listener(AF_INET, reinterpret_cast<const sockaddr*>(&address), sizeof address);
+}
+
+int listen_on_unix_socket(const std::string& path) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof address.sun_path)
+		throw std::runtime_error{ "Socket path is too long: " + path };
+	std::copy(path.begin(), path.end(), address.sun_path);
+
+	// Remove a socket left behind by an earlier server.
+	unlink(path.c_str());
+	return open_listener(AF_UNIX, reinterpret_cast<const sockaddr*>(&address), sizeof address);
+}
+
+// The resident set size of this process, in kibibytes.
+static long get_resident_set_size() {
+	std::ifstream status{ "/proc/self/status" };
+	std::string name;
+	while (status >> name) {
+		if (name == "VmRSS:") {
+			long kibibytes{ 0 };
+			status >> kibibytes;
+			return kibibytes;
+		}
+		status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	}
+	return 0;
+}
+
+static const char* get_status_name(mate status, bool in_check) {
+	if (status == mate::checkmate)
+		return "checkmate";
+	if (status == mate::stalemate)
+		return "stalemate";
+	return in_check ? "check" : "playing";
+}
+
+static std::optional<std::uint32_t> parse_id(std::string_view string) {
+	if (string.empty() || string.size() > 9)
+		return std::nullopt;
+
+	std::uint32_t id{ 0 };
+	for (const char c : string) {
+		if (c < '0' || c > '9')
+			return std::nullopt;
+		id = id * 10 + static_cast<std::uint32_t>(c - '0');
+	}
+	return id;
+}
+
+// Split off the first space-separated word of `line`.
+static std::string_view next_word(std::string_view& line) {
+	const auto start{ std::min(line.find_first_not_of(' '), line.size()) };
+	line.remove_prefix(start);
+	const auto end{ std::min(line.find(' '), line.size()) };
+	const auto word{ line.substr(0, end) };
+	line.remove_prefix(end);
+	return word;
+}
+
+GameServer::GameServer(int listener)
+	: listener{ listener }
+	, epoll{ epoll_create1(EPOLL_CLOEXEC) } {
+	if (epoll < 0)
+		throw_system_error("epoll_create1");
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = listener;
+	if (epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) < 0)
+		throw_system_error("epoll_ctl");
+}
+
+GameServer::~GameServer() {
+	for (const auto& [descriptor, connection] : connections)
+		close(descriptor);
+	close(epoll);
+	close(listener);
+}
+
+void GameServer::run() {
+	std::array<epoll_event, 256> events;
+	for (;;) {
+		const int count{ epoll_wait(epoll, events.data(), static_cast<int>(events.size()), -1) };
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			throw_system_error("epoll_wait");
+		}
+
+		for (int i{ 0 }; i < count; i++) {
+			const auto& event{ events[static_cast<std::size_t>(i)] };
+			const int descriptor{ event.data.fd };
+			if (descriptor == listener) {
+				accept_connections();
+				continue;
+			}
+
+			// An earlier event in this batch may have closed the connection.
+			const auto found{ connections.find(descriptor) };
+			if (found == connections.end())
+				continue;
+
+			handle_events(descriptor, found->second);
+		}
+	}
+}
+
+void GameServer::accept_connections() {
+	for (;;) {
+		const int descriptor{ accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC) };
+		if (descriptor < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				return;
+			// Running out of descriptors shouldn't stop the server.
+			if (errno == EMFILE || errno == ENFILE || errno == ECONNABORTED)
+				return;
+			throw_system_error("accept4");
+		}
+
+		// Responses are small and latency matters more than throughput.
+		// (This fails harmlessly on Unix domain sockets.)
+		const int enable{ 1 };
+		setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof enable);
+
+		epoll_event event{};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.fd = descriptor;
+		if (epoll_ctl(epoll, EPOLL_CTL_ADD, descriptor, &event) < 0) {
+			close(descriptor);
+			continue;
+		}
+		Connection connection;
+		connection.events = event.events;
+		connections.emplace(descriptor, std::move(connection));
+	}
+}
+
+// Reading, writing, and hanging up are all handled here, since writing can
+// let commands that were put on hold go ahead.
+void GameServer::handle_events(int descriptor, Connection& connection) {
+	std::array<char, 16384> buffer;
+	bool disconnected{ false };
+	for (;;) {
+		execute_lines(descriptor, connection);
+		if (connection.output.size() >= max_pending_output) {
+			// If the client has caught up, keep going.
+			if (!flush(descriptor, connection))
+				return;
+			if (connection.output.size() >= max_pending_output)
+				break;
+			continue;
+		}
+
+		// Leave the rest in the socket until the input can be used.
+		if (connection.closing || connection.input.size() > max_line_length)
+			break;
+
+		const auto received{ recv(descriptor, buffer.data(), buffer.size(), 0) };
+		if (received > 0) {
+			connection.input.append(buffer.data(), static_cast<std::size_t>(received));
+			continue;
+		}
+		if (received < 0 && errno == EINTR)
+			continue;
+		disconnected = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+		break;
+	}
+
+	if (flush(descriptor, connection) && disconnected)
+		close_connection(descriptor);
+}
+
+void GameServer::execute_lines(int descriptor, Connection& connection) {
+	std::size_t start{ 0 };
+	while (!connection.closing && connection.output.size() < max_pending_output) {
+		const auto end{ connection.input.find('\n', start) };
+		if (end == std::string::npos) {
+			if (connection.input.size() - start > max_line_length)
+				connection.closing = true;
+			break;
+		}
+
+		std::string_view line{ connection.input.data() + start, end - start };
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		start = end + 1;
+
+		connection.output += execute(descriptor, connection, line);
+	}
+	connection.input.erase(0, start);
+}
+
+bool GameServer::flush(int descriptor, Connection& connection) {
+	std::size_t sent_total{ 0 };
+	while (sent_total < connection.output.size()) {
+		const auto sent{ send(descriptor, connection.output.data() + sent_total,
+			connection.output.size() - sent_total, MSG_NOSIGNAL) };
+		if (sent < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			close_connection(descriptor);
+			return false;
+		}
+		sent_total += static_cast<std::size_t>(sent);
+	}
+	connection.output.erase(0, sent_total);
+
+	if (connection.output.empty() && connection.closing) {
+		close_connection(descriptor);
+		return false;
+	}
+
+	// Only ask for EPOLLOUT while there is something left to send, or every
+	// idle connection would wake the event loop. Events are level-triggered,
+	// so stop asking for input while it would be left unread.
+	std::uint32_t events{ 0 };
+	if (!connection.closing && connection.output.size() < max_pending_output)
+		events |= EPOLLIN | EPOLLRDHUP;
+	if (!connection.output.empty())
+		events |= EPOLLOUT;
+	if (events != connection.events) {
+		epoll_event event{};
+		event.events = events;
+		event.data.fd = descriptor;
+		epoll_ctl(epoll, EPOLL_CTL_MOD, descriptor, &event);
+		connection.events = events;
+	}
+	return true;
+}
+
+void GameServer::close_connection(int descriptor) {
+	const auto found{ connections.find(descriptor) };
+	if (found == connections.end())
+		return;
+
+	for (const auto id : found->second.game_ids)
+		sessions.erase(id);
+
+	// Closing the descriptor also removes it from the epoll set.
+	close(descriptor);
+	connections.erase(found);
+}
+
+std::string GameServer::execute(int descriptor, Connection& connection, std::string_view line) {
+	const auto command{ next_word(line) };
+	if (command.empty())
+		return "";
+
+	if (command == "new")
+		return create_game(descriptor, connection, next_word(line));
+
+	if (command == "stats")
+		return describe_statistics();
+
+	if (command == "quit") {
+		connection.closing = true;
+		return "";
+	}
+
+	if (command != "move" && command != "status" && command != "close")
+		return "error unknown command\n";
+
+	const auto id{ parse_id(next_word(line)) };
+	const auto session{ id ? sessions.find(*id) : sessions.end() };
+	if (session == sessions.end() || session->second.owner != descriptor)
+		return "error unknown game\n";
+
+	if (command == "move")
+		return move(*id, next_word(line));
+	if (command == "status")
+		return describe(*id);
+	return close_game(connection, *id);
+}
+
+std::string GameServer::create_game(
+	int descriptor, Connection& connection, std::string_view variant) {
+	Board board;
+	if (variant == "chess960")
+		board = generate_chess960_board();
+	else if (!variant.empty() && variant != "classical")
+		return "error unknown variant\n";
+
+	const std::uint32_t id{ next_game_id++ };
+	sessions.emplace(id, Session{ Game{ board }, mate::no, false, descriptor });
+	connection.game_ids.push_back(id);
+	return "ok " + std::to_string(id) + '\n';
+}
+
+std::string GameServer::move(std::uint32_t id, std::string_view string) {
+	Session& session{ sessions.at(id) };
+	if (session.status != mate::no)
+		return "error game over\n";
+
+	Game& game{ session.game };
+	const auto legal_move{
+		parse_coordinate_move(string, game.get_board(), game.get_active_color())
+	};
+	if (!legal_move)
+		return "illegal\n";
+
+	// The details were already chosen when the string was parsed.
+	const auto choose_move{ [&legal_move](const std::vector<MoveDetails>& choices) {
+		const auto& chosen{ legal_move->details };
+		for (std::size_t i{ 0 }; i < choices.size(); i++) {
+			const bool is_castling{ choices[i].castling.has_value() };
+			if (choices[i].promote_to == chosen.promote_to
+				&& is_castling == chosen.castling.has_value())
+				return static_cast<int>(i);
+		}
+		return 0;
+	} };
+	game.play(legal_move->move, choose_move);
+
+	session.status = game.get_status();
+	session.in_check = game.is_in_check();
+	return std::string{ "ok " } + get_status_name(session.status, session.in_check) + '\n';
+}
+
+std::string GameServer::describe(std::uint32_t id) const {
+	const Session& session{ sessions.at(id) };
+	const Game& game{ session.game };
+	const char* color_name{ game.get_active_color() == color::white ? "white" : "black" };
+	return std::string{ "ok " } + color_name + ' '
+		+ get_status_name(session.status, session.in_check) + ' '
+		+ format_fen(game.get_board(), game.get_active_color()) + '\n';
+}
+
+std::string GameServer::close_game(Connection& connection, std::uint32_t id) {
+	sessions.erase(id);
+	auto& ids{ connection.game_ids };
+	ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+	return "ok\n";
+}
+
+std::string GameServer::describe_statistics() const {
+	return "ok games=" + std::to_string(sessions.size()) + " connections="
+		+ std::to_string(connections.size()) + " rss_kb=" + std::to_string(get_resident_set_size())
+		+ '\n';
+}
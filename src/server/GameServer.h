@@ -0,0 +1,86 @@
+// Author: Daniel Kareh
+// Summary: A single-threaded server that hosts many games at once. Clients
+//          connect over TCP or a Unix domain socket and send one command per
+//          line. An epoll event loop handles every connection, so an idle
+//          game costs only its memory.
+//
+// Commands and responses:
+//   new [chess960]     ok ID
+//   move ID MOVE       ok STATUS | illegal
+//   status ID          ok COLOR STATUS FEN
+//   close ID           ok
+//   stats              ok games=N connections=N rss_kb=N
+//   quit               (the server closes the connection)
+// Moves are written like 'e2e4' or 'e7e8q'. STATUS is one of 'playing',
+// 'check', 'checkmate', or 'stalemate'. Anything else gets 'error MESSAGE'.
+// Games belong to the connection that created them and end when it closes.
+
+#ifndef CHESS_GAME_SERVER_H
+#define CHESS_GAME_SERVER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../Game.h"
+
+// Both functions return a listening, nonblocking socket or throw.
+int listen_on_tcp_port(const std::string& host, int port);
+int listen_on_unix_socket(const std::string& path);
+
+class GameServer {
+public:
+	// The server takes ownership of the listening socket.
+	explicit GameServer(int listener);
+	~GameServer();
+
+	GameServer(const GameServer&) = delete;
+	GameServer& operator=(const GameServer&) = delete;
+	GameServer(GameServer&&) = delete;
+	GameServer& operator=(GameServer&&) = delete;
+
+	// Serve clients until an unrecoverable error happens.
+	void run();
+
+private:
+	struct Connection {
+		std::string input;
+		std::string output;
+		std::vector<std::uint32_t> game_ids;
+		// What the connection is registered for in the epoll set.
+		std::uint32_t events{ 0 };
+		bool closing{ false };
+	};
+
+	// Checking for mate is expensive, so it's done once per move.
+	struct Session {
+		Game game;
+		mate status;
+		bool in_check;
+		int owner;
+	};
+
+	void accept_connections();
+	void handle_events(int descriptor, Connection&);
+	void execute_lines(int descriptor, Connection&);
+	// Send as much output as the socket takes. Return false if the
+	// connection was closed.
+	bool flush(int descriptor, Connection&);
+	void close_connection(int descriptor);
+	std::string execute(int descriptor, Connection&, std::string_view line);
+
+	std::string create_game(int descriptor, Connection&, std::string_view variant);
+	std::string move(std::uint32_t id, std::string_view string);
+	std::string describe(std::uint32_t id) const;
+	std::string close_game(Connection&, std::uint32_t id);
+	std::string describe_statistics() const;
+
+	int listener;
+	int epoll;
+	std::unordered_map<int, Connection> connections;
+	std::unordered_map<std::uint32_t, Session> sessions;
+	std::uint32_t next_game_id{ 1 };
+};
+
+#endif
@@ -0,0 +1,688 @@
+// Author: Daniel Kareh
+// Summary: Endgame tablebases for positions with up to five pieces. Tables
+//          are generated by retrograde analysis and probed straight out of
+//          memory-mapped files.
+//
+// File format (all numbers are little-endian):
+//   8 bytes   The magic string "CPPCHTB1".
+//   16 bytes  The material, such as "KRPvKR", padded with zero bytes.
+//   8 bytes   The number of positions, N.
+//   N/4 bytes The result of each position, packed two bits per position
+//             (0 = draw, 1 = win, 2 = loss, 3 = impossible position).
+//   N bytes   The number of moves until mate for each position.
+
+#include "tablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio> // For std::fopen, std::fwrite.
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+static const std::size_t max_pieces{ 5 };
+static const std::string_view magic{ "CPPCHTB1" };
+static const std::size_t name_size{ 16 };
+static const std::size_t header_size{ 32 };
+static const std::string_view file_extension{ ".ctb" };
+
+// Lower numbers are stronger pieces.
+static int get_strength_order(piece_type type) {
+	switch (get_base_type(type)) {
+	case piece_type::queen:
+		return 0;
+	case piece_type::rook:
+		return 1;
+	case piece_type::bishop:
+		return 2;
+	case piece_type::knight:
+		return 3;
+	default:
+		return 4;
+	}
+}
+
+std::optional<Material> Material::parse(std::string_view string) {
+	const std::size_t separator{ string.find('v') };
+	if (separator == std::string_view::npos)
+		return std::nullopt;
+
+	Material material;
+	const std::string_view halves[]{ string.substr(0, separator), string.substr(separator + 1) };
+	for (const color color : { color::white, color::black }) {
+		const std::string_view half{ halves[color == color::white ? 0 : 1] };
+		if (half.empty() || safe_to_upper(half[0]) != 'K')
+			return std::nullopt;
+
+		for (const char letter : half.substr(1)) {
+			const auto type{ convert_letter_to_piece_type(letter) };
+			if (!type || *type == piece_type::king)
+				return std::nullopt;
+			material.pieces.push_back({ *type, color });
+		}
+	}
+
+	if (material.pieces.size() + 2 > max_pieces)
+		return std::nullopt;
+
+	material.sort();
+	return material;
+}
+
+Material Material::of(const Board& board) {
+	Material material;
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (piece && !piece->is_king())
+			material.pieces.push_back({ get_base_type(piece->type), piece->color });
+	}
+	material.sort();
+	return material;
+}
+
+std::string Material::name() const {
+	std::string name{ "K" };
+	for (const color color : { color::white, color::black }) {
+		if (color == color::black)
+			name += "vK";
+		for (const auto& piece : pieces) {
+			if (piece.color == color)
+				name += convert_piece_type_to_letter(piece.type);
+		}
+	}
+	return name;
+}
+
+bool Material::has_pawns() const {
+	return std::any_of(pieces.begin(), pieces.end(),
+		[](const TablebasePiece& piece) { return piece.type == piece_type::pawn; });
+}
+
+bool Material::is_canonical() const {
+	std::vector<int> white;
+	std::vector<int> black;
+	for (const auto& piece : pieces)
+		(piece.color == color::white ? white : black).push_back(get_strength_order(piece.type));
+
+	// Compare the strongest pieces first. If one side has extra pieces, it's stronger.
+	const auto mismatch{ std::mismatch(white.begin(), white.end(), black.begin(), black.end()) };
+	if (mismatch.first == white.end())
+		return mismatch.second == black.end();
+	if (mismatch.second == black.end())
+		return true;
+	return *mismatch.first < *mismatch.second;
+}
+
+Material Material::flipped() const {
+	Material material{ *this };
+	for (auto& piece : material.pieces)
+		piece.color = get_opposing_color(piece.color);
+	material.sort();
+	return material;
+}
+
+void Material::sort() {
+	std::stable_sort(pieces.begin(), pieces.end(), [](TablebasePiece a, TablebasePiece b) {
+		if (a.color != b.color)
+			return a.color == color::white;
+		return get_strength_order(a.type) < get_strength_order(b.type);
+	});
+}
+
+Board flip_colors(const Board& board) {
+	std::array<Board::Rank, 8> ranks{};
+	for (const Square square : board) {
+		auto piece{ board.get_piece(square) };
+		if (piece)
+			piece->color = get_opposing_color(piece->color);
+		ranks.at(7 - square.get_rank()).at(square.get_file()) = piece;
+	}
+
+	Square target{ board.get_en_passant_target() };
+	if (board.is_in_bounds(target))
+		target = Square{ 7 - target.get_rank(), target.get_file() };
+	return Board{ ranks, target };
+}
+
+struct Symmetry {
+	bool flip_files{ false };
+	bool flip_ranks{ false };
+	bool transpose{ false };
+};
+
+static Square transform(Square square, Symmetry symmetry) {
+	if (symmetry.flip_files)
+		square = Square{ square.get_rank(), 7 - square.get_file() };
+	if (symmetry.flip_ranks)
+		square = Square{ 7 - square.get_rank(), square.get_file() };
+	if (symmetry.transpose)
+		square = Square{ square.get_file(), square.get_rank() };
+	return square;
+}
+
+// Choose the symmetry that moves White's king into the smallest region.
+// Pawns only move in one direction, so boards with pawns can only be mirrored.
+static Symmetry choose_symmetry(Square white_king, bool has_pawns) {
+	Symmetry symmetry;
+	symmetry.flip_files = white_king.get_file() > 3;
+	if (!has_pawns) {
+		symmetry.flip_ranks = white_king.get_rank() > 3;
+		const Square king{ transform(white_king, symmetry) };
+		symmetry.transpose = king.get_rank() > king.get_file();
+	}
+	return symmetry;
+}
+
+// The triangle a1-d1-d4 has 10 squares: one on file a, two on file b, etc.
+static std::size_t get_triangle_slot(Square square) {
+	const int file{ square.get_file() };
+	return static_cast<std::size_t>(file * (file + 1) / 2 + square.get_rank());
+}
+
+static Square get_triangle_square(std::size_t slot) {
+	int file{ 0 };
+	while (static_cast<std::size_t>((file + 1) * (file + 2) / 2) <= slot)
+		file++;
+	return { static_cast<int>(slot) - file * (file + 1) / 2, file };
+}
+
+// Pawns can never stand on the first or last rank.
+static std::size_t get_square_count(piece_type type) { return type == piece_type::pawn ? 48 : 64; }
+
+static std::size_t get_square_index(Square square, piece_type type) {
+	const auto index{ static_cast<std::size_t>(square.get_rank() * 8 + square.get_file()) };
+	return type == piece_type::pawn ? index - 8 : index;
+}
+
+static Square get_square(std::size_t index, piece_type type) {
+	if (type == piece_type::pawn)
+		index += 8;
+	return { static_cast<int>(index / 8), static_cast<int>(index % 8) };
+}
+
+TableLayout::TableLayout(Material material)
+	: material{ std::move(material) }
+	, king_slots{ this->material.has_pawns() ? 32U : 10U }
+	, positions_per_side{ king_slots * 64 } {
+	for (const auto& piece : this->material.get_pieces())
+		positions_per_side *= get_square_count(piece.type);
+}
+
+std::size_t TableLayout::index(const Board& board, color active_color) const {
+	Square white_king{};
+	Square black_king{};
+	std::array<std::pair<Square, TablebasePiece>, max_pieces> others{};
+	std::size_t other_count{ 0 };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+
+		if (piece->is_king())
+			(piece->is_white() ? white_king : black_king) = square;
+		else if (other_count < others.size())
+			others.at(other_count++) = { square, { get_base_type(piece->type), piece->color } };
+	}
+
+	const auto& pieces{ material.get_pieces() };
+	const Symmetry symmetry{ choose_symmetry(white_king, material.has_pawns()) };
+	const Square king{ transform(white_king, symmetry) };
+	const std::size_t king_slot{ material.has_pawns()
+			? static_cast<std::size_t>(king.get_rank() * 4 + king.get_file())
+			: get_triangle_slot(king) };
+
+	std::size_t index{ active_color == color::white ? 0U : 1U };
+	index = index * king_slots + king_slot;
+	index = index * 64 + get_square_index(transform(black_king, symmetry), piece_type::king);
+
+	// Match each piece of the material with a piece on the board. Identical
+	// pieces are matched in the order that they appear on the board.
+	std::array<bool, max_pieces> used{};
+	for (const auto& wanted : pieces) {
+		for (std::size_t i{ 0 }; i < other_count; i++) {
+			const auto& [square, piece] = others.at(i);
+			if (used.at(i) || piece.type != wanted.type || piece.color != wanted.color)
+				continue;
+
+			used.at(i) = true;
+			index = index * get_square_count(piece.type)
+				+ get_square_index(transform(square, symmetry), piece.type);
+			break;
+		}
+	}
+	return index;
+}
+
+bool TableLayout::decode(std::size_t index, Board& board, color& active_color) const {
+	const auto& pieces{ material.get_pieces() };
+	std::array<Square, max_pieces> squares{};
+	for (std::size_t i{ pieces.size() }; i-- > 0;) {
+		const std::size_t count{ get_square_count(pieces[i].type) };
+		squares.at(i) = get_square(index % count, pieces[i].type);
+		index /= count;
+	}
+
+	const Square black_king{ get_square(index % 64, piece_type::king) };
+	index /= 64;
+	const std::size_t king_slot{ index % king_slots };
+	const Square white_king{ material.has_pawns()
+			? Square{ static_cast<int>(king_slot / 4), static_cast<int>(king_slot % 4) }
+			: get_triangle_square(king_slot) };
+	active_color = index / king_slots == 0 ? color::white : color::black;
+
+	std::array<Board::Rank, 8> ranks{};
+	const auto place{ [&ranks](Square square, Piece piece) {
+		auto& destination{ ranks.at(square.get_rank()).at(square.get_file()) };
+		if (destination)
+			return false;
+		destination = piece;
+		return true;
+	} };
+
+	bool is_valid{ place(white_king, { piece_type::king, color::white }) };
+	is_valid = is_valid && place(black_king, { piece_type::king, color::black });
+	for (std::size_t i{ 0 }; i < pieces.size() && is_valid; i++)
+		is_valid = place(squares.at(i), { pieces[i].type, pieces[i].color });
+
+	if (is_valid)
+		board = Board{ ranks };
+	return is_valid;
+}
+
+// During generation, results are stored as the number of plies until mate
+// from the point of view of the player to move: `n` for a win and `-n - 1`
+// for a loss. Several special values are stored above every possible win.
+using Value = std::int16_t;
+static const Value unknown{ INT16_MAX };
+static const Value draw{ INT16_MAX - 1 };
+static const Value impossible{ INT16_MAX - 2 };
+
+static Value win_in(int plies) { return static_cast<Value>(plies); }
+static Value loss_in(int plies) { return static_cast<Value>(-plies - 1); }
+static bool is_win(Value value) { return 0 < value && value < impossible; }
+static bool is_loss(Value value) { return value < 0; }
+static int get_plies(Value value) { return value < 0 ? -value - 1 : value; }
+
+// Run `function` on every index from 0 to `count - 1` using several threads.
+template <typename Function>
+static void parallel_for(std::size_t count, unsigned thread_count, const Function& function) {
+	const std::size_t chunk_size{ 1024 };
+	std::atomic<std::size_t> next_chunk{ 0 };
+	const auto work{ [&] {
+		for (;;) {
+			const std::size_t start{ next_chunk.fetch_add(chunk_size) };
+			if (start >= count)
+				return;
+
+			const std::size_t end{ std::min(count, start + chunk_size) };
+			for (std::size_t index{ start }; index < end; index++)
+				function(index);
+		}
+	} };
+
+	std::vector<std::thread> threads;
+	for (unsigned i{ 1 }; i < thread_count; i++)
+		threads.emplace_back(work);
+	work();
+	for (auto& thread : threads)
+		thread.join();
+}
+
+static Material make_canonical(const Material& material) {
+	return material.is_canonical() ? material : material.flipped();
+}
+
+// Every material that a capture or promotion can turn `material` into.
+static std::vector<Material> get_successors(const Material& material) {
+	std::vector<Material> successors;
+	const auto& pieces{ material.get_pieces() };
+	for (std::size_t i{ 0 }; i < pieces.size(); i++) {
+		std::vector<TablebasePiece> remaining{ pieces };
+		remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(i));
+
+		const auto build{ [](const std::vector<TablebasePiece>& list) {
+			std::string white{ "K" };
+			std::string black{ "K" };
+			for (const auto& piece : list)
+				(piece.color == color::white ? white : black)
+					+= convert_piece_type_to_letter(piece.type);
+			return *Material::parse(white + "v" + black);
+		} };
+
+		successors.push_back(build(remaining));
+		if (pieces[i].type == piece_type::pawn) {
+			for (const auto type :
+				{ piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen }) {
+				std::vector<TablebasePiece> promoted{ pieces };
+				promoted[i].type = type;
+				successors.push_back(build(promoted));
+			}
+		}
+	}
+	return successors;
+}
+
+namespace {
+struct GeneratedTable {
+	TableLayout layout;
+	std::vector<Value> values;
+};
+
+class Generator {
+public:
+	Generator(std::string directory, unsigned thread_count,
+		const std::function<void(const std::string&)>& report)
+		: directory{ std::move(directory) }
+		, thread_count{ std::max(thread_count, 1U) }
+		, report{ report } {}
+
+	void generate(const Material&);
+
+private:
+	Value probe(Board board, color active_color) const;
+	Value get_child_value(const TableLayout&, const std::atomic<Value>* values,
+		const LegalMove&, const Board& child, color active_color) const;
+	Value evaluate_en_passant(const TableLayout&, const std::atomic<Value>* values,
+		const Board&, color active_color) const;
+	Value initialize(const TableLayout&, std::size_t index) const;
+	Value evaluate(const TableLayout&, const std::atomic<Value>* values, std::size_t index,
+		int plies) const;
+	void write(const GeneratedTable&) const;
+
+	std::string directory;
+	unsigned thread_count;
+	const std::function<void(const std::string&)>& report;
+	std::map<std::string, GeneratedTable> finished;
+	int max_finished_plies{ 0 };
+};
+}
+
+void Generator::generate(const Material& material) {
+	if (material.get_pieces().empty() || finished.count(material.name()) != 0)
+		return;
+
+	// Any capture or promotion leaves this table, so the tables for smaller
+	// endgames must be finished first.
+	for (const auto& successor : get_successors(material))
+		generate(make_canonical(successor));
+
+	const TableLayout layout{ material };
+	report("Generating " + material.name() + " (" + std::to_string(layout.size()) + " positions)");
+
+	const auto values{ std::make_unique<std::atomic<Value>[]>(layout.size()) };
+	parallel_for(layout.size(), thread_count, [&](std::size_t index) {
+		values[index].store(initialize(layout, index), std::memory_order_relaxed);
+	});
+
+	// Each pass finds the positions where mate is exactly `plies` plies away.
+	// Results found during a pass are not used until the next pass because
+	// they are always `plies` plies away, which `evaluate` ignores.
+	for (int plies{ 1 };; plies++) {
+		std::atomic<std::size_t> resolved{ 0 };
+		parallel_for(layout.size(), thread_count, [&](std::size_t index) {
+			if (values[index].load(std::memory_order_relaxed) != unknown)
+				return;
+
+			const Value value{ evaluate(layout, values.get(), index, plies) };
+			if (value != unknown) {
+				values[index].store(value, std::memory_order_relaxed);
+				resolved.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		// Captures can lead to smaller endgames where mate is further away than
+		// anything found so far, so keep going until those can't matter.
+		if (resolved == 0 && plies > max_finished_plies + 1)
+			break;
+	}
+
+	GeneratedTable table{ layout, std::vector<Value>(layout.size()) };
+	for (std::size_t index{ 0 }; index < layout.size(); index++) {
+		const Value value{ values[index].load(std::memory_order_relaxed) };
+		table.values[index] = value == unknown ? draw : value;
+		if (is_win(value) || is_loss(value))
+			max_finished_plies = std::max(max_finished_plies, get_plies(value));
+	}
+
+	write(table);
+	finished.emplace(material.name(), std::move(table));
+}
+
+// Look up a position in one of the finished tables.
+Value Generator::probe(Board board, color active_color) const {
+	Material material{ Material::of(board) };
+	if (material.get_pieces().empty())
+		return draw;
+
+	if (!material.is_canonical()) {
+		board = flip_colors(board);
+		active_color = get_opposing_color(active_color);
+		material = material.flipped();
+	}
+
+	const auto& table{ finished.at(material.name()) };
+	return table.values.at(table.layout.index(board, active_color));
+}
+
+// Find the value of the position after `legal_move`, which may be in another
+// table, or (after a double pawn push) in no table at all.
+Value Generator::get_child_value(const TableLayout& layout, const std::atomic<Value>* values,
+	const LegalMove& legal_move, const Board& child, color active_color) const {
+	const auto& details{ legal_move.details };
+	if (details.captured_square || details.promote_to)
+		return probe(child, active_color);
+	if (child.can_capture_en_passant(active_color))
+		return evaluate_en_passant(layout, values, child, active_color);
+	return values[layout.index(child, active_color)].load(std::memory_order_relaxed);
+}
+
+// Work out the value of a position where en passant is possible from the
+// positions after each move. Every value shorter than the current pass is
+// already known, so the distances are exact whenever `evaluate` uses them.
+Value Generator::evaluate_en_passant(const TableLayout& layout, const std::atomic<Value>* values,
+	const Board& board, color active_color) const {
+	const color opponent{ get_opposing_color(active_color) };
+	std::optional<int> shortest_loss;
+	std::optional<int> longest_win;
+	bool every_move_wins{ true };
+	for (const auto& legal_move : board.get_all_legal_moves(active_color)) {
+		Board child{ board };
+		child.play(legal_move);
+
+		const Value child_value{ get_child_value(layout, values, legal_move, child, opponent) };
+		if (is_loss(child_value))
+			shortest_loss = std::min(shortest_loss.value_or(INT16_MAX), get_plies(child_value));
+		else if (is_win(child_value))
+			longest_win = std::max(longest_win.value_or(0), get_plies(child_value));
+		else
+			every_move_wins = false;
+	}
+
+	// An en passant capture is always possible here, so there is a move.
+	if (shortest_loss)
+		return win_in(*shortest_loss + 1);
+	return every_move_wins ? loss_in(*longest_win + 1) : unknown;
+}
+
+Value Generator::initialize(const TableLayout& layout, std::size_t index) const {
+	Board board;
+	color active_color{};
+	if (!layout.decode(index, board, active_color))
+		return impossible;
+
+	// The player who just moved can't have left their king in check.
+	const color opponent{ get_opposing_color(active_color) };
+	if (board.piece_is_under_attack(board.find_king(opponent)))
+		return impossible;
+
+	if (!board.get_all_legal_moves(active_color).empty())
+		return unknown;
+
+	const bool in_check{ board.piece_is_under_attack(board.find_king(active_color)) };
+	return in_check ? loss_in(0) : draw;
+}
+
+Value Generator::evaluate(const TableLayout& layout, const std::atomic<Value>* values,
+	std::size_t index, int plies) const {
+	Board board;
+	color active_color{};
+	layout.decode(index, board, active_color);
+	const color opponent{ get_opposing_color(active_color) };
+
+	// A position is lost if every move leads to a position that the opponent
+	// has already been shown to win.
+	bool every_move_loses{ true };
+	for (const auto& legal_move : board.get_all_legal_moves(active_color)) {
+		Board child{ board };
+		child.play(legal_move);
+
+		const Value child_value{ get_child_value(layout, values, legal_move, child, opponent) };
+
+		// A position is won if some move leads to a position that the opponent loses.
+		if (is_loss(child_value) && get_plies(child_value) == plies - 1)
+			return win_in(plies);
+
+		if (!is_win(child_value) || get_plies(child_value) >= plies)
+			every_move_loses = false;
+	}
+
+	return every_move_loses ? loss_in(plies) : unknown;
+}
+
+template <typename T>
+static void append_little_endian(std::string& bytes, T value) {
+	for (std::size_t i{ 0 }; i < sizeof(T); i++)
+		bytes += static_cast<char>(static_cast<std::uint64_t>(value) >> (8 * i) & 0xFF);
+}
+
+void Generator::write(const GeneratedTable& table) const {
+	const std::string name{ table.layout.get_material().name() };
+	const std::size_t count{ table.values.size() };
+	std::string bytes{ magic };
+	bytes += name;
+	bytes.resize(magic.size() + name_size, '\0');
+	append_little_endian(bytes, static_cast<std::uint64_t>(count));
+
+	std::string results((count + 3) / 4, '\0');
+	std::string moves(count, '\0');
+	for (std::size_t index{ 0 }; index < count; index++) {
+		const Value value{ table.values[index] };
+		unsigned code{ 0 };
+		int moves_to_mate{ 0 };
+		if (value == impossible) {
+			code = 3;
+		} else if (is_win(value)) {
+			code = 1;
+			moves_to_mate = (get_plies(value) + 1) / 2;
+		} else if (is_loss(value)) {
+			code = 2;
+			moves_to_mate = get_plies(value) / 2;
+		}
+
+		results[index / 4] = static_cast<char>(results[index / 4] | code << (2 * (index % 4)));
+		moves[index] = static_cast<char>(std::min(moves_to_mate, 255));
+	}
+
+	const auto path{ std::filesystem::path{ directory } / (name + std::string{ file_extension }) };
+	std::FILE* file{ std::fopen(path.string().c_str(), "wb") };
+	if (file == nullptr)
+		throw std::runtime_error{ "Cannot write " + path.string() };
+
+	bool ok{ std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() };
+	ok = ok && std::fwrite(results.data(), 1, results.size(), file) == results.size();
+	ok = ok && std::fwrite(moves.data(), 1, moves.size(), file) == moves.size();
+	ok = std::fclose(file) == 0 && ok;
+	if (!ok)
+		throw std::runtime_error{ "Cannot write " + path.string() };
+
+	report("Wrote " + path.string());
+}
+
+void generate_tablebases(std::string_view material, const std::string& directory,
+	unsigned thread_count, const std::function<void(const std::string&)>& report) {
+	const auto parsed{ Material::parse(material) };
+	if (!parsed)
+		throw std::runtime_error{ "Invalid material: " + std::string{ material } };
+
+	Generator generator{ directory, thread_count, report };
+	generator.generate(make_canonical(*parsed));
+}
+
+Tablebases::Tablebases(const std::string& directory) {
+	for (const auto& entry : std::filesystem::directory_iterator{ directory }) {
+		if (entry.path().extension() != file_extension)
+			continue;
+
+		MappedFile file{ entry.path().string() };
+		const std::string_view view{ file.view() };
+		if (view.size() < header_size || view.substr(0, magic.size()) != magic)
+			throw std::runtime_error{ entry.path().string() + " is not a tablebase" };
+
+		const std::string_view padded_name{ view.substr(magic.size(), name_size) };
+		const auto material{ Material::parse(padded_name.substr(0, padded_name.find('\0'))) };
+		if (!material)
+			throw std::runtime_error{ entry.path().string() + " has invalid material" };
+
+		TableLayout layout{ *material };
+		const std::size_t count{ layout.size() };
+		if (view.size() != header_size + (count + 3) / 4 + count)
+			throw std::runtime_error{ entry.path().string() + " has the wrong size" };
+
+		const std::string name{ material->name() };
+		tables.emplace(name, Table{ std::move(file), std::move(layout) });
+	}
+}
+
+std::optional<TablebaseResult> Tablebases::probe(const Board& board, color active_color) const {
+	int white_kings{ 0 };
+	int black_kings{ 0 };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+		if (get_base_type(piece->type) != piece->type)
+			return std::nullopt;
+		if (piece->is_king())
+			(piece->is_white() ? white_kings : black_kings)++;
+		if (piece->type == piece_type::pawn && (square.get_rank() == 0 || square.get_rank() == 7))
+			return std::nullopt;
+	}
+
+	if (white_kings != 1 || black_kings != 1 || board.can_capture_en_passant(active_color))
+		return std::nullopt;
+
+	Material material{ Material::of(board) };
+	if (material.get_pieces().empty())
+		return TablebaseResult{ wdl::draw, 0 };
+
+	if (material.get_pieces().size() + 2 > max_pieces)
+		return std::nullopt;
+
+	Board oriented{ board };
+	if (!material.is_canonical()) {
+		oriented = flip_colors(board);
+		active_color = get_opposing_color(active_color);
+		material = material.flipped();
+	}
+
+	const auto table{ tables.find(material.name()) };
+	if (table == tables.end())
+		return std::nullopt;
+
+	const std::size_t index{ table->second.layout.index(oriented, active_color) };
+	const std::size_t count{ table->second.layout.size() };
+	const unsigned char* data{ table->second.file.data() + header_size };
+	const unsigned code{ static_cast<unsigned>(data[index / 4] >> (2 * (index % 4)) & 3) };
+	const int moves_to_mate{ data[(count + 3) / 4 + index] };
+	switch (code) {
+	case 1:
+		return TablebaseResult{ wdl::win, moves_to_mate };
+	case 2:
+		return TablebaseResult{ wdl::loss, moves_to_mate };
+	case 3:
+		return std::nullopt;
+	default:
+		return TablebaseResult{ wdl::draw, 0 };
+	}
+}
@@ -0,0 +1,112 @@
+// Author: Daniel Kareh
+// Summary: Endgame tablebases for positions with up to five pieces. Tables
+//          are generated by retrograde analysis and probed straight out of
+//          memory-mapped files.
+
+#ifndef CHESS_TABLEBASE_H
+#define CHESS_TABLEBASE_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include "Board.h"
+#include "MappedFile.h"
+
+enum class wdl : unsigned char {
+	draw,
+	win,
+	loss,
+};
+
+// The result of a position from the point of view of the player to move.
+struct TablebaseResult {
+	enum wdl wdl;
+	// How many moves until checkmate if the game is won or lost, and zero if
+	// the game is drawn (or if the player to move has already been mated).
+	int moves_to_mate;
+};
+
+struct TablebasePiece {
+	piece_type type;
+	enum color color;
+};
+
+// Describes which pieces are on the board besides the two kings, such as
+// 'KRPvKR'. White's pieces are listed first, strongest first.
+class Material {
+public:
+	static std::optional<Material> parse(std::string_view);
+	static Material of(const Board&);
+
+	std::string name() const;
+	const std::vector<TablebasePiece>& get_pieces() const { return pieces; }
+	bool has_pawns() const;
+
+	// Tables are only stored for the orientation where White is at least as
+	// strong as Black. The other orientation is probed with colors swapped.
+	bool is_canonical() const;
+	Material flipped() const;
+
+private:
+	void sort();
+
+	std::vector<TablebasePiece> pieces;
+};
+
+// Maps each position with a certain material to a unique index (and back).
+// Positions are reduced by symmetry: boards without pawns have White's king
+// in the a1-d1-d4 triangle, and boards with pawns have it on files a to d.
+class TableLayout {
+public:
+	explicit TableLayout(Material);
+
+	const Material& get_material() const { return material; }
+	std::size_t size() const { return 2 * positions_per_side; }
+
+	// The board must have exactly this layout's material.
+	std::size_t index(const Board&, color active_color) const;
+
+	// Return false if the index doesn't describe a position (for instance,
+	// if two pieces would be on the same square).
+	bool decode(std::size_t index, Board&, color& active_color) const;
+
+private:
+	Material material;
+	std::size_t king_slots;
+	std::size_t positions_per_side;
+};
+
+// Generate the tables for `material` and every smaller endgame that it can
+// turn into, writing one file per table into `directory`.
+// Throws `std::runtime_error` if the material is invalid or a file cannot be written.
+void generate_tablebases(std::string_view material, const std::string& directory,
+	unsigned thread_count, const std::function<void(const std::string&)>& report);
+
+class Tablebases {
+public:
+	// Open every table in a directory. Throws `std::runtime_error` if a table
+	// is corrupt.
+	explicit Tablebases(const std::string& directory);
+
+	std::size_t size() const { return tables.size(); }
+
+	// Return `std::nullopt` if no table matches the position, if either
+	// player can still castle (tables assume that nobody can), if en passant
+	// is possible (tables don't store the target), or if the position isn't
+	// one that tables can describe (without exactly one king per side, or
+	// with a pawn on the first or last rank).
+	std::optional<TablebaseResult> probe(const Board&, color active_color) const;
+
+private:
+	struct Table {
+		MappedFile file;
+		TableLayout layout;
+	};
+
+	std::map<std::string, Table> tables;
+};
+
+Board flip_colors(const Board&);
+
+#endif
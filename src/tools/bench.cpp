@@ -0,0 +1,423 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that times the hot paths of the rules engine
+//          over a fixed set of positions and prints the results as JSON, so
+//          that they can be compared between commits.
+//
+// Usage: chess-bench [--min-time SECONDS] [--filter TEXT] [--check-allocations]
+//   --min-time SECONDS   How long to run each benchmark (default: 0.25).
+//   --filter TEXT        Only run benchmarks whose names contain TEXT.
+//   --check-allocations  Fail if a path that must never allocate did.
+//
+// Each result has the time and the number of heap allocations per operation.
+// Benchmarks are named like 'get_legal_moves/endgame', except for the ones of
+// the board layer on its own, which are named by board size, like
+// 'occupied_squares/10x8'.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib> // For std::malloc and std::free.
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include "../Game.h"
+#include "../LegalMoveSet.h"
+#include "../allocation_profile.h"
+#include "../attacks.h"
+#include "../chess960.h"
+#include "../fen.h"
+#include "../ui/AsciiUi.h"
+#include "../ui/LetterUi.h"
+#include "../ui/TwoLetterUi.h"
+#include "parse_number.h"
+
+#ifdef CHESS_ALLOCATION_PROFILE
+
+// The profiler already replaces the global allocation functions.
+static std::uint64_t get_allocation_count() { return get_thread_allocation_count(); }
+
+#else
+
+// Count every allocation in the program by replacing the global allocation
+// functions. (The array and nothrow versions call these.)
+static std::atomic<std::uint64_t> allocation_count{ 0 };
+
+void* operator new(std::size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer{ std::malloc(size == 0 ? 1 : size) })
+		return pointer;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+static std::uint64_t get_allocation_count() { return allocation_count.load(); }
+
+#endif
+
+struct Position {
+	Board board;
+	color active_color;
+};
+
+struct Corpus {
+	const char* name;
+	std::vector<Position> positions;
+};
+
+static std::vector<Position> parse_positions(std::initializer_list<const char*> fens) {
+	std::vector<Position> positions;
+	for (const char* fen : fens) {
+		const auto position{ parse_fen(fen) };
+		positions.push_back({ position->board, position->active_color });
+	}
+	return positions;
+}
+
+static std::vector<Corpus> get_corpora() {
+	std::vector<Corpus> corpora;
+	corpora.push_back({ "middlegame",
+		parse_positions({
+			"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			"r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+			"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+		}) });
+	corpora.push_back({ "endgame",
+		parse_positions({
+			"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+			"8/8/4k3/8/2KP4/8/8/8 w - - 0 1",
+			"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+			"8/5pk1/6p1/8/3Q4/8/5PPP/6K1 b - - 0 1",
+		}) });
+
+	Corpus chess960{ "chess960", {} };
+	for (const int index : { 0, 191, 404, 959 })
+		chess960.positions.push_back({ generate_chess960_board(index), color::white });
+	corpora.push_back(chess960);
+	return corpora;
+}
+
+struct Result {
+	std::string name;
+	std::uint64_t operations;
+	double nanoseconds_per_operation;
+	double allocations_per_operation;
+};
+
+// Writing results here keeps the compiler from optimizing the work away.
+static volatile std::uint64_t benchmark_sink{ 0 };
+
+// A benchmark does some operations on a position and returns how many it did.
+// Its result is also folded into `sink` so that the work can't be optimized out.
+using Benchmark = std::function<std::uint64_t(const Position&, std::uint64_t& sink)>;
+
+static Result run_benchmark(const std::string& name, const std::vector<Position>& positions,
+	const Benchmark& benchmark, double min_time) {
+	using Clock = std::chrono::steady_clock;
+	std::uint64_t sink{ 0 };
+	std::uint64_t operations{ 0 };
+
+	// Warm up once, then repeat the whole corpus until enough time passes.
+	for (const auto& position : positions)
+		benchmark(position, sink);
+
+	const auto allocations_before{ get_allocation_count() };
+	const auto start{ Clock::now() };
+	std::chrono::duration<double> elapsed{};
+	do {
+		for (const auto& position : positions)
+			operations += benchmark(position, sink);
+		elapsed = Clock::now() - start;
+	} while (elapsed.count() < min_time);
+	const auto allocations{ get_allocation_count() - allocations_before };
+
+	benchmark_sink = benchmark_sink + sink;
+
+	const double count{ static_cast<double>(std::max<std::uint64_t>(operations, 1)) };
+	return { name, operations, elapsed.count() * 1e9 / count,
+		static_cast<double>(allocations) / count };
+}
+
+static std::uint64_t bench_get_piece(const Position& position, std::uint64_t& sink) {
+	std::uint64_t operations{ 0 };
+	for (const Square square : position.board) {
+		sink += position.board.get_piece(square).has_value();
+		operations++;
+	}
+	return operations;
+}
+
+// Every pair of squares where the active player has a piece on the first.
+template <typename Function>
+static std::uint64_t for_each_own_move(const Position& position, const Function& function) {
+	std::uint64_t operations{ 0 };
+	for (const Square from : position.board) {
+		const auto piece{ position.board.get_piece(from) };
+		if (!piece || piece->color != position.active_color)
+			continue;
+
+		for (const Square to : position.board) {
+			function(Move{ position.active_color, from, to });
+			operations++;
+		}
+	}
+	return operations;
+}
+
+static std::uint64_t bench_generate_move_details(const Position& position, std::uint64_t& sink) {
+	return for_each_own_move(
+		position, [&](Move move) { sink += generate_move_details(move, position.board).size(); });
+}
+
+static std::uint64_t bench_get_legal_moves(const Position& position, std::uint64_t& sink) {
+	return for_each_own_move(
+		position, [&](Move move) { sink += position.board.get_legal_moves(move).size(); });
+}
+
+static std::uint64_t bench_get_all_legal_moves(const Position& position, std::uint64_t& sink) {
+	sink += position.board.get_all_legal_moves(position.active_color).size();
+	return 1;
+}
+
+static std::uint64_t bench_generate_legal_moves(const Position& position, std::uint64_t& sink) {
+	MoveList legal_moves;
+	position.board.generate_legal_moves(position.active_color, legal_moves);
+	sink += legal_moves.size();
+	return 1;
+}
+
+static std::uint64_t bench_piece_is_under_attack(const Position& position, std::uint64_t& sink) {
+	std::uint64_t operations{ 0 };
+	for (const Square square : position.board) {
+		if (!position.board.is_occupied(square))
+			continue;
+		sink += position.board.piece_is_under_attack(square);
+		operations++;
+	}
+	return operations;
+}
+
+// Play every legal move through `Board::move` (which calls `force_move`).
+static std::uint64_t bench_move(const Position& position, std::uint64_t& sink) {
+	const auto legal_moves{ position.board.get_all_legal_moves(position.active_color) };
+	std::uint64_t operations{ 0 };
+	for (const auto& [move, details] : legal_moves) {
+		Board board{ position.board };
+		const auto chosen{ board.move(move, [](const std::vector<MoveDetails>&) { return 0; }) };
+		sink += chosen.has_value();
+		operations++;
+	}
+	return operations;
+}
+
+// Make and unmake every legal move on one copy of the board.
+static std::uint64_t bench_make_unmake(const Position& position, std::uint64_t& sink) {
+	MoveList legal_moves;
+	position.board.generate_legal_moves(position.active_color, legal_moves);
+	Board board{ position.board };
+	for (const auto& legal_move : legal_moves) {
+		const auto undo{ board.make_move(legal_move) };
+		sink += board.is_occupied(legal_move.move.to);
+		board.unmake_move(undo);
+	}
+	return legal_moves.size();
+}
+
+// Every square attacked by the opponent, as the castling rules ask for it.
+static std::uint64_t bench_get_attacked_squares(const Position& position, std::uint64_t& sink) {
+	const auto opponent{ get_opposing_color(position.active_color) };
+	sink += position.board.get_attacked_squares(opponent).size();
+	return 1;
+}
+
+// Everything a turn of `Game::run` asks before a move is played: mate, check,
+// and the choices for one entered move.
+static std::uint64_t bench_legal_move_set(const Position& position, std::uint64_t& sink) {
+	const LegalMoveSet legal_moves{ position.board, position.active_color };
+	sink += static_cast<std::uint64_t>(legal_moves.get_status()) + legal_moves.is_in_check();
+	if (!legal_moves.get_all_moves().empty())
+		sink += legal_moves.get_moves(legal_moves.get_all_moves()[0].move).size();
+	return 1;
+}
+
+// Each game is set up during the warm-up, since a game allocates its history
+// arena when it's constructed. Only mate detection is timed.
+static Benchmark bench_detect_mate() {
+	auto games{ std::make_shared<std::map<const Position*, Game>>() };
+	return [games](const Position& position, std::uint64_t& sink) -> std::uint64_t {
+		auto found{ games->find(&position) };
+		if (found == games->end())
+			found = games->try_emplace(&position, position.board, position.active_color).first;
+		sink += static_cast<std::uint64_t>(found->second.get_status());
+		return 1;
+	};
+}
+
+// A board of the given size with a row of pawns for each side, and rooks
+// behind them. The larger variants' own pieces aren't in the engine, but the
+// board layer doesn't care which pieces are on it.
+template <typename Geometry>
+static BasicBoard<Geometry> get_home_board() {
+	std::array<typename BasicBoard<Geometry>::Rank, Geometry::ranks> ranks{};
+	ranks[0].fill(Piece{ piece_type::rook, color::white });
+	ranks[1].fill(Piece{ piece_type::pawn, color::white });
+	ranks[Geometry::ranks - 2].fill(Piece{ piece_type::pawn, color::black });
+	ranks[Geometry::ranks - 1].fill(Piece{ piece_type::rook, color::black });
+	return BasicBoard<Geometry>{ ranks };
+}
+
+// Visit every square and collect the occupied ones, on a board of the given
+// size instead of the position's.
+template <typename Geometry>
+static Benchmark bench_occupied_squares() {
+	auto board{ std::make_shared<const BasicBoard<Geometry>>(get_home_board<Geometry>()) };
+	return [board](const Position&, std::uint64_t& sink) -> std::uint64_t {
+		for (const Square square : *board)
+			sink += board->is_occupied(square);
+		sink += static_cast<std::uint64_t>(board->get_occupied_squares().size()
+			+ board->get_occupied_squares(color::white).size());
+		return 1;
+	};
+}
+
+// A stream buffer that throws everything away, so that the interfaces can
+// draw without a terminal.
+class NullBuffer : public std::streambuf {
+protected:
+	int_type overflow(int_type character) override { return traits_type::not_eof(character); }
+	std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+template <typename Interface>
+static Benchmark bench_show() {
+	auto user_interface{ std::make_shared<Interface>() };
+	return [user_interface](const Position& position, std::uint64_t&) -> std::uint64_t {
+		NullBuffer null_buffer;
+		auto* const old_buffer{ std::cout.rdbuf(&null_buffer) };
+		user_interface->show(position.board);
+		std::cout.rdbuf(old_buffer);
+		return 1;
+	};
+}
+
+static void print_json_string(const std::string& string) {
+	std::cout << '"';
+	for (const char c : string) {
+		if (c == '"' || c == '\\')
+			std::cout << '\\';
+		std::cout << c;
+	}
+	std::cout << '"';
+}
+
+int main(int argc, char* argv[]) {
+	double min_time{ 0.25 };
+	std::string filter;
+	bool check_allocations{ false };
+	for (int i{ 1 }; i < argc; i++) {
+		const std::string name{ argv[i] };
+		const auto value{ i + 1 < argc ? parse_number<double>(argv[i + 1]) : std::nullopt };
+		if (name == "--min-time" && value) {
+			min_time = *value;
+			i++;
+		} else if (name == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		} else if (name == "--check-allocations") {
+			check_allocations = true;
+		} else {
+			std::cerr << "Usage: " << argv[0]
+					  << " [--min-time SECONDS] [--filter TEXT] [--check-allocations]\n";
+			return 2;
+		}
+	}
+
+	const std::vector<std::pair<const char*, Benchmark>> benchmarks{
+		{ "get_piece", bench_get_piece },
+		{ "generate_move_details", bench_generate_move_details },
+		{ "get_legal_moves", bench_get_legal_moves },
+		{ "get_all_legal_moves", bench_get_all_legal_moves },
+		{ "generate_legal_moves", bench_generate_legal_moves },
+		{ "piece_is_under_attack", bench_piece_is_under_attack },
+		{ "get_attacked_squares", bench_get_attacked_squares },
+		{ "move", bench_move },
+		{ "make_unmake", bench_make_unmake },
+		{ "detect_mate", bench_detect_mate() },
+		{ "legal_move_set", bench_legal_move_set },
+		{ "show_ascii", bench_show<AsciiUi>() },
+		{ "show_letter", bench_show<LetterUi>() },
+		{ "show_two_letter", bench_show<TwoLetterUi>() },
+	};
+
+	const std::vector<std::pair<const char*, Benchmark>> board_size_benchmarks{
+		{ "occupied_squares/8x8", bench_occupied_squares<StandardGeometry>() },
+		{ "occupied_squares/10x8", bench_occupied_squares<CapablancaGeometry>() },
+		{ "occupied_squares/10x10", bench_occupied_squares<GrandGeometry>() },
+	};
+
+	std::vector<Result> results;
+	const std::vector<Position> start{ { Board{}, color::white } };
+	for (const auto& [name, benchmark] : board_size_benchmarks) {
+		if (std::string_view{ name }.find(filter) == std::string_view::npos)
+			continue;
+		results.push_back(run_benchmark(name, start, benchmark, min_time));
+		std::cerr << name << '\n';
+	}
+
+	for (const auto& corpus : get_corpora()) {
+		for (const auto& [benchmark_name, benchmark] : benchmarks) {
+			const std::string name{ std::string{ benchmark_name } + '/' + corpus.name };
+			if (name.find(filter) == std::string::npos)
+				continue;
+			results.push_back(run_benchmark(name, corpus.positions, benchmark, min_time));
+			std::cerr << name << '\n';
+		}
+	}
+
+	const char* const implementation{ get_attack_implementation_name(
+		get_best_attack_implementation()) };
+	std::cout << "{\n  \"attack_implementation\": ";
+	print_json_string(implementation);
+	std::cout << ",\n  \"benchmarks\": [";
+	for (std::size_t i{ 0 }; i < results.size(); i++) {
+		const auto& result{ results[i] };
+		std::cout << (i == 0 ? "\n" : ",\n") << "    { \"name\": ";
+		print_json_string(result.name);
+		std::cout << ", \"operations\": " << result.operations
+				  << ", \"ns_per_op\": " << result.nanoseconds_per_operation
+				  << ", \"allocs_per_op\": " << result.allocations_per_operation << " }";
+	}
+	std::cout << "\n  ]\n}\n";
+
+	if (!check_allocations)
+		return 0;
+
+	// These paths run millions of times per search and must never allocate.
+	const std::vector<std::string> allocation_free{
+		"get_piece/",
+		"occupied_squares/",
+		"generate_move_details/",
+		"get_legal_moves/",
+		"generate_legal_moves/",
+		"piece_is_under_attack/",
+		"get_attacked_squares/",
+		"make_unmake/",
+		"detect_mate/",
+	};
+	int failures{ 0 };
+	for (const auto& result : results) {
+		for (const auto& prefix : allocation_free) {
+			if (result.name.compare(0, prefix.size(), prefix) == 0
+				&& result.allocations_per_operation > 0) {
+				std::cerr << result.name << " allocated " << result.allocations_per_operation
+						  << " times per operation, but it must never allocate.\n";
+				failures++;
+			}
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
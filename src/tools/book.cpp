@@ -0,0 +1,65 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that prints the moves that a Polyglot opening
+//          book suggests after a sequence of moves from the starting position.
+//
+// Usage: chess-book RANDOM_NUMBERS BOOK [MOVE...]
+// Moves are written like 'e2e4', or like 'e7e8q' for promotions.
+
+#include <exception>
+#include <iostream>
+#include "../polyglot.h"
+#include "../san.h"
+
+static std::string print_book_move(const BookMove& book_move) {
+	std::string string{ book_move.move.from.print() + book_move.move.to.print() };
+	if (book_move.promote_to)
+		string += safe_to_lower(convert_piece_type_to_letter(*book_move.promote_to));
+	return string;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " RANDOM_NUMBERS BOOK [MOVE...]\n";
+		return 2;
+	}
+
+	try {
+		const auto keys{ PolyglotKeys::load(argv[1]) };
+		const OpeningBook book{ argv[2] };
+
+		Board board;
+		color active_color{ color::white };
+		for (int i{ 3 }; i < argc; i++) {
+			const auto legal_move{ parse_coordinate_move(argv[i], board, active_color) };
+			if (!legal_move) {
+				std::cerr << "Illegal move: " << argv[i] << '\n';
+				return 1;
+			}
+			board.play(*legal_move);
+			active_color = get_opposing_color(active_color);
+		}
+
+		const auto key{ keys.hash(board, active_color) };
+		const auto moves{ book.find(key, board, active_color) };
+		std::cout << "Key: " << std::hex << key << std::dec << '\n';
+		std::cout << "Book entries: " << book.size() << '\n';
+
+		unsigned long total_weight{ 0 };
+		for (const auto& book_move : moves)
+			total_weight += book_move.weight;
+
+		for (const auto& book_move : moves) {
+			const double percent{ total_weight == 0
+					? 0.0
+					: 100.0 * book_move.weight / static_cast<double>(total_weight) };
+			std::cout << '\t' << print_book_move(book_move) << " (weight " << book_move.weight
+					  << ", " << percent << "%)\n";
+		}
+
+		if (moves.empty())
+			std::cout << "The book has no moves for this position.\n";
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
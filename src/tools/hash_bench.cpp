@@ -0,0 +1,196 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that measures how the memory behind a large
+//          transposition table (ordinary pages, transparent huge pages,
+//          reserved huge pages, and with or without spreading it over NUMA
+//          nodes) changes lookup latency and search speed.
+//
+// Usage: chess-hash-bench [OPTION...]
+//   --megabytes N    The size of the table (default: 1024).
+//   --probes N       How many lookups to time in each mode (default: 10000000).
+//   --depth N        The depth of the searches in each mode (default: 5).
+//
+// Every mode fills the whole table first. Each lookup's key comes from the
+// entry found by the one before, so the processor can't overlap them, and
+// the time per lookup is the latency of a random access (which is mostly TLB
+// and cache misses for a big table). Spreading over
+// nodes is only tried on machines with more than one NUMA node.
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../Search.h"
+#include "../fen.h"
+#include "parse_number.h"
+
+struct Options {
+	std::size_t megabytes{ 1024 };
+	std::uint64_t probes{ 10'000'000 };
+	int depth{ 5 };
+};
+
+struct Mode {
+	TableMemoryOptions memory;
+	std::string name;
+};
+
+struct Measurement {
+	page_size pages{ page_size::standard };
+	std::size_t huge_page_bytes{ 0 };
+	int nodes{ 1 };
+	double setup_seconds{ 0.0 };
+	double lookup_nanoseconds{ 0.0 };
+	double nodes_per_second{ 0.0 };
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	Options options;
+	for (int i{ 1 }; i + 1 < argc; i += 2) {
+		const std::string name{ argv[i] };
+		const auto value{ parse_number<std::uint64_t>(argv[i + 1]) };
+		if (!value)
+			return std::nullopt;
+		if (name == "--megabytes")
+			options.megabytes = static_cast<std::size_t>(*value);
+		else if (name == "--probes")
+			options.probes = *value;
+		else if (name == "--depth")
+			options.depth = static_cast<int>(*value);
+		else
+			return std::nullopt;
+	}
+	if (argc % 2 == 0)
+		return std::nullopt;
+	return options;
+}
+
+// Writing results here keeps the compiler from optimizing the lookups away.
+static volatile std::uint64_t benchmark_sink{ 0 };
+
+// SplitMix64, to make keys that look random.
+static std::uint64_t mix(std::uint64_t value) {
+	value += 0x9E3779B97F4A7C15;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+	return value ^ (value >> 31);
+}
+
+static std::string get_page_name(page_size pages) {
+	switch (pages) {
+	case page_size::standard:
+		return "ordinary pages";
+	case page_size::transparent:
+		return "transparent huge pages";
+	case page_size::reserved:
+		return "reserved huge pages";
+	}
+	return "unknown pages";
+}
+
+static Measurement measure(const Mode& mode, const Options& options,
+	const std::vector<FenPosition>& positions) {
+	using Clock = std::chrono::steady_clock;
+	Measurement measurement;
+
+	// Each slot gets an entry whose key is made from the slot's number, so
+	// every entry survives and every lookup below finds one.
+	const auto setup_start{ Clock::now() };
+	TranspositionTable table{ options.megabytes, mode.memory };
+	const std::uint64_t mask{ table.get_capacity() - 1 };
+	const auto get_slot_key{ [mask](std::uint64_t slot) { return (mix(slot) & ~mask) | slot; } };
+	for (std::uint64_t slot{ 0 }; slot <= mask; slot++)
+		table.store({ get_slot_key(slot), std::nullopt, 0, 1, score_bound::exact });
+	const std::chrono::duration<double> setup_time{ Clock::now() - setup_start };
+	measurement.setup_seconds = setup_time.count();
+
+	measurement.pages = table.get_memory().get_page_size();
+	measurement.huge_page_bytes = table.get_memory().get_huge_page_bytes();
+	measurement.nodes = table.get_memory().get_node_count();
+
+	// The next slot comes from the entry that was just read.
+	std::uint64_t key{ get_slot_key(0) };
+	const auto lookup_start{ Clock::now() };
+	for (std::uint64_t i{ 0 }; i < options.probes; i++) {
+		const TranspositionEntry* entry{ table.probe(key) };
+		key = get_slot_key(mix(entry ? entry->key : key) & mask);
+	}
+	const std::chrono::duration<double> lookup_time{ Clock::now() - lookup_start };
+	const double probes{ static_cast<double>(std::max<std::uint64_t>(options.probes, 1)) };
+	measurement.lookup_nanoseconds = lookup_time.count() * 1e9 / probes;
+
+	benchmark_sink = benchmark_sink + key;
+
+	// The searches are short, so take the best of a few runs (each from an
+	// empty table) to keep other programs from skewing the result.
+	for (int run{ 0 }; run < 3; run++) {
+		table.clear();
+		std::uint64_t nodes{ 0 };
+		const auto search_start{ Clock::now() };
+		for (const auto& position : positions) {
+			table.start_new_search();
+			Search search{ { options.depth, 0 }, &table };
+			nodes += search.run(position.board, position.active_color).nodes;
+		}
+		const std::chrono::duration<double> search_time{ Clock::now() - search_start };
+		measurement.nodes_per_second = std::max(
+			measurement.nodes_per_second, static_cast<double>(nodes) / search_time.count());
+	}
+	return measurement;
+}
+
+static std::string format_change(double value, double baseline) {
+	const double percent{ (value / baseline - 1.0) * 100.0 };
+	return (percent >= 0.0 ? "+" : "") + std::to_string(static_cast<int>(percent)) + "%";
+}
+
+int main(int argc, char* argv[]) {
+	const auto maybe_options{ parse_options(argc, argv) };
+	if (!maybe_options) {
+		std::cerr << "Usage: " << argv[0] << " [--megabytes N] [--probes N] [--depth N]\n";
+		return 2;
+	}
+
+	try {
+		const Options& options{ *maybe_options };
+		std::vector<FenPosition> positions;
+		for (const char* fen : {
+				 "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+				 "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+				 "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+			 })
+			positions.push_back(*parse_fen(fen));
+
+		const TableMemory probe_memory{ 1, { page_size::standard, true } };
+		const bool has_nodes{ probe_memory.get_node_count() > 1 };
+		std::vector<Mode> modes;
+		for (const page_size pages :
+			{ page_size::standard, page_size::transparent, page_size::reserved }) {
+			modes.push_back({ { pages, false }, get_page_name(pages) });
+			if (has_nodes)
+				modes.push_back({ { pages, true }, get_page_name(pages) + ", spread over nodes" });
+		}
+
+		std::optional<Measurement> baseline;
+		for (const auto& mode : modes) {
+			const Measurement result{ measure(mode, options, positions) };
+			if (!baseline)
+				baseline = result;
+
+			std::cout << mode.name << ":\n";
+			std::cout << "  Got: " << get_page_name(result.pages) << ", "
+					  << result.huge_page_bytes / (1024 * 1024) << " MB in huge pages, on "
+					  << result.nodes << (result.nodes == 1 ? " node" : " nodes") << '\n';
+			std::cout << "  Setup: " << result.setup_seconds << " seconds\n";
+			std::cout << "  Lookup: " << result.lookup_nanoseconds << " ns ("
+					  << format_change(result.lookup_nanoseconds, baseline->lookup_nanoseconds)
+					  << ")\n";
+			std::cout << "  Search: " << result.nodes_per_second << " nodes per second ("
+					  << format_change(result.nodes_per_second, baseline->nodes_per_second)
+					  << ")\n";
+		}
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
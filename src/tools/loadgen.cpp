@@ -0,0 +1,338 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that puts load on chess-server. It opens many
+//          connections, creates many games, and then plays random legal
+//          moves in them as fast as the server answers. It reports the
+//          latency of each move and how much memory an idle game costs.
+//
+// Usage: chess-loadgen (--tcp [HOST:]PORT | --unix PATH) [OPTION...]
+//   --connections N    How many connections to open (default: 100).
+//   --games N          How many games each connection plays at once (default: 10).
+//   --moves N          How many moves each connection sends (default: 1000).
+//   --threads N        How many threads share the connections (default: all cores).
+//   --chess960         Play Chess960 games.
+//   --seed N           Seed the random moves (default: 1).
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring> // For std::strerror.
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../Board.h"
+#include "../chess960.h"
+#include "../fen.h"
+#include "../san.h"
+#include "parse_number.h"
+
+struct Options {
+	std::string host{ "127.0.0.1" };
+	int port{ 0 };
+	std::string unix_path;
+	int connections{ 100 };
+	int games{ 10 };
+	int moves{ 1000 };
+	unsigned threads{ std::max(std::thread::hardware_concurrency(), 1U) };
+	bool chess960{ false };
+	std::uint64_t seed{ 1 };
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	Options options;
+	bool has_address{ false };
+	for (int i{ 1 }; i < argc; i++) {
+		const std::string name{ argv[i] };
+		if (name == "--chess960") {
+			options.chess960 = true;
+			continue;
+		}
+		if (i + 1 >= argc)
+			return std::nullopt;
+
+		const std::string value{ argv[++i] };
+		if (name == "--tcp") {
+			const auto colon{ value.rfind(':') };
+			if (colon != std::string::npos)
+				options.host = value.substr(0, colon);
+			const auto port{ parse_number<int>(
+				colon == std::string::npos ? value : value.substr(colon + 1)) };
+			if (!port)
+				return std::nullopt;
+			options.port = *port;
+			has_address = true;
+		} else if (name == "--unix") {
+			options.unix_path = value;
+			has_address = true;
+		} else if (const auto number{ parse_number<std::uint64_t>(value) }) {
+			if (name == "--connections")
+				options.connections = std::max(static_cast<int>(*number), 1);
+			else if (name == "--games")
+				options.games = std::max(static_cast<int>(*number), 1);
+			else if (name == "--moves")
+				options.moves = static_cast<int>(*number);
+			else if (name == "--threads")
+				options.threads = std::max(static_cast<unsigned>(*number), 1U);
+			else if (name == "--seed")
+				options.seed = *number;
+			else
+				return std::nullopt;
+		} else {
+			return std::nullopt;
+		}
+	}
+
+	if (!has_address)
+		return std::nullopt;
+	return options;
+}
+
+// A blocking connection that sends and receives lines.
+class Client {
+public:
+	explicit Client(const Options& options) {
+		if (options.unix_path.empty()) {
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+			if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1)
+				throw std::runtime_error{ "Invalid IPv4 address: " + options.host };
+			open(AF_INET, reinterpret_cast<const sockaddr*>(&address), sizeof address);
+
+			const int enable{ 1 };
+			setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof enable);
+		} else {
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+			if (options.unix_path.size() >= sizeof address.sun_path)
+				throw std::runtime_error{ "Socket path is too long: " + options.unix_path };
+			std::copy(options.unix_path.begin(), options.unix_path.end(), address.sun_path);
+			open(AF_UNIX, reinterpret_cast<const sockaddr*>(&address), sizeof address);
+		}
+	}
+
+	~Client() {
+		if (descriptor >= 0)
+			close(descriptor);
+	}
+
+	Client(const Client&) = delete;
+	Client& operator=(const Client&) = delete;
+
+	Client(Client&& other) noexcept
+		: descriptor{ other.descriptor }
+		, buffer{ std::move(other.buffer) } {
+		other.descriptor = -1;
+	}
+
+	Client& operator=(Client&&) = delete;
+
+	// Send a command and wait for the one-line response.
+	std::string request(const std::string& line) {
+		const std::string message{ line + '\n' };
+		std::size_t sent_total{ 0 };
+		while (sent_total < message.size()) {
+			const auto sent{ send(descriptor, message.data() + sent_total,
+				message.size() - sent_total, MSG_NOSIGNAL) };
+			if (sent < 0 && errno == EINTR)
+				continue;
+			if (sent < 0)
+				throw std::runtime_error{ std::string{ "send: " } + std::strerror(errno) };
+			sent_total += static_cast<std::size_t>(sent);
+		}
+
+		for (;;) {
+			const auto end{ buffer.find('\n') };
+			if (end != std::string::npos) {
+				std::string response{ buffer.substr(0, end) };
+				buffer.erase(0, end + 1);
+				return response;
+			}
+
+			char chunk[4096];
+			const auto received{ recv(descriptor, chunk, sizeof chunk, 0) };
+			if (received < 0 && errno == EINTR)
+				continue;
+			if (received <= 0)
+				throw std::runtime_error{ "The server closed the connection" };
+			buffer.append(chunk, static_cast<std::size_t>(received));
+		}
+	}
+
+private:
+	void open(int domain, const sockaddr* address, socklen_t length) {
+		descriptor = socket(domain, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (descriptor < 0 || connect(descriptor, address, length) < 0)
+			throw std::runtime_error{ std::string{ "Could not connect: " } + std::strerror(errno) };
+	}
+
+	int descriptor{ -1 };
+	std::string buffer;
+};
+
+// The client keeps its own copy of each game so that it can choose legal moves.
+struct RemoteGame {
+	std::string id;
+	Board board;
+	color active_color{ color::white };
+};
+
+static std::string expect_ok(const std::string& response) {
+	if (response.rfind("ok", 0) != 0)
+		throw std::runtime_error{ "Unexpected response: " + response };
+	return response.size() > 3 ? response.substr(3) : "";
+}
+
+static RemoteGame start_game(Client& client, bool chess960) {
+	RemoteGame game;
+	game.id = expect_ok(client.request(chess960 ? "new chess960" : "new"));
+
+	// Ask for the position, since the server chose the Chess960 layout.
+	const std::string status{ expect_ok(client.request("status " + game.id)) };
+	const auto fen_start{ status.find(' ', status.find(' ') + 1) };
+	const auto position{ parse_fen(status.substr(fen_start + 1)) };
+	if (!position)
+		throw std::runtime_error{ "Invalid FEN from the server: " + status };
+	game.board = position->board;
+	game.active_color = position->active_color;
+	return game;
+}
+
+struct Connection {
+	Client client;
+	std::vector<RemoteGame> games;
+};
+
+static long get_server_memory(Client& client) {
+	const std::string stats{ expect_ok(client.request("stats")) };
+	const auto start{ stats.find("rss_kb=") };
+	if (start == std::string::npos)
+		return 0;
+	const auto end{ stats.find(' ', start) };
+	const std::string value{
+		stats.substr(start + 7, end == std::string::npos ? end : end - start - 7)
+	};
+	return parse_number<long>(value).value_or(0);
+}
+
+// Run `work(connection, thread)` for every connection, spread across threads.
+template <typename Work>
+static void for_each_connection(const Options& options, const Work& work) {
+	std::vector<std::thread> threads;
+	std::exception_ptr error;
+	std::mutex mutex;
+	for (unsigned t{ 0 }; t < options.threads; t++) {
+		threads.emplace_back([&, t] {
+			try {
+				for (auto i{ static_cast<int>(t) }; i < options.connections;
+					 i += static_cast<int>(options.threads))
+					work(static_cast<std::size_t>(i), t);
+			} catch (...) {
+				const std::lock_guard lock{ mutex };
+				error = std::current_exception();
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	if (error)
+		std::rethrow_exception(error);
+}
+
+int main(int argc, char* argv[]) {
+	const auto maybe_options{ parse_options(argc, argv) };
+	if (!maybe_options) {
+		std::cerr << "Usage: " << argv[0]
+				  << " (--tcp [HOST:]PORT | --unix PATH) [--connections N] [--games N]"
+					 " [--moves N] [--threads N] [--chess960] [--seed N]\n";
+		return 2;
+	}
+
+	try {
+		const Options& options{ *maybe_options };
+		Client control{ options };
+		const long memory_before{ get_server_memory(control) };
+
+		std::vector<std::optional<Connection>> connections(
+			static_cast<std::size_t>(options.connections));
+		for_each_connection(options, [&](std::size_t i, unsigned) {
+			Connection connection{ Client{ options }, {} };
+			for (int g{ 0 }; g < options.games; g++)
+				connection.games.push_back(start_game(connection.client, options.chess960));
+			connections[i].emplace(std::move(connection));
+		});
+
+		const long memory_after{ get_server_memory(control) };
+		const long total_games{ static_cast<long>(options.connections) * options.games };
+		std::cout << "Games: " << total_games << " on " << options.connections << " connections\n";
+		std::cout << "Server memory: " << memory_before << " KiB before, " << memory_after
+				  << " KiB after (" << 1024.0 * static_cast<double>(memory_after - memory_before)
+						/ static_cast<double>(total_games)
+				  << " bytes per idle game)\n";
+
+		// Each thread records latencies in its own list.
+		std::vector<std::vector<double>> latencies(options.threads);
+		const auto start{ std::chrono::steady_clock::now() };
+		for_each_connection(options, [&](std::size_t i, unsigned thread) {
+			std::mt19937_64 prng{ options.seed * 0x9E3779B97F4A7C15 + i };
+			Connection& connection{ *connections[i] };
+			for (int m{ 0 }; m < options.moves; m++) {
+				RemoteGame& game{
+					connection.games[static_cast<std::size_t>(m) % connection.games.size()]
+				};
+				const auto moves{ game.board.get_all_legal_moves(game.active_color) };
+				const auto& legal_move{ moves[prng() % moves.size()] };
+
+				const auto sent{ std::chrono::steady_clock::now() };
+				const std::string status{ expect_ok(connection.client.request(
+					"move " + game.id + ' ' + format_coordinate_move(game.board, legal_move))) };
+				const std::chrono::duration<double, std::micro> latency{
+					std::chrono::steady_clock::now() - sent
+				};
+				latencies[thread].push_back(latency.count());
+
+				game.board.play(legal_move);
+				game.active_color = get_opposing_color(game.active_color);
+				if (status == "checkmate" || status == "stalemate") {
+					expect_ok(connection.client.request("close " + game.id));
+					game = start_game(connection.client, options.chess960);
+				}
+			}
+		});
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+		std::vector<double> all;
+		for (const auto& list : latencies)
+			all.insert(all.end(), list.begin(), list.end());
+		std::sort(all.begin(), all.end());
+		if (all.empty())
+			return 0;
+
+		double sum{ 0.0 };
+		for (const double latency : all)
+			sum += latency;
+		const auto percentile{ [&all](double p) {
+			return all[std::min(static_cast<std::size_t>(p * static_cast<double>(all.size())),
+				all.size() - 1)];
+		} };
+
+		std::cout << "Moves: " << all.size() << " in " << elapsed.count() << " seconds ("
+				  << static_cast<double>(all.size()) / elapsed.count() << " per second)\n";
+		std::cout << "Latency per move (microseconds): mean "
+				  << sum / static_cast<double>(all.size()) << ", p50 " << percentile(0.5)
+				  << ", p99 " << percentile(0.99) << ", max " << all.back() << '\n';
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
@@ -0,0 +1,323 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that plays many engine-versus-engine games at
+//          once and reports the Elo difference between the two engines. A
+//          sequential probability ratio test (SPRT) can stop the match as
+//          soon as the result is clear.
+//
+// Usage: chess-match [OPTION...]
+//   --games N          The most games to play (default: 1000).
+//   --threads N        How many games to play at once (default: all cores).
+//   --depth1 N         The first engine's search depth (default: 2).
+//   --depth2 N         The second engine's search depth (default: 2).
+//   --nodes1 N         The first engine's node limit per move (default: none).
+//   --nodes2 N         The second engine's node limit per move (default: none).
+//   --chess960         Start from random Chess960 positions.
+//   --openings FILE    Start from the FEN or EPD positions in FILE, one per line.
+//   --random-plies N   Play N random moves before the engines take over (default: 0).
+//   --max-plies N      Adjudicate games as draws after N plies (default: 400).
+//   --seed N           Seed the random choices (default: 1).
+//   --sprt ELO0 ELO1   Test whether the first engine is ELO1 stronger (H1) or
+//                      only ELO0 stronger (H0), with alpha = beta = 0.05.
+//
+// Each opening is played twice so that both engines get to play both colors.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib> // For std::strtod.
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "../MappedFile.h"
+#include "../Referee.h"
+#include "../Search.h"
+#include "../chess960.h"
+#include "../fen.h"
+#include "parse_number.h"
+
+struct Options {
+	int games{ 1000 };
+	unsigned threads{ std::max(std::thread::hardware_concurrency(), 1U) };
+	SearchLimits engine1{};
+	SearchLimits engine2{};
+	bool chess960{ false };
+	std::string openings_path;
+	int random_plies{ 0 };
+	int max_plies{ 400 };
+	std::uint64_t seed{ 1 };
+	bool sprt{ false };
+	double elo0{ 0.0 };
+	double elo1{ 5.0 };
+	double alpha{ 0.05 };
+	double beta{ 0.05 };
+};
+
+struct Opening {
+	Board board;
+	color active_color{ color::white };
+};
+
+// Wins, draws, and losses from the first engine's point of view.
+struct Tally {
+	int wins{ 0 };
+	int draws{ 0 };
+	int losses{ 0 };
+
+	int get_games() const { return wins + draws + losses; }
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	Options options;
+	for (int i{ 1 }; i < argc; i++) {
+		const std::string name{ argv[i] };
+		const bool has_value{ i + 1 < argc };
+		if (name == "--chess960") {
+			options.chess960 = true;
+		} else if (name == "--sprt" && i + 2 < argc) {
+			const auto elo0{ parse_number<double>(argv[++i]) };
+			const auto elo1{ parse_number<double>(argv[++i]) };
+			if (!elo0 || !elo1)
+				return std::nullopt;
+			options.sprt = true;
+			options.elo0 = *elo0;
+			options.elo1 = *elo1;
+		} else if (!has_value) {
+			return std::nullopt;
+		} else if (name == "--openings") {
+			options.openings_path = argv[++i];
+		} else {
+			const auto value{ parse_number<std::uint64_t>(argv[++i]) };
+			if (!value)
+				return std::nullopt;
+			if (name == "--games")
+				options.games = static_cast<int>(*value);
+			else if (name == "--threads")
+				options.threads = std::max(static_cast<unsigned>(*value), 1U);
+			else if (name == "--depth1")
+				options.engine1.depth = static_cast<int>(*value);
+			else if (name == "--depth2")
+				options.engine2.depth = static_cast<int>(*value);
+			else if (name == "--nodes1")
+				options.engine1.nodes = *value;
+			else if (name == "--nodes2")
+				options.engine2.nodes = *value;
+			else if (name == "--random-plies")
+				options.random_plies = static_cast<int>(*value);
+			else if (name == "--max-plies")
+				options.max_plies = static_cast<int>(*value);
+			else if (name == "--seed")
+				options.seed = *value;
+			else
+				return std::nullopt;
+		}
+	}
+	return options;
+}
+
+static std::vector<Opening> load_openings(const std::string& path) {
+	const MappedFile file{ path };
+	const std::string_view text{ file.view() };
+	std::vector<Opening> openings;
+	std::size_t start{ 0 };
+	while (start < text.size()) {
+		std::size_t end{ text.find('\n', start) };
+		if (end == std::string_view::npos)
+			end = text.size();
+
+		const std::string_view line{ text.substr(start, end - start) };
+		start = end + 1;
+		if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+			continue;
+
+		const auto position{ parse_fen(line) };
+		if (!position)
+			throw std::runtime_error{ "Invalid opening: " + std::string{ line } };
+		openings.push_back({ position->board, position->active_color });
+	}
+
+	if (openings.empty())
+		throw std::runtime_error{ path + " has no openings" };
+	return openings;
+}
+
+// Both games of a pair start from the same position, so the choice only
+// depends on the seed and the pair number.
+static Opening choose_opening(
+	int pair, const Options& options, const std::vector<Opening>& openings) {
+	std::mt19937_64 prng{ options.seed * 0x9E3779B97F4A7C15 + static_cast<std::uint64_t>(pair) };
+	Opening opening;
+	if (!openings.empty())
+		opening = openings[static_cast<std::size_t>(pair) % openings.size()];
+	else if (options.chess960)
+		opening.board = generate_chess960_board(static_cast<int>(prng() % 960));
+
+	for (int ply{ 0 }; ply < options.random_plies; ply++) {
+		const auto moves{ opening.board.get_all_legal_moves(opening.active_color) };
+		if (moves.empty())
+			break;
+
+		opening.board.play(moves[prng() % moves.size()]);
+		opening.active_color = get_opposing_color(opening.active_color);
+	}
+	return opening;
+}
+
+static GameOutcome play_game(const Opening& opening, SearchLimits white, SearchLimits black,
+	int max_plies) {
+	Referee referee{ opening.board, opening.active_color, max_plies };
+	for (;;) {
+		const Board& board{ referee.get_board() };
+		const color active_color{ referee.get_active_color() };
+		const auto legal_moves{ board.get_all_legal_moves(active_color) };
+		const auto outcome{ referee.adjudicate(legal_moves) };
+		if (outcome)
+			return *outcome;
+
+		Search search{ active_color == color::white ? white : black };
+		const auto best_move{ search.run(board, active_color).best_move };
+		referee.play(best_move ? *best_move : legal_moves.front());
+	}
+}
+
+static double get_expected_score(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+static double get_elo(double score) {
+	score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+	return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+struct ScoreStatistics {
+	double mean;
+	// The variance of a single game's score.
+	double variance;
+};
+
+static ScoreStatistics get_score_statistics(const Tally& tally) {
+	const double games{ static_cast<double>(tally.get_games()) };
+	const double win_rate{ tally.wins / games };
+	const double draw_rate{ tally.draws / games };
+	const double mean{ win_rate + draw_rate / 2.0 };
+	return { mean, win_rate + draw_rate / 4.0 - mean * mean };
+}
+
+// The log-likelihood ratio of H1 (Elo difference is `elo1`) to H0 (Elo
+// difference is `elo0`), using a normal approximation of the game scores.
+static double get_log_likelihood_ratio(const Tally& tally, double elo0, double elo1) {
+	if (tally.get_games() == 0)
+		return 0.0;
+
+	const auto [mean, variance]{ get_score_statistics(tally) };
+	if (variance <= 0.0)
+		return 0.0;
+
+	const double score0{ get_expected_score(elo0) };
+	const double score1{ get_expected_score(elo1) };
+	return tally.get_games() * (score1 - score0) * (2.0 * mean - score0 - score1)
+		/ (2.0 * variance);
+}
+
+static void print_elo(const Tally& tally) {
+	if (tally.get_games() == 0)
+		return;
+
+	// Use a 95% confidence interval.
+	const auto [mean, variance]{ get_score_statistics(tally) };
+	const double margin{ 1.96 * std::sqrt(variance / tally.get_games()) };
+	const double elo{ get_elo(mean) };
+	const double error{ (get_elo(mean + margin) - get_elo(mean - margin)) / 2.0 };
+	std::cout << "Score: " << 100.0 * mean << "%, Elo: " << elo << " +/- " << error << '\n';
+}
+
+int main(int argc, char* argv[]) {
+	const auto maybe_options{ parse_options(argc, argv) };
+	if (!maybe_options) {
+		std::cerr << "Usage: " << argv[0]
+				  << " [--games N] [--threads N] [--depth1 N] [--depth2 N] [--nodes1 N]"
+					 " [--nodes2 N] [--chess960] [--openings FILE] [--random-plies N]"
+					 " [--max-plies N] [--seed N] [--sprt ELO0 ELO1]\n";
+		return 2;
+	}
+
+	try {
+		const Options& options{ *maybe_options };
+		const auto openings{ options.openings_path.empty()
+				? std::vector<Opening>{}
+				: load_openings(options.openings_path) };
+		const double lower_bound{ std::log(options.beta / (1.0 - options.alpha)) };
+		const double upper_bound{ std::log((1.0 - options.beta) / options.alpha) };
+
+		std::mutex mutex;
+		Tally tally;
+		std::atomic<int> next_game{ 0 };
+		std::atomic<bool> concluded{ false };
+		const auto start{ std::chrono::steady_clock::now() };
+
+		const auto work{ [&] {
+			for (;;) {
+				const int game{ next_game.fetch_add(1) };
+				if (game >= options.games || concluded.load())
+					return;
+
+				// The first engine plays White in even games and Black in odd games.
+				const bool engine1_is_white{ game % 2 == 0 };
+				const Opening opening{ choose_opening(game / 2, options, openings) };
+				const auto outcome{ play_game(opening,
+					engine1_is_white ? options.engine1 : options.engine2,
+					engine1_is_white ? options.engine2 : options.engine1, options.max_plies) };
+
+				const std::lock_guard lock{ mutex };
+				const char* result{ "1/2-1/2" };
+				if (outcome.result == game_result::draw) {
+					tally.draws++;
+				} else {
+					const bool white_won{ outcome.result == game_result::white_wins };
+					(white_won == engine1_is_white ? tally.wins : tally.losses)++;
+					result = white_won ? "1-0" : "0-1";
+				}
+
+				std::cout << "Game " << game + 1 << " (engine "
+						  << (engine1_is_white ? "1" : "2") << " as White): " << result << " by "
+						  << get_termination_name(outcome.termination) << ". Total: +"
+						  << tally.wins << " =" << tally.draws << " -" << tally.losses << '\n';
+
+				if (options.sprt && !concluded.load()) {
+					const double llr{ get_log_likelihood_ratio(tally, options.elo0, options.elo1) };
+					if (llr <= lower_bound || upper_bound <= llr)
+						concluded.store(true);
+				}
+			}
+		} };
+
+		std::vector<std::thread> threads;
+		for (unsigned i{ 0 }; i < options.threads; i++)
+			threads.emplace_back(work);
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+		std::cout << "\nGames: " << tally.get_games() << " (+" << tally.wins << " ="
+				  << tally.draws << " -" << tally.losses << ")\n";
+		print_elo(tally);
+
+		if (options.sprt) {
+			const double llr{ get_log_likelihood_ratio(tally, options.elo0, options.elo1) };
+			std::cout << "SPRT [" << options.elo0 << ", " << options.elo1 << "]: LLR " << llr
+					  << " (" << lower_bound << ", " << upper_bound << ") ";
+			if (llr >= upper_bound)
+				std::cout << "H1 accepted.\n";
+			else if (llr <= lower_bound)
+				std::cout << "H0 accepted.\n";
+			else
+				std::cout << "inconclusive.\n";
+		}
+
+		std::cout << "Seconds: " << elapsed.count() << " using " << options.threads
+				  << " threads\n";
+		std::cout << "Games per hour: " << tally.get_games() * 3600.0 / elapsed.count() << '\n';
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
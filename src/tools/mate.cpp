@@ -0,0 +1,192 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that solves a file of mate puzzles with the
+//          proof-number mate solver, several puzzles at once, and reports
+//          how many puzzles it solves per second.
+//
+// Usage: chess-mate FILE [OPTION...]
+//   --moves N          Look for mates in up to N moves (default: 3).
+//   --threads N        How many puzzles to solve at once (default: all cores).
+//   --table MB         The size of each thread's node table (default: 16).
+//   --nodes N          Give up on a puzzle after N nodes (default: none).
+//
+// FILE has one FEN or EPD position per line, with the attacker to move. An
+// EPD 'dm N' (direct mate) operation replaces --moves for that puzzle.
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../MappedFile.h"
+#include "../MateSolver.h"
+#include "../fen.h"
+#include "../san.h"
+#include "parse_number.h"
+
+struct Options {
+	std::string path;
+	int moves{ 3 };
+	unsigned threads{ std::max(std::thread::hardware_concurrency(), 1U) };
+	std::size_t table_megabytes{ 16 };
+	std::uint64_t nodes{ 0 };
+};
+
+struct Puzzle {
+	Board board;
+	color attacker{ color::white };
+	// Zero means the puzzle doesn't say.
+	int moves{ 0 };
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	if (argc < 2)
+		return std::nullopt;
+
+	Options options;
+	options.path = argv[1];
+	for (int i{ 2 }; i + 1 < argc; i += 2) {
+		const std::string name{ argv[i] };
+		const auto value{ parse_number<std::uint64_t>(argv[i + 1]) };
+		if (!value)
+			return std::nullopt;
+		if (name == "--moves")
+			options.moves = std::max(static_cast<int>(*value), 1);
+		else if (name == "--threads")
+			options.threads = std::max(static_cast<unsigned>(*value), 1U);
+		else if (name == "--table")
+			options.table_megabytes = static_cast<std::size_t>(*value);
+		else if (name == "--nodes")
+			options.nodes = *value;
+		else
+			return std::nullopt;
+	}
+	if (argc % 2 != 0)
+		return std::nullopt;
+	return options;
+}
+
+// Read the number after a 'dm' operation, like in '... w - - dm 3;'.
+static int get_direct_mate(std::string_view line) {
+	const std::size_t operation{ line.find(" dm ") };
+	if (operation == std::string_view::npos)
+		return 0;
+
+	int moves{ 0 };
+	for (std::size_t i{ operation + 4 }; i < line.size() && '0' <= line[i] && line[i] <= '9'; i++)
+		moves = moves * 10 + (line[i] - '0');
+	return moves;
+}
+
+static std::vector<Puzzle> load_puzzles(const std::string& path) {
+	const MappedFile file{ path };
+	const std::string_view text{ file.view() };
+	std::vector<Puzzle> puzzles;
+	std::size_t start{ 0 };
+	while (start < text.size()) {
+		std::size_t end{ text.find('\n', start) };
+		if (end == std::string_view::npos)
+			end = text.size();
+
+		const std::string_view line{ text.substr(start, end - start) };
+		start = end + 1;
+		if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+			continue;
+
+		const auto position{ parse_fen(line) };
+		if (!position)
+			throw std::runtime_error{ "Invalid puzzle: " + std::string{ line } };
+		puzzles.push_back({ position->board, position->active_color, get_direct_mate(line) });
+	}
+
+	if (puzzles.empty())
+		throw std::runtime_error{ path + " has no puzzles" };
+	return puzzles;
+}
+
+static std::string format_line(Board board, const std::vector<LegalMove>& line) {
+	std::string text;
+	for (const auto& move : line) {
+		if (!text.empty())
+			text += ' ';
+		text += format_san(board, move);
+		board.play(move);
+	}
+	return text;
+}
+
+int main(int argc, char* argv[]) {
+	const auto maybe_options{ parse_options(argc, argv) };
+	if (!maybe_options) {
+		std::cerr << "Usage: " << argv[0]
+				  << " FILE [--moves N] [--threads N] [--table MB] [--nodes N]\n";
+		return 2;
+	}
+
+	try {
+		const Options& options{ *maybe_options };
+		const auto puzzles{ load_puzzles(options.path) };
+
+		std::mutex mutex;
+		int proven{ 0 };
+		int disproven{ 0 };
+		int unknown{ 0 };
+		std::uint64_t total_nodes{ 0 };
+		std::atomic<std::size_t> next_puzzle{ 0 };
+		const auto start{ std::chrono::steady_clock::now() };
+
+		const auto work{ [&] {
+			MateSolver solver{ options.table_megabytes };
+			for (;;) {
+				const std::size_t index{ next_puzzle.fetch_add(1) };
+				if (index >= puzzles.size())
+					return;
+
+				// Nodes from one puzzle are no use for another.
+				const Puzzle& puzzle{ puzzles[index] };
+				const int moves{ puzzle.moves != 0 ? puzzle.moves : options.moves };
+				solver.clear();
+				const auto solution{ solver.solve(
+					puzzle.board, puzzle.attacker, moves, options.nodes) };
+
+				const std::lock_guard lock{ mutex };
+				total_nodes += solution.nodes;
+				std::cout << "Puzzle " << index + 1 << ": ";
+				switch (solution.proof) {
+				case mate_proof::proven:
+					proven++;
+					std::cout << "mate in " << solution.moves << ": "
+							  << format_line(puzzle.board, solution.line);
+					break;
+				case mate_proof::disproven:
+					disproven++;
+					std::cout << "no mate in " << moves;
+					break;
+				case mate_proof::unknown:
+					unknown++;
+					std::cout << "unknown";
+					break;
+				}
+				std::cout << " (" << solution.nodes << " nodes)\n";
+			}
+		} };
+
+		std::vector<std::thread> threads;
+		for (unsigned i{ 0 }; i < options.threads; i++)
+			threads.emplace_back(work);
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+		std::cout << "\nPuzzles: " << puzzles.size() << " (" << proven << " mates, " << disproven
+				  << " without mate, " << unknown << " unknown)\n";
+		std::cout << "Nodes: " << total_nodes << '\n';
+		std::cout << "Seconds: " << elapsed.count() << " using " << options.threads
+				  << " threads\n";
+		std::cout << "Puzzles per second: " << (proven + disproven) / elapsed.count() << '\n';
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
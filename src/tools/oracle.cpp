@@ -0,0 +1,189 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that plays random games on every core and
+//          checks the fast move generators against the reference rules (see
+//          move_oracle.h) in every position. Mismatches are reported with
+//          the game that led to them and a minimized position.
+//
+// Usage: chess-oracle [OPTION...]
+//   --games N             How many games to play (default: 200).
+//   --threads N           How many games to play at once (default: all cores).
+//   --max-plies N         Stop each game after N plies (default: 300).
+//   --chess960-percent N  Start N% of the games from Chess960 positions (default: 50).
+//   --seed N              Seed the random moves (default: 1).
+//
+// Pawn moves are picked more often than their share, so that games reach en
+// passant and promotions. Each game only depends on the seed and its number,
+// so a reported game can be played again on its own.
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "../chess960.h"
+#include "../fen.h"
+#include "../move_oracle.h"
+#include "../san.h"
+#include "parse_number.h"
+
+struct Options {
+	int games{ 200 };
+	unsigned threads{ std::max(std::thread::hardware_concurrency(), 1U) };
+	int max_plies{ 300 };
+	int chess960_percent{ 50 };
+	std::uint64_t seed{ 1 };
+};
+
+struct Mismatch {
+	int game{ 0 };
+	std::string start;
+	std::string moves;
+	std::string position;
+	std::string minimized;
+	Discrepancy discrepancy;
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	Options options;
+	for (int i{ 1 }; i + 1 < argc; i += 2) {
+		const std::string name{ argv[i] };
+		const auto value{ parse_number<std::uint64_t>(argv[i + 1]) };
+		if (!value)
+			return std::nullopt;
+		if (name == "--games")
+			options.games = static_cast<int>(*value);
+		else if (name == "--threads")
+			options.threads = std::max(static_cast<unsigned>(*value), 1U);
+		else if (name == "--max-plies")
+			options.max_plies = static_cast<int>(*value);
+		else if (name == "--chess960-percent")
+			options.chess960_percent = static_cast<int>(*value);
+		else if (name == "--seed")
+			options.seed = *value;
+		else
+			return std::nullopt;
+	}
+	if (argc % 2 == 0)
+		return std::nullopt;
+	return options;
+}
+
+static const LegalMove& choose_move(const std::vector<LegalMove>& moves, const Board& board,
+	std::mt19937_64& prng) {
+	if (prng() % 2 == 0) {
+		std::vector<const LegalMove*> pawn_moves;
+		for (const auto& legal_move : moves) {
+			if (board.get_piece(legal_move.move.from)->type == piece_type::pawn)
+				pawn_moves.push_back(&legal_move);
+		}
+		if (!pawn_moves.empty())
+			return *pawn_moves[prng() % pawn_moves.size()];
+	}
+	return moves[prng() % moves.size()];
+}
+
+// Play one game and return the first mismatch in it, if any. The moves
+// come from the reference, so a broken fast generator can't steer the game.
+static std::optional<Mismatch> play_game(
+	int game, const Options& options, std::uint64_t& positions) {
+	std::mt19937_64 prng{ options.seed * 0x9E3779B97F4A7C15 + static_cast<std::uint64_t>(game) };
+	Board board;
+	if (static_cast<int>(prng() % 100) < options.chess960_percent)
+		board = generate_chess960_board(static_cast<int>(prng() % 960));
+
+	const std::string start{ format_fen(board, color::white) };
+	std::string moves;
+	color active_color{ color::white };
+	for (int ply{ 0 }; ply <= options.max_plies; ply++) {
+		positions++;
+		const auto legal_moves{ generate_reference_moves(board, active_color) };
+		if (const auto discrepancy{ check_move_generators(board, active_color, legal_moves) }) {
+			const Board minimized{ minimize_discrepancy(board, active_color, *discrepancy) };
+			return Mismatch{ game, start, moves, format_fen(board, active_color),
+				format_fen(minimized, active_color), *discrepancy };
+		}
+
+		if (legal_moves.empty() || ply == options.max_plies)
+			break;
+
+		const LegalMove& legal_move{ choose_move(legal_moves, board, prng) };
+		moves += (moves.empty() ? "" : " ") + format_coordinate_move(board, legal_move);
+		board.play(legal_move);
+		active_color = get_opposing_color(active_color);
+	}
+	return std::nullopt;
+}
+
+static void print_mismatch(const Mismatch& mismatch) {
+	std::cout << "Mismatch in game " << mismatch.game + 1 << ": "
+			  << mismatch.discrepancy.source << ": " << mismatch.discrepancy.description
+			  << "\n  Start: " << mismatch.start << "\n  Moves: " << mismatch.moves
+			  << "\n  Position: " << mismatch.position
+			  << "\n  Minimized: " << mismatch.minimized;
+
+	// The minimized position is only a reproducer if the mismatch survives
+	// the trip through FEN.
+	const auto position{ parse_fen(mismatch.minimized) };
+	const auto again{ position ? check_move_generators(position->board, position->active_color)
+							   : std::nullopt };
+	if (again)
+		std::cout << "\n  From the minimized FEN: " << again->description << '\n';
+	else
+		std::cout << "\n  (The minimized FEN doesn't reproduce it. Replay the moves instead.)\n";
+}
+
+int main(int argc, char* argv[]) {
+	const auto maybe_options{ parse_options(argc, argv) };
+	if (!maybe_options) {
+		std::cerr << "Usage: " << argv[0]
+				  << " [--games N] [--threads N] [--max-plies N] [--chess960-percent N]"
+					 " [--seed N]\n";
+		return 2;
+	}
+
+	try {
+		const Options& options{ *maybe_options };
+		std::mutex mutex;
+		std::vector<Mismatch> mismatches;
+		std::atomic<int> next_game{ 0 };
+		std::atomic<std::uint64_t> total_positions{ 0 };
+		const auto start{ std::chrono::steady_clock::now() };
+
+		const auto work{ [&] {
+			std::uint64_t positions{ 0 };
+			for (;;) {
+				const int game{ next_game.fetch_add(1) };
+				if (game >= options.games)
+					break;
+
+				if (const auto mismatch{ play_game(game, options, positions) }) {
+					const std::lock_guard lock{ mutex };
+					print_mismatch(*mismatch);
+					mismatches.push_back(*mismatch);
+				}
+			}
+			total_positions += positions;
+		} };
+
+		std::vector<std::thread> threads;
+		for (unsigned i{ 0 }; i < options.threads; i++)
+			threads.emplace_back(work);
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+		std::cout << "Games: " << options.games << ", positions: " << total_positions
+				  << ", mismatches: " << mismatches.size() << '\n';
+		std::cout << "Seconds: " << elapsed.count() << " using " << options.threads
+				  << " threads\n";
+		std::cout << "Positions per second: "
+				  << static_cast<double>(total_positions.load()) / elapsed.count() << '\n';
+		return mismatches.empty() ? 0 : 1;
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
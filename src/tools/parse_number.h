@@ -0,0 +1,37 @@
+// Author: Daniel Kareh
+// Summary: Number parsing for the options of the command line tools. Unlike
+//          `std::stoi` and its relatives, these don't throw, so a bad value
+//          gets the usage message instead of ending the program.
+
+#ifndef CHESS_PARSE_NUMBER_H
+#define CHESS_PARSE_NUMBER_H
+
+#include <charconv> // For std::from_chars.
+#include <cstdlib> // For std::strtod.
+#include <optional>
+#include <string>
+#include <string_view>
+
+// The whole string must be the number. Unsigned types don't take a sign.
+template <typename T>
+std::optional<T> parse_number(std::string_view string) {
+	T value{};
+	const char* end{ string.data() + string.size() };
+	const auto result{ std::from_chars(string.data(), end, value) };
+	if (result.ec != std::errc{} || result.ptr != end)
+		return std::nullopt;
+	return value;
+}
+
+// Not every standard library has `std::from_chars` for floating point yet.
+template <>
+inline std::optional<double> parse_number<double>(std::string_view string) {
+	const std::string copy{ string };
+	char* end{ nullptr };
+	const double value{ std::strtod(copy.c_str(), &end) };
+	if (copy.empty() || end != copy.c_str() + copy.size())
+		return std::nullopt;
+	return value;
+}
+
+#endif
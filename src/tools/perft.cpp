@@ -0,0 +1,119 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that counts every sequence of legal moves to a
+//          given depth (perft) and reports how fast the move generator went.
+//          The counts can be checked against published perft results.
+//
+// Usage: chess-perft [OPTION...]
+//   --depth N        Count sequences up to N plies long (default: 4).
+//   --fen FEN        Start from this position (default: the classical one).
+//   --chess960 N     Start from Chess960 position N (from 0 to 959).
+//   --divide         Also count the sequences after each first move.
+//
+// Chess960 position 518 is the classical starting position, but its board
+// always uses the general Chess960 castling rules. Comparing it with the
+// default position measures what the classical castling rules save.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../chess960.h"
+#include "../fen.h"
+#include "../san.h"
+#include "parse_number.h"
+
+struct Options {
+	int depth{ 4 };
+	Board board;
+	color active_color{ color::white };
+	bool divide{ false };
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	Options options;
+	for (int i{ 1 }; i < argc; i++) {
+		const std::string name{ argv[i] };
+		const bool has_value{ i + 1 < argc };
+		if (name == "--divide") {
+			options.divide = true;
+		} else if (!has_value) {
+			return std::nullopt;
+		} else if (name == "--depth") {
+			const auto depth{ parse_number<int>(argv[++i]) };
+			if (!depth)
+				return std::nullopt;
+			options.depth = *depth;
+		} else if (name == "--fen") {
+			const auto position{ parse_fen(argv[++i]) };
+			if (!position)
+				return std::nullopt;
+			options.board = position->board;
+			options.active_color = position->active_color;
+		} else if (name == "--chess960") {
+			const auto index{ parse_number<int>(argv[++i]) };
+			if (!index || *index < 0 || 959 < *index)
+				return std::nullopt;
+			options.board = generate_chess960_board(*index);
+			options.active_color = color::white;
+		} else {
+			return std::nullopt;
+		}
+	}
+	return options;
+}
+
+// Moves are made and taken back on one board, so nothing is copied.
+static std::uint64_t perft(Board& board, color active_color, int depth) {
+	if (depth <= 0)
+		return 1;
+
+	MoveList legal_moves;
+	board.generate_legal_moves(active_color, legal_moves);
+	if (depth == 1)
+		return legal_moves.size();
+
+	std::uint64_t nodes{ 0 };
+	for (const auto& legal_move : legal_moves) {
+		const auto undo{ board.make_move(legal_move) };
+		nodes += perft(board, get_opposing_color(active_color), depth - 1);
+		board.unmake_move(undo);
+	}
+	return nodes;
+}
+
+static void divide(Board board, color active_color, int depth) {
+	MoveList legal_moves;
+	board.generate_legal_moves(active_color, legal_moves);
+	for (const auto& legal_move : legal_moves) {
+		const auto name{ format_coordinate_move(board, legal_move) };
+		const auto undo{ board.make_move(legal_move) };
+		std::cout << name << ": " << perft(board, get_opposing_color(active_color), depth - 1)
+				  << '\n';
+		board.unmake_move(undo);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const auto options{ parse_options(argc, argv) };
+	if (!options || options->depth < 1) {
+		std::cerr << "Usage: " << argv[0]
+				  << " [--depth N] [--fen FEN | --chess960 N] [--divide]\n";
+		return 2;
+	}
+
+	const bool is_classical{ options->board.get_variant() == variant::classical };
+	std::cout << "Castling rules: " << (is_classical ? "classical" : "Chess960") << '\n';
+	if (options->divide)
+		divide(options->board, options->active_color, options->depth);
+
+	using Clock = std::chrono::steady_clock;
+	for (int depth{ 1 }; depth <= options->depth; depth++) {
+		Board board{ options->board };
+		const auto start{ Clock::now() };
+		const auto nodes{ perft(board, options->active_color, depth) };
+		const std::chrono::duration<double> elapsed{ Clock::now() - start };
+		const double seconds{ elapsed.count() };
+		std::cout << "Depth " << depth << ": " << nodes << " nodes in " << seconds << " s ("
+				  << static_cast<double>(nodes) / std::max(seconds, 1e-9) << " nodes/s)\n";
+	}
+}
@@ -0,0 +1,96 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that replays every game in a PGN file and
+//          reports how fast the games were read. It can also write the games
+//          back out in a normalized form (standard SAN, 79-column lines).
+//
+// Captures that lose material by static exchange evaluation (see see.h) are
+// counted as a quick flag for blunders.
+//
+// Usage: chess-pgn INPUT [OUTPUT]
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include "../MappedFile.h"
+#include "../pgn.h"
+#include "../see.h"
+
+int main(int argc, char* argv[]) {
+	if (argc != 2 && argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " INPUT [OUTPUT]\n";
+		return 2;
+	}
+
+	try {
+		const MappedFile file{ argv[1] };
+		file.advise_sequential();
+
+		std::FILE* output{ nullptr };
+		if (argc == 3) {
+			output = std::fopen(argv[2], "wb");
+			if (output == nullptr) {
+				std::cerr << "Cannot write " << argv[2] << '\n';
+				return 1;
+			}
+		}
+
+		const auto start{ std::chrono::steady_clock::now() };
+		PgnReader reader{ file.view() };
+		PgnGame game;
+		std::string text;
+		std::vector<PgnWriterTag> tags;
+		std::size_t game_count{ 0 };
+		std::size_t move_count{ 0 };
+		std::size_t invalid_count{ 0 };
+		std::size_t losing_capture_count{ 0 };
+		while (reader.next(game)) {
+			game_count++;
+			const auto moves{ replay_pgn_game(game) };
+			if (!moves) {
+				invalid_count++;
+				std::cerr << "Game " << game_count << " has an invalid move.\n";
+				continue;
+			}
+			move_count += moves->size();
+
+			Board board{ get_starting_position(game)->board };
+			for (const auto& legal_move : *moves) {
+				if (legal_move.details.captured_square && evaluate_exchange(board, legal_move) < 0)
+					losing_capture_count++;
+				board.play(legal_move);
+			}
+
+			if (output == nullptr)
+				continue;
+
+			tags.clear();
+			for (const auto& tag : game.tags)
+				tags.push_back({ std::string{ tag.name }, unescape_pgn_string(tag.value) });
+
+			text.clear();
+			const auto result{ game.get_tag("Result").value_or("*") };
+			write_pgn_game(text, tags, *get_starting_position(game), *moves, result);
+			std::fwrite(text.data(), 1, text.size(), output);
+		}
+
+		if (output != nullptr && std::fclose(output) != 0) {
+			std::cerr << "Cannot write " << argv[2] << '\n';
+			return 1;
+		}
+
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+		std::cout << "Games: " << game_count << " (" << invalid_count << " invalid)\n";
+		std::cout << "Moves: " << move_count << '\n';
+		std::cout << "Losing captures: " << losing_capture_count << '\n';
+		std::cout << "Seconds: " << elapsed.count() << '\n';
+		std::cout << "Games per second: " << static_cast<double>(game_count) / elapsed.count()
+				  << '\n';
+		std::cout << "Moves per second: " << static_cast<double>(move_count) / elapsed.count()
+				  << '\n';
+		return invalid_count == 0 ? 0 : 1;
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
@@ -0,0 +1,82 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that builds and probes position databases.
+//
+// Usage: chess-positions build OUTPUT INPUT... [--threads N]
+//        chess-positions probe DATABASE FEN
+// The inputs have one FEN or EPD record per line.
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <thread>
+#include "../fen.h"
+#include "../position_db.h"
+#include "parse_number.h"
+
+static int build(const std::string& output, const std::vector<std::string>& inputs,
+	unsigned threads) {
+	const auto start{ std::chrono::steady_clock::now() };
+	const auto stats{ build_position_database(inputs, output, threads) };
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+	std::cout << "Lines: " << stats.lines << '\n';
+	std::cout << "Invalid lines: " << stats.invalid_lines << '\n';
+	std::cout << "Unique positions: " << stats.unique_positions << '\n';
+	std::cout << "Finished in " << elapsed.count() << " seconds using " << threads
+			  << " threads ("
+			  << static_cast<double>(stats.lines - stats.invalid_lines) / elapsed.count()
+			  << " positions per second).\n";
+	return 0;
+}
+
+static int probe(const std::string& path, const std::string& fen) {
+	const auto position{ parse_fen(fen) };
+	if (!position) {
+		std::cerr << "Invalid FEN: " << fen << '\n';
+		return 1;
+	}
+
+	const PositionDatabase database{ path };
+	const auto record{ database.find(position->board, position->active_color) };
+	if (!record) {
+		std::cout << "Not found in " << database.size() << " positions.\n";
+		return 1;
+	}
+
+	const FenPosition& found{ record->position };
+	std::cout << "Stored as "
+			  << format_fen(found.board, found.active_color, found.halfmove_clock,
+					 found.fullmove_number)
+			  << '\n';
+	std::cout << "Seen " << record->count << " times.\n";
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	const std::string command{ argc > 1 ? argv[1] : "" };
+	try {
+		if (command == "build" && argc >= 4) {
+			std::optional<unsigned> threads{ std::thread::hardware_concurrency() };
+			std::vector<std::string> inputs;
+			for (int i{ 3 }; i < argc; i++) {
+				const std::string argument{ argv[i] };
+				if (argument == "--threads" && i + 1 < argc)
+					threads = parse_number<unsigned>(argv[++i]);
+				else
+					inputs.push_back(argument);
+			}
+			if (threads && !inputs.empty())
+				return build(argv[2], inputs, std::max(*threads, 1U));
+		}
+
+		if (command == "probe" && argc == 4)
+			return probe(argv[2], argv[3]);
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+
+	std::cerr << "Usage: " << argv[0] << " build OUTPUT INPUT... [--threads N]\n";
+	std::cerr << "       " << argv[0] << " probe DATABASE FEN\n";
+	return 2;
+}
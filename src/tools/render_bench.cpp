@@ -0,0 +1,85 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that measures how many bytes and how much time
+//          each terminal interface needs per frame. It replays a random game
+//          and compares the frame renderer with redrawing the whole screen
+//          (which is what the interfaces used to do).
+//
+// Usage: chess-render-bench [PLIES] [SEED]
+// The defaults are 200 plies and a seed of 1.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../ui/AsciiUi.h"
+#include "../ui/LetterUi.h"
+#include "../ui/TwoLetterUi.h"
+#include "parse_number.h"
+
+// The bytes that the old interfaces printed for one frame: 200 newlines to
+// push the previous frame out of view, and then every row of the frame.
+static std::size_t get_full_redraw_size(const Frame& frame) {
+	std::size_t size{ 200 };
+	for (int row{ 0 }; row < frame.get_height(); row++) {
+		const auto line{ frame.get_row(row) };
+		size += line.find_last_not_of(' ') + 1 + 1;
+	}
+	return size;
+}
+
+static std::vector<Board> play_random_game(int plies, std::uint64_t seed) {
+	std::mt19937_64 prng{ seed };
+	std::vector<Board> boards{ Board{} };
+	color active_color{ color::white };
+	for (int ply{ 0 }; ply < plies; ply++) {
+		const auto moves{ boards.back().get_all_legal_moves(active_color) };
+		if (moves.empty())
+			break;
+
+		Board board{ boards.back() };
+		board.play(moves[prng() % moves.size()]);
+		boards.push_back(board);
+		active_color = get_opposing_color(active_color);
+	}
+	return boards;
+}
+
+template <typename Compose>
+static void measure(const char* name, const std::vector<Board>& boards, Compose compose) {
+	using Clock = std::chrono::steady_clock;
+	FrameRenderer renderer;
+	std::size_t diff_bytes{ 0 };
+	std::size_t full_bytes{ 0 };
+	Clock::duration elapsed{};
+	for (const auto& board : boards) {
+		const auto start{ Clock::now() };
+		const Frame frame{ compose(board) };
+		const auto output{ renderer.render(frame) };
+		elapsed += Clock::now() - start;
+
+		diff_bytes += output.size();
+		full_bytes += get_full_redraw_size(frame);
+	}
+
+	const double frames{ static_cast<double>(boards.size()) };
+	const std::chrono::duration<double, std::nano> nanoseconds{ elapsed };
+	std::cout << name << ": " << static_cast<double>(diff_bytes) / frames
+			  << " bytes per frame (full redraw: " << static_cast<double>(full_bytes) / frames
+			  << "), " << nanoseconds.count() / frames << " ns per frame\n";
+}
+
+int main(int argc, char* argv[]) {
+	const auto plies{ argc > 1 ? parse_number<int>(argv[1]) : 200 };
+	const auto seed{ argc > 2 ? parse_number<std::uint64_t>(argv[2]) : 1 };
+	if (argc > 3 || !plies || !seed) {
+		std::cerr << "Usage: " << argv[0] << " [PLIES] [SEED]\n";
+		return 2;
+	}
+
+	const auto boards{ play_random_game(*plies, *seed) };
+	std::cout << "Frames: " << boards.size() << '\n';
+
+	measure("AsciiUi", boards, AsciiUi::compose);
+	measure("LetterUi", boards, LetterUi::compose);
+	measure("TwoLetterUi", boards, TwoLetterUi::compose);
+}
@@ -0,0 +1,284 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that plays the engine against itself on every
+//          core and writes quiet positions from the games, each labelled with
+//          its search score and the game's result, for tuning the evaluation.
+//
+// Usage: chess-selfplay OUTPUT [OPTION...]
+//   --games N             How many games to play (default: 1000).
+//   --threads N           How many games to play at once (default: all cores).
+//   --depth N             The search depth for each move (default: 3).
+//   --nodes N             The node limit for each move (default: none).
+//   --chess960-percent N  Start N% of the games from random Chess960
+//                         positions (default: 0).
+//   --random-plies N      Play N random moves before the engine takes over
+//                         (default: 8).
+//   --max-plies N         Adjudicate games as draws after N plies (default: 400).
+//   --seed N              Seed the random choices (default: 1).
+//
+// The output is a sequence of 32-byte records with no header. Each record is
+// a packed position (see position_db.h) whose last four bytes hold:
+//   2 bytes  The search score in centipawns for the player to move
+//            (signed, little-endian).
+//   1 byte   The game's result for the player to move: 0 for a loss, 1 for
+//            a draw, and 2 for a win.
+//   1 byte   Zero.
+// Positions are only kept if they are quiet: the player to move isn't in
+// check, the best move isn't a capture or promotion, and no mate was found.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio> // For std::fopen, std::fwrite.
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "../Referee.h"
+#include "../Search.h"
+#include "../chess960.h"
+#include "../position_db.h"
+#include "parse_number.h"
+
+struct Options {
+	std::string output_path;
+	int games{ 1000 };
+	unsigned threads{ std::max(std::thread::hardware_concurrency(), 1U) };
+	SearchLimits limits{ 3 };
+	int chess960_percent{ 0 };
+	int random_plies{ 8 };
+	int max_plies{ 400 };
+	std::uint64_t seed{ 1 };
+};
+
+struct Opening {
+	Board board;
+	color active_color{ color::white };
+	int plies{ 0 };
+};
+
+using TrainingRecord = PackedPosition;
+
+static const std::size_t score_offset{ 28 };
+static const std::size_t result_offset{ 30 };
+
+// The games played by one thread can only get ahead of the writer by this
+// many, so memory use stays flat even if the disk is slow.
+static const std::size_t games_per_thread_in_flight{ 4 };
+
+// A queue of finished games. Players wait while it's full, and the writer
+// waits while it's empty.
+class GameQueue {
+public:
+	explicit GameQueue(std::size_t capacity)
+		: capacity{ capacity } {}
+
+	void push(std::vector<TrainingRecord> game) {
+		std::unique_lock lock{ mutex };
+		not_full.wait(lock, [this] { return games.size() < capacity; });
+		games.push_back(std::move(game));
+		not_empty.notify_one();
+	}
+
+	// Return `std::nullopt` once the queue is closed and empty.
+	std::optional<std::vector<TrainingRecord>> pop() {
+		std::unique_lock lock{ mutex };
+		not_empty.wait(lock, [this] { return !games.empty() || closed; });
+		if (games.empty())
+			return std::nullopt;
+
+		auto game{ std::move(games.front()) };
+		games.pop_front();
+		not_full.notify_one();
+		return game;
+	}
+
+	void close() {
+		const std::lock_guard lock{ mutex };
+		closed = true;
+		not_empty.notify_all();
+	}
+
+private:
+	std::size_t capacity;
+	std::deque<std::vector<TrainingRecord>> games;
+	bool closed{ false };
+	std::mutex mutex;
+	std::condition_variable not_full;
+	std::condition_variable not_empty;
+};
+
+static std::optional<Options> parse_options(int argc, char* argv[]) {
+	if (argc < 2 || argv[1][0] == '-')
+		return std::nullopt;
+
+	Options options;
+	options.output_path = argv[1];
+	for (int i{ 2 }; i < argc; i++) {
+		const std::string name{ argv[i] };
+		if (i + 1 >= argc)
+			return std::nullopt;
+
+		const auto value{ parse_number<std::uint64_t>(argv[++i]) };
+		if (!value)
+			return std::nullopt;
+		if (name == "--games")
+			options.games = static_cast<int>(*value);
+		else if (name == "--threads")
+			options.threads = std::max(static_cast<unsigned>(*value), 1U);
+		else if (name == "--depth")
+			options.limits.depth = static_cast<int>(*value);
+		else if (name == "--nodes")
+			options.limits.nodes = *value;
+		else if (name == "--chess960-percent")
+			options.chess960_percent = static_cast<int>(*value);
+		else if (name == "--random-plies")
+			options.random_plies = static_cast<int>(*value);
+		else if (name == "--max-plies")
+			options.max_plies = static_cast<int>(*value);
+		else if (name == "--seed")
+			options.seed = *value;
+		else
+			return std::nullopt;
+	}
+	return options;
+}
+
+static bool is_quiet(const Board& board, color active_color, const SearchResult& result) {
+	if (!result.best_move || is_mate_score(result.score))
+		return false;
+
+	const MoveDetails& details{ result.best_move->details };
+	return !details.captured_square && !details.promote_to
+		&& !board.piece_is_under_attack(board.find_king(active_color));
+}
+
+// The opening only depends on the seed and the game number, not on which
+// thread plays the game.
+static Opening choose_opening(int game, const Options& options) {
+	std::mt19937_64 prng{ options.seed * 0x9E3779B97F4A7C15 + static_cast<std::uint64_t>(game) };
+	Opening opening;
+	if (static_cast<int>(prng() % 100) < options.chess960_percent)
+		opening.board = generate_chess960_board(static_cast<int>(prng() % 960));
+
+	for (; opening.plies < options.random_plies; opening.plies++) {
+		const auto moves{ opening.board.get_all_legal_moves(opening.active_color) };
+		if (moves.empty())
+			break;
+
+		opening.board.play(moves[prng() % moves.size()]);
+		opening.active_color = get_opposing_color(opening.active_color);
+	}
+	return opening;
+}
+
+static std::vector<TrainingRecord> play_game(
+	int game, const Options& options, TranspositionTable& table) {
+	const Opening opening{ choose_opening(game, options) };
+	Referee referee{ opening.board, opening.active_color, options.max_plies };
+	std::vector<TrainingRecord> records;
+	std::vector<color> record_colors;
+	for (;;) {
+		const Board& board{ referee.get_board() };
+		const color active_color{ referee.get_active_color() };
+		const auto legal_moves{ board.get_all_legal_moves(active_color) };
+		const auto outcome{ referee.adjudicate(legal_moves) };
+		if (outcome) {
+			for (std::size_t i{ 0 }; i < records.size(); i++) {
+				unsigned char result{ 1 };
+				if (outcome->result != game_result::draw) {
+					const bool white_won{ outcome->result == game_result::white_wins };
+					result = white_won == (record_colors[i] == color::white) ? 2 : 0;
+				}
+				records[i].bytes[result_offset] = result;
+			}
+			return records;
+		}
+
+		Search search{ options.limits, &table };
+		const auto result{ search.run(board, active_color) };
+		if (is_quiet(board, active_color, result)) {
+			const FenPosition position{ board, active_color, referee.get_halfmove_clock(),
+				(opening.plies + referee.get_ply()) / 2 + 1 };
+			if (auto packed{ pack_position(position) }) {
+				const auto score{ static_cast<std::uint16_t>(
+					static_cast<std::int16_t>(std::clamp(result.score, -32767, 32767))) };
+				packed->bytes[score_offset] = static_cast<unsigned char>(score & 0xFF);
+				packed->bytes[score_offset + 1] = static_cast<unsigned char>(score >> 8);
+				records.push_back(*packed);
+				record_colors.push_back(active_color);
+			}
+		}
+		// The search returns a move whenever there is one, but falling back
+		// costs nothing and keeps a long run from dying on a bug.
+		referee.play(result.best_move ? *result.best_move : legal_moves.front());
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const auto maybe_options{ parse_options(argc, argv) };
+	if (!maybe_options) {
+		std::cerr << "Usage: " << argv[0]
+				  << " OUTPUT [--games N] [--threads N] [--depth N] [--nodes N]"
+					 " [--chess960-percent N] [--random-plies N] [--max-plies N] [--seed N]\n";
+		return 2;
+	}
+
+	const Options& options{ *maybe_options };
+	std::FILE* file{ std::fopen(options.output_path.c_str(), "wb") };
+	if (!file) {
+		std::cerr << "Cannot open " << options.output_path << '\n';
+		return 1;
+	}
+
+	GameQueue queue{ options.threads * games_per_thread_in_flight };
+	std::atomic<int> next_game{ 0 };
+	std::size_t positions{ 0 };
+	bool write_failed{ false };
+	const auto start{ std::chrono::steady_clock::now() };
+
+	// Only the writer touches the file, so the players never wait for the
+	// disk unless the queue fills up.
+	std::thread writer{ [&] {
+		while (auto game{ queue.pop() }) {
+			if (std::fwrite(game->data(), sizeof(TrainingRecord), game->size(), file)
+				!= game->size())
+				write_failed = true;
+			positions += game->size();
+		}
+	} };
+
+	const auto work{ [&] {
+		// Each thread keeps its table from game to game. It's small, because
+		// shallow searches don't fill much of it.
+		TranspositionTable table{ 4 };
+		for (;;) {
+			const int game{ next_game.fetch_add(1) };
+			if (game >= options.games)
+				return;
+			queue.push(play_game(game, options, table));
+		}
+	} };
+
+	std::vector<std::thread> threads;
+	for (unsigned i{ 0 }; i < options.threads; i++)
+		threads.emplace_back(work);
+	for (auto& thread : threads)
+		thread.join();
+	queue.close();
+	writer.join();
+
+	if (std::fclose(file) != 0 || write_failed) {
+		std::cerr << "Cannot write " << options.output_path << '\n';
+		return 1;
+	}
+
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+	const double positions_per_second{ static_cast<double>(positions) / elapsed.count() };
+	std::cout << "Games: " << options.games << '\n';
+	std::cout << "Positions: " << positions << '\n';
+	std::cout << "Seconds: " << elapsed.count() << " using " << options.threads << " threads\n";
+	std::cout << "Positions per second: " << positions_per_second << " ("
+			  << positions_per_second / options.threads << " per thread)\n";
+}
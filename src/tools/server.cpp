@@ -0,0 +1,51 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that hosts many games at once for network
+//          clients. See server/GameServer.h for the protocol.
+//
+// Usage: chess-server --tcp [HOST:]PORT
+//        chess-server --unix PATH
+// The default host is 127.0.0.1.
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "../server/GameServer.h"
+#include "parse_number.h"
+
+static int print_usage(const char* program) {
+	std::cerr << "Usage: " << program << " --tcp [HOST:]PORT | --unix PATH\n";
+	return 2;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 3)
+		return print_usage(argv[0]);
+
+	try {
+		const std::string kind{ argv[1] };
+		const std::string address{ argv[2] };
+		int listener{ -1 };
+		if (kind == "--tcp") {
+			const auto colon{ address.rfind(':') };
+			const std::string host{ colon == std::string::npos ? "127.0.0.1"
+															   : address.substr(0, colon) };
+			const auto port{ parse_number<std::uint16_t>(
+				colon == std::string::npos ? address : address.substr(colon + 1)) };
+			if (!port)
+				return print_usage(argv[0]);
+			listener = listen_on_tcp_port(host, *port);
+		} else if (kind == "--unix") {
+			listener = listen_on_unix_socket(address);
+		} else {
+			return print_usage(argv[0]);
+		}
+
+		GameServer server{ listener };
+		std::cout << "Listening on " << address << std::endl;
+		server.run();
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+}
@@ -0,0 +1,75 @@
+// Author: Daniel Kareh
+// Summary: A command line tool that generates and probes endgame tablebases.
+//
+// Usage: chess-tablebase generate MATERIAL DIRECTORY [THREADS]
+//        chess-tablebase probe DIRECTORY FEN
+// Material is written like 'KQvK' or 'KRPvKR'.
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <thread>
+#include "../fen.h"
+#include "../tablebase.h"
+#include "parse_number.h"
+
+static int generate(const std::string& material, const std::string& directory, unsigned threads) {
+	const auto start{ std::chrono::steady_clock::now() };
+	generate_tablebases(material, directory, threads,
+		[](const std::string& message) { std::cout << message << std::endl; });
+
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+	std::cout << "Finished in " << elapsed.count() << " seconds using " << threads
+			  << " threads.\n";
+	return 0;
+}
+
+static int probe(const std::string& directory, const std::string& fen) {
+	const auto position{ parse_fen(fen) };
+	if (!position) {
+		std::cerr << "Invalid FEN: " << fen << '\n';
+		return 1;
+	}
+
+	const Tablebases tablebases{ directory };
+	const auto result{ tablebases.probe(position->board, position->active_color) };
+	if (!result) {
+		std::cout << "Not found in " << tablebases.size() << " tables.\n";
+		return 1;
+	}
+
+	switch (result->wdl) {
+	case wdl::win:
+		std::cout << "Win: mate in " << result->moves_to_mate << ".\n";
+		break;
+	case wdl::loss:
+		std::cout << "Loss: mated in " << result->moves_to_mate << ".\n";
+		break;
+	case wdl::draw:
+		std::cout << "Draw.\n";
+		break;
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	const std::string command{ argc > 1 ? argv[1] : "" };
+	try {
+		if (command == "generate" && (argc == 4 || argc == 5)) {
+			const auto threads{ argc == 5 ? parse_number<unsigned>(argv[4])
+										  : std::thread::hardware_concurrency() };
+			if (threads)
+				return generate(argv[2], argv[3], std::max(*threads, 1U));
+		}
+
+		if (command == "probe" && argc == 4)
+			return probe(argv[2], argv[3]);
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+
+	std::cerr << "Usage: " << argv[0] << " generate MATERIAL DIRECTORY [THREADS]\n";
+	std::cerr << "       " << argv[0] << " probe DIRECTORY FEN\n";
+	return 2;
+}
@@ -2,11 +2,9 @@
 // Summary: An interface that prints ASCII pictures for each piece.
 
 #include "AsciiUi.h"
-#include <iostream>
+#include <algorithm>
 #include <stdexcept> // For std::invalid_argument.
 
-using std::cout;
-
 static const int columns_per_drawing{ 5 };
 static const int rows_per_drawing{ 4 };
 using Drawing = std::array<std::array<char, columns_per_drawing + 1>, rows_per_drawing>;
@@ -74,24 +72,29 @@ static const Drawing& choose_drawing(piece_type type) {
 	}
 }
 
-void AsciiUi::show(const Board& board) {
-	clear_screen();
-
+Frame AsciiUi::compose(const Board& board) {
+	// Add two to account for the extra padding added between pieces.
+	const int total_columns{ columns_per_drawing + 2 };
 	const auto dimensions{ board.get_dimensions() };
-	for (int rank{ dimensions.rank - 1 }; rank >= 0; rank--) {
+
+	// Each rank is followed by a blank row, and the file letters are followed
+	// by another blank row, the pieces under attack (at least one row, even if
+	// there are none), and a final blank row.
+	const auto threats{ describe_threats(board) };
+	const int threat_rows{ std::max(static_cast<int>(threats.size()), 1) };
+	const int width{ std::max(2 + dimensions.get_file() * total_columns, threat_line_width) };
+	Frame frame{ width, dimensions.get_rank() * (rows_per_drawing + 1) + 3 + threat_rows };
+	for (int rank{ dimensions.get_rank() - 1 }; rank >= 0; rank--) {
+		const int top{ (dimensions.get_rank() - 1 - rank) * (rows_per_drawing + 1) };
 		for (int row{ 0 }; row < rows_per_drawing; row++) {
 			// Display the rank digit in roughly the middle of the rank.
 			if (row == rows_per_drawing / 2)
-				cout << convert_rank_to_digit(rank) << ' ';
-			else
-				cout << "  ";
+				frame.put(top + row, 0, convert_rank_to_digit(rank));
 
-			for (int file{ 0 }; file < dimensions.file; file++) {
+			for (int file{ 0 }; file < dimensions.get_file(); file++) {
 				auto piece{ board.get_piece({ rank, file }) };
-				if (!piece) {
-					cout << ' ' << std::string(columns_per_drawing, ' ') << ' ';
+				if (!piece)
 					continue;
-				}
 
 				const Drawing& drawing{ choose_drawing(piece->type) };
 				auto drawing_row{ drawing[row] };
@@ -99,21 +102,17 @@ void AsciiUi::show(const Board& board) {
 					// Make the middle character of a piece 'b' or 'w' to indicate its color.
 					drawing_row[columns_per_drawing / 2] = piece->is_black() ? 'b' : 'w';
 				}
-				cout << ' ' << drawing_row.data() << ' ';
+				frame.put(top + row, 2 + file * total_columns + 1, drawing_row.data());
 			}
-			cout << '\n';
 		}
-		cout << '\n';
 	}
 
-	cout << "  ";
-	for (int file{ 0 }; file < dimensions.file; file++) {
-		// Add two to account for the extra padding added between pieces.
-		const int total_columns{ columns_per_drawing + 2 };
+	const int letter_row{ dimensions.get_rank() * (rows_per_drawing + 1) };
+	for (int file{ 0 }; file < dimensions.get_file(); file++) {
 		const int space_count{ total_columns / 2 };
-		cout << std::string(space_count, ' ');
-		cout << convert_file_to_letter(file);
-		cout << std::string(total_columns - space_count - 1, ' ');
+		frame.put(letter_row, 2 + file * total_columns + space_count, convert_file_to_letter(file));
 	}
-	cout << "\n\n";
+	for (std::size_t i{ 0 }; i < threats.size(); i++)
+		frame.put(letter_row + 2 + static_cast<int>(i), 0, threats[i]);
+	return frame;
 }
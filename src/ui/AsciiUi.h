@@ -8,7 +8,9 @@
 
 class AsciiUi final : public TerminalUserInterface {
 public:
-	virtual void show(const Board&) override;
+	virtual void show(const Board& board) override { present(compose(board)); }
+
+	static Frame compose(const Board&);
 };
 
 #endif
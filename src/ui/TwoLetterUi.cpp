@@ -3,34 +3,36 @@
 //          denotes the color and another denotes the piece type.
 
 #include "TwoLetterUi.h"
-#include <iostream>
+#include <algorithm>
 #include "../safe_ctype.h"
 
-using std::cout;
-
-void TwoLetterUi::show(const Board& board) {
-	clear_screen();
-
+Frame TwoLetterUi::compose(const Board& board) {
+	// The ranks are followed by a blank row, the file letters, another blank
+	// row, the pieces under attack (at least one row, even if there are none),
+	// and a final blank row.
 	const auto dimensions{ board.get_dimensions() };
-	for (int rank{ dimensions.rank - 1 }; rank >= 0; rank--) {
-		cout << convert_rank_to_digit(rank) << ' ';
-
-		for (int file{ 0 }; file < dimensions.file; file++) {
+	const auto threats{ describe_threats(board) };
+	const int threat_rows{ std::max(static_cast<int>(threats.size()), 1) };
+	Frame frame{ std::max(2 + dimensions.get_file() * 3, threat_line_width),
+		dimensions.get_rank() + 4 + threat_rows };
+	for (int rank{ dimensions.get_rank() - 1 }; rank >= 0; rank--) {
+		const int row{ dimensions.get_rank() - 1 - rank };
+		frame.put(row, 0, convert_rank_to_digit(rank));
+
+		for (int file{ 0 }; file < dimensions.get_file(); file++) {
 			const auto piece{ board.get_piece({ rank, file }) };
-			if (!piece) {
-				cout << "   ";
+			if (!piece)
 				continue;
-			}
 
 			const char letter{ safe_to_lower(convert_piece_type_to_letter(piece->type)) };
-			cout << (piece->is_black() ? 'b' : 'w') << letter << ' ';
+			frame.put(row, 2 + file * 3, piece->is_black() ? 'b' : 'w');
+			frame.put(row, 3 + file * 3, letter);
 		}
-
-		cout << '\n';
 	}
 
-	cout << "\n  ";
-	for (int file{ 0 }; file < dimensions.file; file++)
-		cout << convert_file_to_letter(file) << "  ";
-	cout << "\n\n";
+	for (int file{ 0 }; file < dimensions.get_file(); file++)
+		frame.put(dimensions.get_rank() + 1, 2 + file * 3, convert_file_to_letter(file));
+	for (std::size_t i{ 0 }; i < threats.size(); i++)
+		frame.put(dimensions.get_rank() + 3 + static_cast<int>(i), 0, threats[i]);
+	return frame;
 }
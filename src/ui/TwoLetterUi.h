@@ -9,7 +9,9 @@
 
 class TwoLetterUi final : public TerminalUserInterface {
 public:
-	virtual void show(const Board&) override;
+	virtual void show(const Board& board) override { present(compose(board)); }
+
+	static Frame compose(const Board&);
 };
 
 #endif
@@ -51,11 +51,11 @@ void WindowsConsoleUi::show(const Board& board) {
 	clear_screen();
 
 	const auto dimensions{ board.get_dimensions() };
-	for (int rank{ dimensions.rank - 1 }; rank >= 0; rank--) {
+	for (int rank{ dimensions.get_rank() - 1 }; rank >= 0; rank--) {
 		cout << convert_rank_to_digit(rank) << ' ';
 		cout.flush();
 
-		for (int file{ 0 }; file < dimensions.file; file++) {
+		for (int file{ 0 }; file < dimensions.get_file(); file++) {
 			const auto piece{ board.get_piece({ rank, file }) };
 
 			const bool square_is_dark{ (rank + file) % 2 == 0 };
@@ -91,7 +91,7 @@ void WindowsConsoleUi::show(const Board& board) {
 
 	// We're done using Windows API functions, so no need to flush here.
 	cout << "  ";
-	for (int file{ 0 }; file < dimensions.file; file++) {
+	for (int file{ 0 }; file < dimensions.get_file(); file++) {
 		cout << convert_file_to_letter(file);
 		if (glyph_size == glyph_size::double_width)
 			cout << ' ';
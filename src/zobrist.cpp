@@ -0,0 +1,56 @@
+// Author: Daniel Kareh
+// Summary: Zobrist hashing, which turns a position into a 64-bit number so
+//          that positions can be compared and looked up quickly.
+
+#include "zobrist.h"
+#include <array>
+
+// There are eight piece types (including castleable pieces) and two colors.
+static const std::size_t piece_kinds{ 16 };
+
+// One number for each kind of piece on each square, one for each en passant
+// file, and one for when Black is to move.
+static const std::size_t en_passant_offset{ piece_kinds * 64 };
+static const std::size_t black_to_move_offset{ en_passant_offset + 8 };
+using Keys = std::array<std::uint64_t, black_to_move_offset + 1>;
+
+// Source: https://prng.di.unimi.it/splitmix64.c
+static constexpr Keys generate_keys() {
+	Keys keys{};
+	std::uint64_t state{ 0x3243F6A8885A308D };
+	for (auto& key : keys) {
+		state += 0x9E3779B97F4A7C15;
+		std::uint64_t z{ state };
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		key = z ^ (z >> 31);
+	}
+	return keys;
+}
+
+static constexpr Keys keys{ generate_keys() };
+
+std::uint64_t zobrist_hash(const Board& board, color active_color) {
+	std::uint64_t hash{ 0 };
+	for (const Square square : board) {
+		const auto piece{ board.get_piece(square) };
+		if (!piece)
+			continue;
+
+		const auto kind{ static_cast<std::size_t>(piece->type) * 2
+			+ static_cast<std::size_t>(piece->color) };
+		const int index{ square.get_rank() * 8 + square.get_file() };
+		hash ^= keys[kind * 64 + static_cast<std::size_t>(index)];
+	}
+
+	// Like the rules of repetition, only count an en passant target that the
+	// player to move can use.
+	if (board.can_capture_en_passant(active_color)) {
+		const Square target{ board.get_en_passant_target() };
+		hash ^= keys[en_passant_offset + static_cast<std::size_t>(target.get_file())];
+	}
+
+	if (active_color == color::black)
+		hash ^= keys[black_to_move_offset];
+	return hash;
+}
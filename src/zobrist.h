@@ -0,0 +1,15 @@
+// Author: Daniel Kareh
+// Summary: Zobrist hashing, which turns a position into a 64-bit number so
+//          that positions can be compared and looked up quickly.
+
+#ifndef CHESS_ZOBRIST_H
+#define CHESS_ZOBRIST_H
+
+#include <cstdint>
+#include "Board.h"
+
+// Castling rights are part of the hash because castleable pieces are hashed
+// separately from ordinary kings and rooks.
+std::uint64_t zobrist_hash(const Board&, color active_color);
+
+#endif